@@ -0,0 +1,292 @@
+/****************************************************************************
+
+    程序名称：二进制数据的输出
+    程序设计：rainhenry
+    程序版本：REV 0.1
+    创建日期：20261016
+
+    版本修订：
+        REV 0.1      rainhenry     20261016    创建文档
+        REV 0.2      rainhenry     20261016    增加数据的合并
+
+****************************************************************************/
+//---------------------------------------------------------------------------
+//  包含头文件
+#include "binout.h"
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <elf.h>
+
+//  开始一个新的数组，对齐起始位置
+void BinDataBeginArray(SBinData* pbin, const std::string& name)
+{
+    while((pbin->data_vec.size() % BIN_ARRAY_ALIGN) != 0) pbin->data_vec.push_back(0);
+
+    SBinArray tmp_array;
+    tmp_array.name = name;
+    tmp_array.offset = pbin->data_vec.size();
+    tmp_array.size = 0;
+    pbin->array_vec.push_back(tmp_array);
+}
+
+//  结束当前数组，数据不足size字节时补0，与C中未初始化的数组元素一致
+void BinDataEndArray(SBinData* pbin, size_t size)
+{
+    SBinArray& tmp_array = pbin->array_vec.back();
+    pbin->data_vec.resize(tmp_array.offset + size, 0);
+    tmp_array.size = size;
+}
+
+//  追加数据
+void BinDataPut(SBinData* pbin, const void* pdata, size_t len)
+{
+    const unsigned char* p = (const unsigned char*)pdata;
+    pbin->data_vec.insert(pbin->data_vec.end(), p, p + len);
+}
+
+//  将psrc中的全部数组追加到pdst后面，用于多个任务的输出合并
+void BinDataAppend(SBinData* pdst, const SBinData* psrc)
+{
+    while((pdst->data_vec.size() % BIN_ARRAY_ALIGN) != 0) pdst->data_vec.push_back(0);
+
+    size_t base = pdst->data_vec.size();
+    pdst->data_vec.insert(pdst->data_vec.end(), psrc->data_vec.begin(), psrc->data_vec.end());
+    size_t i = 0;
+    for(i=0;i<psrc->array_vec.size();i++)
+    {
+        SBinArray tmp_array = psrc->array_vec[i];
+        tmp_array.offset += base;
+        pdst->array_vec.push_back(tmp_array);
+    }
+}
+
+//  由名字得到体系结构，不支持时返回-2
+int GetElfArchByName(const char* pname)
+{
+    if(strcmp(pname, "host") == 0)    return ELF_ARCH_HOST;
+    if(strcmp(pname, "x86_64") == 0)  return ELF_ARCH_X86_64;
+    if(strcmp(pname, "i386") == 0)    return ELF_ARCH_I386;
+    if(strcmp(pname, "aarch64") == 0) return ELF_ARCH_AARCH64;
+    if(strcmp(pname, "arm") == 0)     return ELF_ARCH_ARM;
+    if(strcmp(pname, "riscv64") == 0) return ELF_ARCH_RISCV64;
+    return -2;
+}
+
+//  得到本机的体系结构，无法识别时按x86_64处理
+static int GetHostElfArch(void)
+{
+#if defined(__x86_64__)
+    return ELF_ARCH_X86_64;
+#elif defined(__i386__)
+    return ELF_ARCH_I386;
+#elif defined(__aarch64__)
+    return ELF_ARCH_AARCH64;
+#elif defined(__arm__)
+    return ELF_ARCH_ARM;
+#elif defined(__riscv) && (__riscv_xlen == 64)
+    return ELF_ARCH_RISCV64;
+#else
+    return ELF_ARCH_X86_64;
+#endif
+}
+
+//  按本机字节序追加len字节的整数，len为1/2/4/8
+static void PutElfInt(std::vector<unsigned char>* pout, uint64_t val, int len)
+{
+    uint8_t v8 = (uint8_t)val;
+    uint16_t v16 = (uint16_t)val;
+    uint32_t v32 = (uint32_t)val;
+    const unsigned char* p = (const unsigned char*)&val;
+    if(len == 1) p = (const unsigned char*)&v8;
+    if(len == 2) p = (const unsigned char*)&v16;
+    if(len == 4) p = (const unsigned char*)&v32;
+    pout->insert(pout->end(), p, p + len);
+}
+
+//  补0对齐到align字节
+static void PutElfAlign(std::vector<unsigned char>* pout, size_t align)
+{
+    while((pout->size() % align) != 0) pout->push_back(0);
+}
+
+//  写入整个文件，成功返回0
+static int WriteWholeFile(const char* filename, const unsigned char* pdata, size_t len)
+{
+    FILE* fp = fopen(filename, "wb");
+    if(fp == 0) return -1;
+    if((len > 0) && (fwrite(pdata, 1, len, fp) != len))
+    {
+        fclose(fp);
+        return -1;
+    }
+    if(fclose(fp) != 0) return -1;
+    return 0;
+}
+
+//  写出ELF可重定位目标文件，成功返回0
+//  段的顺序为 空段、.rodata、.symtab、.strtab、.shstrtab、.note.GNU-stack
+int WriteElfObject(const char* filename, const SBinData* pbin, int arch)
+{
+    if(arch == ELF_ARCH_HOST) arch = GetHostElfArch();
+
+    //  体系结构相关的参数
+    int is64 = 1;
+    int machine = EM_X86_64;
+    uint32_t flags = 0;
+    switch(arch)
+    {
+        case ELF_ARCH_I386:     is64 = 0;   machine = EM_386;                                   break;
+        case ELF_ARCH_AARCH64:  is64 = 1;   machine = EM_AARCH64;                               break;
+        case ELF_ARCH_ARM:      is64 = 0;   machine = EM_ARM;       flags = EF_ARM_EABI_VER5;   break;
+        case ELF_ARCH_RISCV64:  is64 = 1;   machine = EM_RISCV;     flags = EF_RISCV_RVC | EF_RISCV_FLOAT_ABI_DOUBLE;   break;
+        default:                is64 = 1;   machine = EM_X86_64;                                break;
+    }
+    int addr_len = is64 ? 8 : 4;
+
+    //  32位目标文件无法容纳超过4GB的数据
+    if(!is64 && (pbin->data_vec.size() > 0xFFFFFFF0ULL)) return -2;
+
+    //  符号名字表，第一个为空字符串
+    std::string strtab("\0", 1);
+    std::vector<size_t> name_vec;
+    size_t i = 0;
+    for(i=0;i<pbin->array_vec.size();i++)
+    {
+        name_vec.push_back(strtab.size());
+        strtab += pbin->array_vec[i].name;
+        strtab.push_back('\0');
+    }
+
+    //  段名字表
+    const char shstrtab[] = "\0.rodata\0.symtab\0.strtab\0.shstrtab\0.note.GNU-stack";
+    const uint32_t sh_name[6] = {0, 1, 9, 17, 25, 35};
+
+    //  ELF头部，各个段的内容放在后面
+    std::vector<unsigned char> out;
+    size_t ehdr_size = is64 ? sizeof(Elf64_Ehdr) : sizeof(Elf32_Ehdr);
+    out.resize(ehdr_size, 0);
+
+    //  .rodata
+    PutElfAlign(&out, BIN_ARRAY_ALIGN);
+    size_t rodata_off = out.size();
+    out.insert(out.end(), pbin->data_vec.begin(), pbin->data_vec.end());
+
+    //  .symtab，空符号、.rodata的段符号、每个数组的全局符号
+    PutElfAlign(&out, addr_len);
+    size_t symtab_off = out.size();
+    size_t sym_size = is64 ? sizeof(Elf64_Sym) : sizeof(Elf32_Sym);
+    for(i=0;i<(pbin->array_vec.size() + 2);i++)
+    {
+        uint32_t st_name = 0;
+        unsigned char st_info = 0;
+        uint16_t st_shndx = 0;
+        uint64_t st_value = 0;
+        uint64_t st_size = 0;
+        if(i == 1)
+        {
+            st_info = ELF64_ST_INFO(STB_LOCAL, STT_SECTION);
+            st_shndx = 1;
+        }
+        else if(i >= 2)
+        {
+            const SBinArray& tmp_array = pbin->array_vec[i - 2];
+            st_name = (uint32_t)name_vec[i - 2];
+            st_info = ELF64_ST_INFO(STB_GLOBAL, STT_OBJECT);
+            st_shndx = 1;
+            st_value = tmp_array.offset;
+            st_size = tmp_array.size;
+        }
+
+        PutElfInt(&out, st_name, 4);
+        if(is64)
+        {
+            PutElfInt(&out, st_info, 1);
+            PutElfInt(&out, STV_DEFAULT, 1);
+            PutElfInt(&out, st_shndx, 2);
+            PutElfInt(&out, st_value, 8);
+            PutElfInt(&out, st_size, 8);
+        }
+        else
+        {
+            PutElfInt(&out, st_value, 4);
+            PutElfInt(&out, st_size, 4);
+            PutElfInt(&out, st_info, 1);
+            PutElfInt(&out, STV_DEFAULT, 1);
+            PutElfInt(&out, st_shndx, 2);
+        }
+    }
+    size_t symtab_size = out.size() - symtab_off;
+
+    //  .strtab
+    size_t strtab_off = out.size();
+    out.insert(out.end(), strtab.begin(), strtab.end());
+
+    //  .shstrtab
+    size_t shstrtab_off = out.size();
+    out.insert(out.end(), shstrtab, shstrtab + sizeof(shstrtab));
+
+    //  段表
+    PutElfAlign(&out, addr_len);
+    size_t shdr_off = out.size();
+    size_t shdr_size = is64 ? sizeof(Elf64_Shdr) : sizeof(Elf32_Shdr);
+    const uint32_t sh_type[6] = {SHT_NULL, SHT_PROGBITS, SHT_SYMTAB, SHT_STRTAB, SHT_STRTAB, SHT_PROGBITS};
+    const uint64_t sh_flags[6] = {0, SHF_ALLOC, 0, 0, 0, 0};
+    const uint64_t sh_offset[6] = {0, rodata_off, symtab_off, strtab_off, shstrtab_off, out.size()};
+    const uint64_t sh_size[6] = {0, pbin->data_vec.size(), symtab_size, strtab.size(), sizeof(shstrtab), 0};
+    const uint32_t sh_link[6] = {0, 0, 3, 0, 0, 0};
+    const uint32_t sh_info[6] = {0, 0, 2, 0, 0, 0};     //  第一个全局符号的序号
+    const uint64_t sh_align[6] = {0, BIN_ARRAY_ALIGN, (uint64_t)addr_len, 1, 1, 1};
+    const uint64_t sh_entsize[6] = {0, 0, sym_size, 0, 0, 0};
+    for(i=0;i<6;i++)
+    {
+        PutElfInt(&out, sh_name[i], 4);
+        PutElfInt(&out, sh_type[i], 4);
+        PutElfInt(&out, sh_flags[i], addr_len);
+        PutElfInt(&out, 0, addr_len);
+        PutElfInt(&out, sh_offset[i], addr_len);
+        PutElfInt(&out, sh_size[i], addr_len);
+        PutElfInt(&out, sh_link[i], 4);
+        PutElfInt(&out, sh_info[i], 4);
+        PutElfInt(&out, sh_align[i], addr_len);
+        PutElfInt(&out, sh_entsize[i], addr_len);
+    }
+
+    //  填写ELF头部
+    std::vector<unsigned char> ehdr;
+    unsigned char ident[EI_NIDENT] = {ELFMAG0, ELFMAG1, ELFMAG2, ELFMAG3};
+    ident[EI_CLASS] = is64 ? ELFCLASS64 : ELFCLASS32;
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    ident[EI_DATA] = ELFDATA2MSB;
+#else
+    ident[EI_DATA] = ELFDATA2LSB;
+#endif
+    ident[EI_VERSION] = EV_CURRENT;
+    ident[EI_OSABI] = ELFOSABI_SYSV;
+    ehdr.insert(ehdr.end(), ident, ident + EI_NIDENT);
+    PutElfInt(&ehdr, ET_REL, 2);
+    PutElfInt(&ehdr, machine, 2);
+    PutElfInt(&ehdr, EV_CURRENT, 4);
+    PutElfInt(&ehdr, 0, addr_len);              //  e_entry
+    PutElfInt(&ehdr, 0, addr_len);              //  e_phoff
+    PutElfInt(&ehdr, shdr_off, addr_len);       //  e_shoff
+    PutElfInt(&ehdr, flags, 4);
+    PutElfInt(&ehdr, ehdr_size, 2);             //  e_ehsize
+    PutElfInt(&ehdr, 0, 2);                     //  e_phentsize
+    PutElfInt(&ehdr, 0, 2);                     //  e_phnum
+    PutElfInt(&ehdr, shdr_size, 2);             //  e_shentsize
+    PutElfInt(&ehdr, 6, 2);                     //  e_shnum
+    PutElfInt(&ehdr, 4, 2);                     //  e_shstrndx
+    memcpy(out.data(), ehdr.data(), ehdr_size);
+
+    return WriteWholeFile(filename, out.data(), out.size());
+}
+
+//  写出.bin文件，成功返回0
+int WriteBinFile(const char* filename, const SBinData* pbin)
+{
+    return WriteWholeFile(filename, pbin->data_vec.data(), pbin->data_vec.size());
+}
+
+//---------------------------------------------------------------------------
+//  文件结束
@@ -0,0 +1,81 @@
+/****************************************************************************
+
+    程序名称：二进制数据的输出
+    程序设计：rainhenry
+    程序版本：REV 0.1
+    创建日期：20261016
+
+    说明：
+        生成的数组不再写成C代码，而是按照内存中的格式直接收集为原始字节，
+        然后写成可以直接链接的ELF可重定位目标文件(.o)，或者单独的.bin文件
+        ELF目标文件中每个数组对应一个与C代码中同名同大小的全局符号，放在.rodata段
+        .bin文件配合头文件中的偏移和大小，用于汇编的.incbin或者C23的#embed
+        数据按照本机的字节序保存，每个数组按BIN_ARRAY_ALIGN字节对齐
+
+    版本修订：
+        REV 0.1      rainhenry     20261016    创建文档
+        REV 0.2      rainhenry     20261016    增加数据的合并
+
+****************************************************************************/
+//---------------------------------------------------------------------------
+//  防止重复包含
+#ifndef __binout_h__
+#define __binout_h__
+
+//---------------------------------------------------------------------------
+//  包含头文件
+#include <cstddef>
+#include <string>
+#include <vector>
+
+//  每个数组起始位置的对齐字节数
+#define BIN_ARRAY_ALIGN         16
+
+//  ELF目标文件的体系结构
+#define ELF_ARCH_HOST           -1      //  与本机相同
+#define ELF_ARCH_X86_64         0
+#define ELF_ARCH_I386           1
+#define ELF_ARCH_AARCH64        2
+#define ELF_ARCH_ARM            3
+#define ELF_ARCH_RISCV64        4
+
+//  定义一个数组在二进制数据中的位置
+typedef struct
+{
+    std::string name;       //  符号名
+    size_t offset;          //  起始位置
+    size_t size;            //  字节数
+}SBinArray;
+
+//  定义收集的二进制数据
+typedef struct
+{
+    std::vector<unsigned char> data_vec;        //  全部数组的数据
+    std::vector<SBinArray> array_vec;           //  每个数组的位置
+}SBinData;
+
+//  开始一个新的数组，对齐起始位置
+void BinDataBeginArray(SBinData* pbin, const std::string& name);
+
+//  结束当前数组，数据不足size字节时补0，与C中未初始化的数组元素一致
+void BinDataEndArray(SBinData* pbin, size_t size);
+
+//  追加数据
+void BinDataPut(SBinData* pbin, const void* pdata, size_t len);
+
+//  将psrc中的全部数组追加到pdst后面，用于多个任务的输出合并
+void BinDataAppend(SBinData* pdst, const SBinData* psrc);
+
+//  由名字得到体系结构，不支持时返回-2
+int GetElfArchByName(const char* pname);
+
+//  写出ELF可重定位目标文件，成功返回0
+int WriteElfObject(const char* filename, const SBinData* pbin, int arch);
+
+//  写出.bin文件，成功返回0
+int WriteBinFile(const char* filename, const SBinData* pbin);
+
+#endif
+
+//---------------------------------------------------------------------------
+//  文件结束
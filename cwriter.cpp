@@ -0,0 +1,375 @@
+/****************************************************************************
+
+    程序名称：生成C文件用的缓冲输出
+    程序设计：rainhenry
+    程序版本：REV 0.1
+    创建日期：20261016
+
+    版本修订：
+        REV 0.1      rainhenry     20261016    创建文档
+        REV 0.2      rainhenry     20261016    增加有符号整数输出
+        REV 0.3      rainhenry     20261016    增加二进制模式
+        REV 0.4      rainhenry     20261016    增加写入内存的模式
+        REV 0.5      rainhenry     20261017    统计写入文件的时间
+
+****************************************************************************/
+//---------------------------------------------------------------------------
+//  包含头文件
+#include "cwriter.h"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <charconv>
+#include <chrono>
+#include <fcntl.h>
+#include <unistd.h>
+
+//  将缓冲区中的数据写入文件
+static void CWriterFlush(SCWriter* pw, const char* pdata, size_t len)
+{
+    //  内存模式
+    if(pw->pmem != 0)
+    {
+        pw->pmem->append(pdata, len);
+        return;
+    }
+
+    //  每次写出一整块缓冲区，计时的开销可以忽略
+    std::chrono::steady_clock::time_point t_start = std::chrono::steady_clock::now();
+    while((len > 0) && (pw->error == 0))
+    {
+        ssize_t re = write(pw->fd, pdata, len);
+
+        //  被信号打断时重试
+        if((re < 0) && (errno == EINTR)) continue;
+
+        //  写入出错
+        if(re <= 0)
+        {
+            pw->error = 1;
+            break;
+        }
+
+        pdata += re;
+        len -= (size_t)re;
+    }
+    pw->write_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t_start).count();
+}
+
+//  创建输出文件，成功返回0
+int CWriterOpen(SCWriter* pw, const char* filename, int float_fmt, int precision)
+{
+    //  检测指针
+    if((pw == 0) || (filename == 0)) return -1;
+
+    pw->fd = -1;
+    pw->pbuf = 0;
+    pw->len = 0;
+    pw->error = 0;
+    pw->total = 0;
+    pw->write_ms = 0.0;
+    pw->float_fmt = float_fmt;
+    pw->precision = precision;
+    pw->pmem = 0;
+    pw->pbin = 0;
+    pw->elem_size = 0;
+    pw->elem_cnt = 0;
+
+    //  分配缓冲区
+    pw->pbuf = (char*)malloc(CWRITER_BUFF_SIZE);
+    if(pw->pbuf == 0) return -1;
+
+    //  创建文件
+    pw->fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if(pw->fd < 0)
+    {
+        free(pw->pbuf);
+        pw->pbuf = 0;
+        return -1;
+    }
+
+    return 0;
+}
+
+//  以内存模式打开，输出追加到pmem中，成功返回0
+int CWriterOpenMem(SCWriter* pw, std::string* pmem, int float_fmt, int precision)
+{
+    //  检测指针
+    if((pw == 0) || (pmem == 0)) return -1;
+
+    pw->fd = -1;
+    pw->pbuf = 0;
+    pw->len = 0;
+    pw->error = 0;
+    pw->total = 0;
+    pw->write_ms = 0.0;
+    pw->float_fmt = float_fmt;
+    pw->precision = precision;
+    pw->pmem = pmem;
+    pw->pbin = 0;
+    pw->elem_size = 0;
+    pw->elem_cnt = 0;
+
+    //  分配缓冲区
+    pw->pbuf = (char*)malloc(CWRITER_BUFF_SIZE);
+    if(pw->pbuf == 0) return -1;
+    return 0;
+}
+
+//  以二进制模式打开，数据收集到pbin中，成功返回0
+int CWriterOpenBin(SCWriter* pw, SBinData* pbin, int float_fmt, int precision)
+{
+    //  检测指针
+    if((pw == 0) || (pbin == 0)) return -1;
+
+    pw->fd = -1;
+    pw->pbuf = 0;
+    pw->len = 0;
+    pw->error = 0;
+    pw->total = 0;
+    pw->write_ms = 0.0;
+    pw->float_fmt = float_fmt;
+    pw->precision = precision;
+    pw->pmem = 0;
+    pw->pbin = pbin;
+    pw->elem_size = 0;
+    pw->elem_cnt = 0;
+    return 0;
+}
+
+//  写出剩余数据并关闭文件，写入过程中出现过错误时返回-1，成功返回0
+int CWriterClose(SCWriter* pw)
+{
+    //  检测指针
+    if(pw == 0) return -1;
+
+    //  写出剩余数据
+    if(pw->fd >= 0)
+    {
+        CWriterFlush(pw, pw->pbuf, pw->len);
+        pw->len = 0;
+        if(close(pw->fd) != 0) pw->error = 1;
+        pw->fd = -1;
+    }
+    else if(pw->pmem != 0)
+    {
+        CWriterFlush(pw, pw->pbuf, pw->len);
+        pw->len = 0;
+    }
+
+    //  释放缓冲区
+    free(pw->pbuf);
+    pw->pbuf = 0;
+
+    return pw->error ? -1 : 0;
+}
+
+//  写入一段数据
+void CWriterPut(SCWriter* pw, const char* pdata, size_t len)
+{
+    //  二进制模式下忽略文本
+    if(pw->pbin != 0) return;
+
+    pw->total += len;
+
+    //  缓冲区放不下时先写出缓冲区
+    if((pw->len + len) > CWRITER_BUFF_SIZE)
+    {
+        CWriterFlush(pw, pw->pbuf, pw->len);
+        pw->len = 0;
+
+        //  超过缓冲区大小的数据直接写入
+        if(len >= CWRITER_BUFF_SIZE)
+        {
+            CWriterFlush(pw, pdata, len);
+            return;
+        }
+    }
+
+    memcpy(pw->pbuf + pw->len, pdata, len);
+    pw->len += len;
+}
+
+//  写入字符串
+void CWriterPutStr(SCWriter* pw, const char* pstr)
+{
+    CWriterPut(pw, pstr, strlen(pstr));
+}
+
+//  写入字符串
+void CWriterPutStr(SCWriter* pw, const std::string& str)
+{
+    CWriterPut(pw, str.data(), str.size());
+}
+
+//  开始一个数组
+void CWriterBeginArray(SCWriter* pw, const std::string& name, size_t elem_size, size_t elem_cnt)
+{
+    if(pw->pbin == 0) return;
+    pw->elem_size = elem_size;
+    pw->elem_cnt = elem_cnt;
+    BinDataBeginArray(pw->pbin, name);
+}
+
+//  结束一个数组
+void CWriterEndArray(SCWriter* pw)
+{
+    if(pw->pbin == 0) return;
+    BinDataEndArray(pw->pbin, pw->elem_size * pw->elem_cnt);
+}
+
+//  二进制模式下按照当前数组元素的字节数写入一个整数
+static void CWriterPutBinInt(SCWriter* pw, unsigned long long val)
+{
+    uint8_t v8 = (uint8_t)val;
+    uint16_t v16 = (uint16_t)val;
+    uint32_t v32 = (uint32_t)val;
+    uint64_t v64 = (uint64_t)val;
+    switch(pw->elem_size)
+    {
+        case 1:     BinDataPut(pw->pbin, &v8, 1);   break;
+        case 2:     BinDataPut(pw->pbin, &v16, 2);  break;
+        case 4:     BinDataPut(pw->pbin, &v32, 4);  break;
+        default:    BinDataPut(pw->pbin, &v64, 8);  break;
+    }
+}
+
+//  按照设定的格式写入一个浮点数
+void CWriterPutFloat(SCWriter* pw, float val)
+{
+    CWriterPutFloatFmt(pw, val, pw->float_fmt, pw->precision);
+}
+
+//  按照指定的格式写入一个浮点数
+void CWriterPutFloatFmt(SCWriter* pw, float val, int float_fmt, int precision)
+{
+    if(pw->pbin != 0)
+    {
+        BinDataPut(pw->pbin, &val, sizeof(val));
+        return;
+    }
+
+    char tmp_str[FLOAT_STR_SIZE];
+    int len = FormatFloat(tmp_str, val, float_fmt, precision);
+    CWriterPut(pw, tmp_str, len);
+}
+
+//  写入一个无符号整数
+void CWriterPutUInt(SCWriter* pw, unsigned long long val)
+{
+    if(pw->pbin != 0)
+    {
+        CWriterPutBinInt(pw, val);
+        return;
+    }
+
+    char tmp_str[32];
+    std::to_chars_result re = std::to_chars(tmp_str, tmp_str + sizeof(tmp_str), val);
+    CWriterPut(pw, tmp_str, re.ptr - tmp_str);
+}
+
+//  写入一个有符号整数
+void CWriterPutInt(SCWriter* pw, long long val)
+{
+    if(pw->pbin != 0)
+    {
+        CWriterPutBinInt(pw, (unsigned long long)val);
+        return;
+    }
+
+    char tmp_str[32];
+    std::to_chars_result re = std::to_chars(tmp_str, tmp_str + sizeof(tmp_str), val);
+    CWriterPut(pw, tmp_str, re.ptr - tmp_str);
+}
+
+//  按照设定的格式将浮点数转换为字符串，返回字符串长度，pout至少需要FLOAT_STR_SIZE字节
+int FormatFloat(char* pout, float val, int float_fmt, int precision)
+{
+    char* pend = pout + FLOAT_STR_SIZE - 4;     //  预留"0x"、".0"、"f"的位置
+    std::to_chars_result re;
+
+    //  限制小数位数
+    if(precision > FLOAT_MAX_PRECISION) precision = FLOAT_MAX_PRECISION;
+
+    //  十六进制浮点数，在符号后面补上"0x"前缀
+    if(float_fmt == FLOAT_FMT_HEX)
+    {
+        if(!std::isfinite(val))
+        {
+            re = std::to_chars(pout, pend, val);
+            return (int)(re.ptr - pout);
+        }
+        char* p = pout;
+        if(std::signbit(val)) *p++ = '-';
+        *p++ = '0';
+        *p++ = 'x';
+        re = std::to_chars(p, pend, std::fabs(val), std::chars_format::hex);
+        return (int)(re.ptr - pout);
+    }
+
+    //  固定小数位数，等同于printf的"%.Nf"
+    if(float_fmt != FLOAT_FMT_SHORT)
+    {
+        if(precision < 0) precision = FLOAT_DEFAULT_PRECISION;
+        re = std::to_chars(pout, pend, val, std::chars_format::fixed, precision);
+        return (int)(re.ptr - pout);
+    }
+
+    //  非数值和无穷大无法写成更短的形式
+    if(!std::isfinite(val))
+    {
+        re = std::to_chars(pout, pend, val);
+        return (int)(re.ptr - pout);
+    }
+
+    //  最短格式
+    re = std::to_chars(pout, pend, val);
+    int len = (int)(re.ptr - pout);
+
+    //  十进制字面量在C中按double解析后再转换为float，
+    //  极少数情况下二次舍入得不到原值，此时加上f后缀按float解析
+    double tmp_d = 0.0;
+    std::from_chars(pout, pout + len, tmp_d);
+    if((float)tmp_d != val)
+    {
+        if((memchr(pout, '.', len) == 0) && (memchr(pout, 'e', len) == 0))
+        {
+            pout[len++] = '.';
+            pout[len++] = '0';
+        }
+        pout[len++] = 'f';
+        return len;
+    }
+
+    //  指定小数位数时，按小数位数舍入后去掉末尾的0
+    //  很大的数舍入后反而比最短格式长，此时仍使用精确的最短格式
+    if(precision >= 0)
+    {
+        char tmp_str[FLOAT_STR_SIZE];
+        re = std::to_chars(tmp_str, tmp_str + sizeof(tmp_str), val, std::chars_format::fixed, precision);
+        int tmp_len = (int)(re.ptr - tmp_str);
+        if(memchr(tmp_str, '.', tmp_len) != 0)
+        {
+            while(tmp_str[tmp_len - 1] == '0') tmp_len--;
+            if(tmp_str[tmp_len - 1] == '.') tmp_len--;
+        }
+        if(tmp_len < len)
+        {
+            memcpy(pout, tmp_str, tmp_len);
+            len = tmp_len;
+        }
+    }
+
+    //  负零写成整数时会丢失符号
+    if((len == 2) && (pout[0] == '-') && (pout[1] == '0'))
+    {
+        pout[len++] = '.';
+        pout[len++] = '0';
+    }
+    return len;
+}
+
+//---------------------------------------------------------------------------
+//  文件结束
@@ -0,0 +1,114 @@
+/****************************************************************************
+
+    程序名称：生成C文件用的缓冲输出
+    程序设计：rainhenry
+    程序版本：REV 0.1
+    创建日期：20261016
+
+    说明：
+        输出内容先写入内存缓冲区，攒够一大块后用一次write()写入文件，
+        代替逐个数值调用fprintf
+        浮点数支持三种格式：
+            固定小数位  与printf的"%.Nf"完全一致，默认6位，与以前生成的文件相同
+            最短格式    能够精确还原为同一个float的最短十进制写法(std::to_chars，Ryu算法)，
+                        指定小数位数时先按小数位数舍入，再去掉末尾多余的0
+            十六进制    C99十六进制浮点数，精确且与locale无关
+        二进制模式下不写文件，文本被忽略，数值按数组元素的大小收集到SBinData中
+        内存模式下缓冲区满时追加到std::string中，用于多个任务的输出合并到一个文件
+
+    版本修订：
+        REV 0.1      rainhenry     20261016    创建文档
+        REV 0.2      rainhenry     20261016    增加有符号整数输出
+        REV 0.3      rainhenry     20261016    增加二进制模式
+        REV 0.4      rainhenry     20261016    增加写入内存的模式
+        REV 0.5      rainhenry     20261017    统计写入文件的时间
+
+****************************************************************************/
+//---------------------------------------------------------------------------
+//  防止重复包含
+#ifndef __cwriter_h__
+#define __cwriter_h__
+
+//---------------------------------------------------------------------------
+//  包含头文件
+#include "binout.h"
+#include <cstddef>
+#include <string>
+
+//  浮点数输出格式
+#define FLOAT_FMT_FIXED         0       //  固定小数位，等同于"%.Nf"
+#define FLOAT_FMT_SHORT         1       //  最短的可还原格式
+#define FLOAT_FMT_HEX           2       //  C99十六进制浮点数
+
+//  浮点数输出格式的默认小数位数，与"%f"一致
+#define FLOAT_DEFAULT_PRECISION 6
+
+//  输出缓冲区的大小，缓冲区满时一次写入文件
+#define CWRITER_BUFF_SIZE       (4*1024*1024)
+
+//  浮点数转换为字符串所需的缓冲区大小，小数位数最多FLOAT_MAX_PRECISION位
+#define FLOAT_STR_SIZE          128
+#define FLOAT_MAX_PRECISION     40
+
+//  定义缓冲输出结构体
+typedef struct
+{
+    int fd;                     //  输出文件描述符
+    char* pbuf;                 //  输出缓冲区
+    size_t len;                 //  缓冲区内的数据长度
+    int error;                  //  写入过程中是否出错
+    unsigned long long total;   //  总共输出的字节数
+    double write_ms;            //  调用write()写入文件的总时间，单位ms
+
+    int float_fmt;              //  浮点数输出格式 FLOAT_FMT_XXX
+    int precision;              //  小数位数，小于0表示不限制(仅最短格式有效)
+
+    std::string* pmem;          //  内存模式下写入的字符串，写文件时为0
+    SBinData* pbin;             //  二进制模式下收集数据，文本模式为0
+    size_t elem_size;           //  当前数组元素的字节数
+    size_t elem_cnt;            //  当前数组元素的个数
+}SCWriter;
+
+//  创建输出文件，成功返回0
+int CWriterOpen(SCWriter* pw, const char* filename, int float_fmt, int precision);
+
+//  以内存模式打开，输出追加到pmem中，成功返回0
+int CWriterOpenMem(SCWriter* pw, std::string* pmem, int float_fmt, int precision);
+
+//  以二进制模式打开，数据收集到pbin中，成功返回0
+int CWriterOpenBin(SCWriter* pw, SBinData* pbin, int float_fmt, int precision);
+
+//  写出剩余数据并关闭文件，写入过程中出现过错误时返回-1，成功返回0
+int CWriterClose(SCWriter* pw);
+
+//  写入一段数据
+void CWriterPut(SCWriter* pw, const char* pdata, size_t len);
+
+//  写入字符串
+void CWriterPutStr(SCWriter* pw, const char* pstr);
+void CWriterPutStr(SCWriter* pw, const std::string& str);
+
+//  开始和结束一个数组，name为符号名，数组有elem_cnt个elem_size字节的元素
+//  文本模式下什么都不做
+void CWriterBeginArray(SCWriter* pw, const std::string& name, size_t elem_size, size_t elem_cnt);
+void CWriterEndArray(SCWriter* pw);
+
+//  按照设定的格式写入一个浮点数
+void CWriterPutFloat(SCWriter* pw, float val);
+
+//  按照指定的格式写入一个浮点数
+void CWriterPutFloatFmt(SCWriter* pw, float val, int float_fmt, int precision);
+
+//  写入一个无符号整数，二进制模式下按当前数组元素的字节数写入
+void CWriterPutUInt(SCWriter* pw, unsigned long long val);
+
+//  写入一个有符号整数，二进制模式下按当前数组元素的字节数写入
+void CWriterPutInt(SCWriter* pw, long long val);
+
+//  按照设定的格式将浮点数转换为字符串，返回字符串长度，pout至少需要FLOAT_STR_SIZE字节
+int FormatFloat(char* pout, float val, int float_fmt, int precision);
+
+#endif
+
+//---------------------------------------------------------------------------
+//  文件结束
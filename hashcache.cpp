@@ -0,0 +1,271 @@
+/****************************************************************************
+
+    程序名称：增量生成用的内容哈希和输出文件更新
+    程序设计：rainhenry
+    程序版本：REV 0.2
+    创建日期：20261017
+
+    版本修订：
+        REV 0.1      rainhenry     20261017    创建文档
+        REV 0.2      rainhenry     20261017    增加按块计算的哈希
+
+****************************************************************************/
+//---------------------------------------------------------------------------
+//  包含头文件
+#include "hashcache.h"
+#include "mapfile.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//  标记文件的格式
+#define HASH_STAMP_FORMAT       "3dobjtool %016llx\n"
+
+//  循环左移
+static inline uint64_t HashRotl(uint64_t val, int n)
+{
+    return (val << n) | (val >> (64 - n));
+}
+
+//  最终的混合，使每一位输入都影响全部输出位
+static inline uint64_t HashMix(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+//  计算一段数据的64位哈希，每次处理8个字节
+uint64_t HashBytes(const void* pdata, size_t len, uint64_t seed)
+{
+    const unsigned char* p = (const unsigned char*)pdata;
+    uint64_t h = seed ^ (len * 0x9E3779B97F4A7C15ULL);
+    size_t i = 0;
+    for(i=0;(i+8)<=len;i+=8)
+    {
+        uint64_t k;
+        memcpy(&k, p + i, 8);
+        k *= 0x87C37B91114253D5ULL;
+        k = HashRotl(k, 31);
+        k *= 0x4CF5AD432745937FULL;
+        h ^= k;
+        h = (HashRotl(h, 27) * 5) + 0x52DCE729ULL;
+    }
+
+    //  剩余不足8个字节
+    uint64_t k = 0;
+    size_t j = 0;
+    for(j=0;i<len;i++,j++)
+    {
+        k |= (uint64_t)p[i] << (j * 8);
+    }
+    k *= 0x87C37B91114253D5ULL;
+    k = HashRotl(k, 31);
+    k *= 0x4CF5AD432745937FULL;
+    h ^= k;
+
+    return HashMix(h);
+}
+
+//  按HASH_BLOCK_SIZE分块串联计算哈希，与HashFile对同样内容的结果相同
+uint64_t HashBlocks(const void* pdata, size_t len, uint64_t seed)
+{
+    const unsigned char* p = (const unsigned char*)pdata;
+    uint64_t h = seed;
+    size_t off = 0;
+    for(off=0;off<len;off+=HASH_BLOCK_SIZE)
+    {
+        size_t block = len - off;
+        if(block > HASH_BLOCK_SIZE) block = HASH_BLOCK_SIZE;
+        h = HashBytes(p + off, block, h);
+    }
+    return HashBytes(&len, sizeof(len), h);
+}
+
+//  按HASH_BLOCK_SIZE分块读取文件并计算哈希，内存占用与文件大小无关，成功返回0
+int HashFile(const char* filename, uint64_t seed, uint64_t* phash)
+{
+    int fd = open(filename, O_RDONLY);
+    if(fd < 0) return -1;
+    unsigned char* pbuf = (unsigned char*)malloc(HASH_BLOCK_SIZE);
+    if(pbuf == 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    //  每块读满后再计算，与HashBlocks的分块一致
+    uint64_t h = seed;
+    size_t total = 0;
+    size_t len = 0;
+    int re = 0;
+    while(1)
+    {
+        ssize_t rd = read(fd, pbuf + len, HASH_BLOCK_SIZE - len);
+        if((rd < 0) && (errno == EINTR)) continue;
+        if(rd < 0)
+        {
+            re = -1;
+            break;
+        }
+        len += (size_t)rd;
+        if((len == HASH_BLOCK_SIZE) || ((rd == 0) && (len > 0)))
+        {
+            h = HashBytes(pbuf, len, h);
+            total += len;
+            len = 0;
+        }
+        if(rd == 0) break;
+    }
+    free(pbuf);
+    close(fd);
+    if(re != 0) return re;
+
+    *phash = HashBytes(&total, sizeof(total), h);
+    return 0;
+}
+
+//  读取标记文件中的哈希，成功返回0
+int ReadHashStamp(const char* filename, uint64_t* phash)
+{
+    FILE* fp = fopen(filename, "rb");
+    if(fp == 0) return -1;
+    unsigned long long tmp_hash = 0;
+    int re = fscanf(fp, HASH_STAMP_FORMAT, &tmp_hash);
+    fclose(fp);
+    if(re != 1) return -1;
+    *phash = tmp_hash;
+    return 0;
+}
+
+//  写入标记文件，内容没有变化时不改写，成功返回0
+int WriteHashStamp(const char* filename, uint64_t hash)
+{
+    char tmp_str[64];
+    snprintf(tmp_str, sizeof(tmp_str), HASH_STAMP_FORMAT, (unsigned long long)hash);
+    return WriteFileIfChanged(filename, tmp_str);
+}
+
+//  判断全部文件是否都存在，都存在返回1
+int IsAllFileExist(const std::vector<std::string>& file_vec)
+{
+    size_t i = 0;
+    for(i=0;i<file_vec.size();i++)
+    {
+        struct stat st;
+        if(stat(file_vec.at(i).c_str(), &st) != 0) return 0;
+    }
+    return 1;
+}
+
+//  判断两个文件的内容是否相同，相同返回1
+static int IsSameFile(const char* pname1, const char* pname2)
+{
+    SMapFile map1;
+    SMapFile map2;
+    if(MapFileOpen(pname1, &map1, 1) != 0) return 0;
+    if(MapFileOpen(pname2, &map2, 1) != 0)
+    {
+        MapFileClose(&map1);
+        return 0;
+    }
+    int re = (map1.size == map2.size) && ((map1.size == 0) || (memcmp(map1.pdata, map2.pdata, map1.size) == 0));
+    MapFileClose(&map1);
+    MapFileClose(&map2);
+    return re;
+}
+
+//  用临时文件ptmp替换pfinal，两者内容相同时删除临时文件，保留原来的文件
+//  替换返回1，内容相同返回0，失败返回-1
+int UpdateFileIfChanged(const char* ptmp, const char* pfinal)
+{
+    if(IsSameFile(ptmp, pfinal))
+    {
+        unlink(ptmp);
+        return 0;
+    }
+    if(rename(ptmp, pfinal) != 0)
+    {
+        unlink(ptmp);
+        return -1;
+    }
+    return 1;
+}
+
+//  将字符串写入文件，内容没有变化时不改写，成功返回0
+int WriteFileIfChanged(const char* filename, const std::string& content)
+{
+    //  比较原来的内容
+    SMapFile old_map;
+    if(MapFileOpen(filename, &old_map, 1) == 0)
+    {
+        int same = (old_map.size == content.size()) && ((old_map.size == 0) || (memcmp(old_map.pdata, content.data(), old_map.size) == 0));
+        MapFileClose(&old_map);
+        if(same) return 0;
+    }
+
+    FILE* fp = fopen(filename, "wb");
+    if(fp == 0) return -1;
+    if((content.size() > 0) && (fwrite(content.data(), 1, content.size(), fp) != content.size()))
+    {
+        fclose(fp);
+        return -1;
+    }
+    if(fclose(fp) != 0) return -1;
+    return 0;
+}
+
+//  转义make中有特殊含义的字符
+static std::string GetDepEscape(const std::string& in_str)
+{
+    std::string re_str;
+    size_t i = 0;
+    for(i=0;i<in_str.size();i++)
+    {
+        char ch = in_str.at(i);
+        if((ch == ' ') || (ch == '#')) re_str += '\\';
+        if(ch == '$') re_str += '$';
+        re_str += ch;
+    }
+    return re_str;
+}
+
+//  生成make的依赖文件内容，格式与gcc -MD -MP相同
+//  cube.c cube.h: cube.obj
+//  cube.obj:
+std::string GetDepFileString(const std::vector<std::string>& target_vec, const std::vector<std::string>& dep_vec)
+{
+    std::string re_str;
+    size_t i = 0;
+    for(i=0;i<target_vec.size();i++)
+    {
+        if(i > 0) re_str += " ";
+        re_str += GetDepEscape(target_vec.at(i));
+    }
+    re_str += ":";
+    for(i=0;i<dep_vec.size();i++)
+    {
+        re_str += " \\\n ";
+        re_str += GetDepEscape(dep_vec.at(i));
+    }
+    re_str += "\n";
+
+    //  每个依赖的文件生成一个空规则，删除依赖文件后make不会报错
+    for(i=0;i<dep_vec.size();i++)
+    {
+        re_str += "\n";
+        re_str += GetDepEscape(dep_vec.at(i));
+        re_str += ":\n";
+    }
+    return re_str;
+}
+
+//---------------------------------------------------------------------------
+//  文件结束
@@ -0,0 +1,69 @@
+/****************************************************************************
+
+    程序名称：增量生成用的内容哈希和输出文件更新
+    程序设计：rainhenry
+    程序版本：REV 0.2
+    创建日期：20261017
+
+    说明：
+        输入文件的字节和全部影响输出的选项一起计算64位哈希，保存在输出文件旁边的标记文件中，
+        再次运行时哈希相同且输出文件都存在，即可跳过解码和生成
+        需要重新生成时先写入临时文件，内容与原来的输出完全相同时删除临时文件，
+        保留原来的文件和修改时间，避免包含头文件的源文件被重新编译
+
+    版本修订：
+        REV 0.1      rainhenry     20261017    创建文档
+        REV 0.2      rainhenry     20261017    增加按块计算的哈希，可以不读入整个文件
+
+****************************************************************************/
+//---------------------------------------------------------------------------
+//  防止重复包含
+#ifndef __hashcache_h__
+#define __hashcache_h__
+
+//---------------------------------------------------------------------------
+//  包含头文件
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//  临时文件的扩展名
+#define HASH_TEMP_EXT           ".tmp"
+
+//  分块计算哈希时每块的字节数
+#define HASH_BLOCK_SIZE         (1024 * 1024)
+
+//  计算一段数据的64位哈希，seed为初始值，可以把多段数据的哈希串联起来
+uint64_t HashBytes(const void* pdata, size_t len, uint64_t seed);
+
+//  按HASH_BLOCK_SIZE分块串联计算哈希，与HashFile对同样内容的结果相同
+uint64_t HashBlocks(const void* pdata, size_t len, uint64_t seed);
+
+//  按HASH_BLOCK_SIZE分块读取文件并计算哈希，内存占用与文件大小无关，成功返回0
+int HashFile(const char* filename, uint64_t seed, uint64_t* phash);
+
+//  读取标记文件中的哈希，成功返回0
+int ReadHashStamp(const char* filename, uint64_t* phash);
+
+//  写入标记文件，内容没有变化时不改写，成功返回0
+int WriteHashStamp(const char* filename, uint64_t hash);
+
+//  判断全部文件是否都存在，都存在返回1
+int IsAllFileExist(const std::vector<std::string>& file_vec);
+
+//  用临时文件ptmp替换pfinal，两者内容相同时删除临时文件，保留原来的文件
+//  替换返回1，内容相同返回0，失败返回-1
+int UpdateFileIfChanged(const char* ptmp, const char* pfinal);
+
+//  将字符串写入文件，内容没有变化时不改写，成功返回0
+int WriteFileIfChanged(const char* filename, const std::string& content);
+
+//  生成make的依赖文件内容，格式与gcc -MD -MP相同
+//  target_vec为生成的文件，dep_vec为依赖的文件
+std::string GetDepFileString(const std::vector<std::string>& target_vec, const std::vector<std::string>& dep_vec);
+
+#endif
+
+//---------------------------------------------------------------------------
+//  文件结束
@@ -9,801 +9,1104 @@
         REV 0.1      rainhenry     20201031    创建文档
         REV 0.2      rainhenry     20201110    增加对OBJ参数的控制
                                                可以分别控制顶点、UV坐标、法线等信息的生成
+        REV 0.3      rainhenry     20261016    输入文件改为mmap映射读取，管道等退化为read()
+                                               去掉2048字节的行长度限制
+        REV 0.4      rainhenry     20261016    v/vt/vn/f的数值改用专用解析代替sscanf
+                                               增加--parse-bench解析吞吐量测试
+        REV 0.5      rainhenry     20261016    增加--threads多线程分块解码
+                                               支持负数的相对索引
+        REV 0.6      rainhenry     20261016    生成C文件改为缓冲输出，整块write()写入
+                                               增加--float、--precision控制浮点数格式
+        REV 0.7      rainhenry     20261016    增加--indexed索引输出模式，(v,vt,vn)去重
+        REV 0.8      rainhenry     20261016    增加--vcache顶点缓存优化，报告ACMR/ATVR
+        REV 0.9      rainhenry     20261016    增加--vfetch顶点数据按首次使用顺序重排
+        REV 1.0      rainhenry     20261016    增加--pos、--uv、--normal、--max-error顶点属性量化编码
+        REV 1.1      rainhenry     20261016    增加--out obj/bin直接输出ELF目标文件或.bin文件
+        REV 1.2      rainhenry     20261016    增加--strip输出三角形带
+        REV 1.3      rainhenry     20261016    增加--layout按属性分组输出多个数组
+        REV 1.4      rainhenry     20261016    全局数据改为每个任务一份的SObjContext
+                                               增加--batch、--jobs、--combine多个文件批量转换
+                                               输出文件改为与输入文件在同一个目录
+        REV 1.5      rainhenry     20261017    增加--incremental按输入内容和选项的哈希跳过重复生成
+                                               输出内容没有变化时保留原来的文件
+                                               增加--depfile生成make的依赖文件
+        REV 1.6      rainhenry     20261017    解码和生成的功能独立为libobjtool静态库，本文件只处理命令行
+        REV 1.7      rainhenry     20261017    增加--stream流式转换，内存占用不随平面个数增长
+                                               生成完成后报告内存使用的峰值
+        REV 1.8      rainhenry     20261017    增加--stats、--stats-json报告各阶段的时间和计数
+        REV 1.9      rainhenry     20261017    增加--meshlet输出带包围球和法线锥的meshlet
+        REV 2.0      rainhenry     20261017    增加--batches按o/g/usemtl输出绘制批次表
+        REV 2.1      rainhenry     20261017    增加--bvh输出SAH建立的包围盒层次
+        REV 2.2      rainhenry     20261017    增加--lod、--lod-error输出QEM简化的多级细节
+        REV 2.3      rainhenry     20261017    增加--gen-normals没有法线时生成平滑法线，--tangent输出切线空间
+        REV 2.4      rainhenry     20261017    增加--overdraw按遮挡关系排列三角形，报告估计的过度绘制
+        REV 2.5      rainhenry     20261017    增加--out hpp输出C++17头文件
 
 ****************************************************************************/
 //---------------------------------------------------------------------------
 //  包含头文件
+#include "objtool.h"
+#include "mapfile.h"
+#include "workpool.h"
+#include "hashcache.h"
 #include <iostream>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <string>
+#include <chrono>
+#include <thread>
+#include <algorithm>
 #include <vector>
+#include <strings.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <glob.h>
 
-//  定义存放顶点数据的结构体
-typedef struct
-{
-    float x;
-    float y;
-    float z;
-}SVertex;
+//  程序版本，同时用于增量生成的哈希，版本变化后全部重新生成
+#define TOOL_VERSION       "REV 2.5 20261017"
 
-//  定义存放顶点数据的容器
-std::vector<SVertex> VertexVec;
+//  解码和生成的选项
+SObjOption option;
 
-//  定义存放UV坐标的数据的结构体
-typedef struct
-{
-    float u;
-    float v;
-}SUV;
+//  解析吞吐量测试模式，1=仅解码并报告解析速度，不生成C文件
+int parse_bench = 0;
 
-//  定义存放UV坐标数据的容器
-std::vector<SUV> UVVec;
+//  批量转换模式，生成等级后面可以有多个输入(文件、目录、通配符、@列表文件)
+int batch_mode = 0;
 
-//  定义法线数据结构体
-typedef struct
-{
-    float x;
-    float y;
-    float z;
-}SVertexNormal;
+//  批量转换的线程数，0=全部CPU核心
+int job_num = 0;
 
-//  定义法线数据的容器
-std::vector<SVertexNormal> VertexNormalVec;
+//  批量转换时合并输出的文件路径，不含扩展名，为空时每个输入单独输出
+std::string combine_path;
 
-//  定义平面描述数据结构体
-//  为小于0的时候表示信息索引不可用，大于等于0的时候为有效索引
-typedef struct
-{
-    int point_index1;
-    int uv_index1;
-    int vn_index1;
-
-    int point_index2;
-    int uv_index2;
-    int vn_index2;
+//  增量生成，输入内容和选项的哈希与标记文件相同时跳过生成，输出内容没有变化时不改写文件
+int incremental = 0;
 
-    int point_index3;
-    int uv_index3;
-    int vn_index3;
-}SPlaneInfo;
+//  增量生成的标记文件扩展名
+#define STAMP_EXT_NAME      ".3dstamp"
 
-//  定义平面描述数据容器
-std::vector<SPlaneInfo> PlaneInfoVec;
+//  生成make的依赖文件(.d)
+int dep_file = 0;
 
-//  OBJ内部对象名字
-std::string InternalName;
+//  流式转换，按块读取输入文件，每解析一个平面立即写出，只支持按三角形展开的C代码输出
+int stream_mode = 0;
 
-//  解码调试开关
-#define DEBUG_DECODE       0
+//  打印各阶段的时间和计数的表格
+int stats_table = 0;
 
-//  生成数据的个数
-//  1=仅仅生成 顶点信息
-//  2=生成顶点信息 + UV坐标信息
-//  3=生成顶点信息 + UV坐标信息 + 法线信息
-unsigned int gen_level = 1;
+//  各阶段的时间和计数写为JSON，每个输入文件一行，"-"为标准输出，为空时不输出
+std::string stats_json_path;
 
-//  得到当前字符串中有多少个指定的符号
-int GetStringCountChar(std::string in_str, char ch)
+//  得到影响输出内容的全部选项，用于增量生成的哈希
+std::string GetOptionKey(unsigned int gen_level)
 {
-    int re = 0;
-    int len = in_str.size();
-    int i=0;
-    for(i=0;i<len;i++)
+    char tmp_str[512];
+    snprintf(tmp_str, sizeof(tmp_str),
+             TOOL_VERSION " level=%u float=%d,%d index=%d,%d,%d strip=%d meshlet=%d,%d batch=%d bvh=%d attr=%d,%d,%d,%.17g out=%d,%d layout=",
+             gen_level,
+             option.float_fmt, option.float_precision,
+             option.index_mode, option.vcache_opt, option.vfetch_opt,
+             option.strip_mode,
+             option.meshlet_vertex, option.meshlet_tri, option.draw_batch, option.bvh_leaf,
+             option.pos_fmt, option.uv_fmt, option.normal_fmt, option.max_error,
+             option.out_mode, option.elf_arch
+            );
+    std::string re_str = tmp_str;
+    size_t i = 0;
+    for(i=0;i<option.layout_vec.size();i++)
     {
-        if(in_str.at(i) == ch)
-        {
-            re++;
-        }
+        re_str += option.layout_vec.at(i);
+        re_str += "|";
     }
-    return re;
-}
-
-//  从一个字符串中删除回车和换行
-std::string DeleteNR(std::string in_str)
-{
-    int len = in_str.size();
-    int i=0;
-    for(i=0;i<len;i++)
+    snprintf(tmp_str, sizeof(tmp_str), " normal=%.17g tangent=%d overdraw=%.17g lod=%d", option.normal_crease, option.tangent, option.overdraw_threshold, option.lod_target);
+    re_str += tmp_str;
+    for(i=0;i<option.lod_vec.size();i++)
     {
-        if((in_str.at(i) == '\r') || (in_str.at(i) == '\n'))
-        {
-            in_str.erase(in_str.begin() + i);
-            i--;
-            len--;
-        }
+        snprintf(tmp_str, sizeof(tmp_str), ",%.17g", option.lod_vec.at(i));
+        re_str += tmp_str;
     }
-    return in_str;
+    return re_str;
 }
 
-//  从文件解码OBJ到内存数据
-void DecodingOBJ(FILE* pfile)
+//  计算一个输入文件的哈希，包含全部选项
+//  按块计算，与流式转换时GetInputFileHash的结果相同
+uint64_t GetInputHash(unsigned int gen_level, const char* pdata, size_t size)
 {
-    //  检测指针
-    if(pfile == 0)  return;
+    std::string key_str = GetOptionKey(gen_level);
+    return HashBlocks(pdata, size, HashBytes(key_str.data(), key_str.size(), 0));
+}
 
-    //  定义读取缓冲区
-    char buff[2048];
+//  分块读取输入文件并计算哈希，包含全部选项，成功返回0
+int GetInputFileHash(unsigned int gen_level, const char* filename, uint64_t* phash)
+{
+    std::string key_str = GetOptionKey(gen_level);
+    return HashFile(filename, HashBytes(key_str.data(), key_str.size(), 0), phash);
+}
 
-    int line_cnt = 0;
+//  是否需要统计各阶段的时间和计数
+int IsStatsOn(void)
+{
+    return stats_table || !stats_json_path.empty();
+}
 
-    //  循环读取每一行
-    char* pre = 0;
-    do
-    {
-        //  读取一行
-        pre = fgets(buff, sizeof(buff), pfile);
+//  开始统计一个文件的转换
+void BeginStats(SObjStats* pstats, unsigned int gen_level, std::string filename)
+{
+    ObjStatsReset(pstats);
+    pstats->file = filename;
+    pstats->gen_level = gen_level;
+}
 
-        //  当读取失败
-        if(pre == 0) break;
+//  结束统计，记录总时间和内存使用的峰值
+void EndStats(SObjStats* pstats, std::chrono::steady_clock::time_point t_start)
+{
+    pstats->total_ms = ObjStatsElapsedMs(t_start);
+    pstats->peak_rss_mb = ObjStatsGetPeakRSS();
+}
 
-        //  当为内部名字
-        if((buff[0] == 'o') && (buff[1] == ' '))
+//  输出统计结果，按顺序打印表格，JSON每个文件一行，成功返回0
+int ReportStats(const std::vector<const SObjStats*>& stats_vec)
+{
+    size_t i = 0;
+    if(stats_table)
+    {
+        for(i=0;i<stats_vec.size();i++)
         {
-            //  获取内部名字
-            std::string tmp_str = &buff[2];
-
-            //  删除字符串内的回车或换行
-            InternalName = DeleteNR(tmp_str);
-
-            #if DEBUG_DECODE
-            printf("Internal Name:%s\r\n", InternalName.c_str());
-            #endif
+            printf("%s", ObjStatsGetTable(stats_vec.at(i)).c_str());
         }
-        //  当为顶点数据
-        else if((buff[0] == 'v') && (buff[1] == ' '))
-        {
-            //  定义临时顶点数据
-            SVertex tmp_v;
-            tmp_v.x = 0.0f;
-            tmp_v.y = 0.0f;
-            tmp_v.z = 0.0f;
-
-            //  获取数据
-            sscanf(&buff[2], "%f %f %f", &tmp_v.x, &tmp_v.y, &tmp_v.z);
+    }
+    if(stats_json_path.empty()) return 0;
 
-            //  保存数据
-            VertexVec.insert(VertexVec.end(), tmp_v);
+    FILE* pf = stdout;
+    if(stats_json_path != "-") pf = fopen(stats_json_path.c_str(), "wb");
+    if(pf == 0)
+    {
+        printf("Stats JSON Open Error:%s\r\n", stats_json_path.c_str());
+        return -1;
+    }
+    for(i=0;i<stats_vec.size();i++)
+    {
+        fprintf(pf, "%s\n", ObjStatsGetJson(stats_vec.at(i)).c_str());
+    }
+    if(pf != stdout) fclose(pf);
+    return 0;
+}
 
-            #if DEBUG_DECODE
-            printf("v:%f %f %f\r\n", tmp_v.x, tmp_v.y, tmp_v.z);
-            #endif
-        }
-        //  当为UV数据
-        else if((buff[0] == 'v') && (buff[1] == 't') && (buff[2] == ' ') && (gen_level >= 2))
-        {
-            //  定义临时UV数据
-            SUV tmp_t;
-            tmp_t.u = 0.0f;
-            tmp_t.v = 0.0f;
+//  判断是否为普通文件，流式转换需要读两遍输入文件
+int IsRegularFile(const char* filename)
+{
+    struct stat st;
+    return (stat(filename, &st) == 0) && S_ISREG(st.st_mode);
+}
 
-            //  获取数据
-            sscanf(&buff[3], "%f %f", &tmp_t.u, &tmp_t.v);
+//  计算合并输出的全部输入文件的哈希，包含文件名和全部选项，成功返回0
+int GetCombineHash(unsigned int gen_level, const std::vector<std::string>& file_vec, uint64_t* phash)
+{
+    std::string key_str = GetOptionKey(gen_level);
+    uint64_t hash = HashBytes(key_str.data(), key_str.size(), 0);
+    size_t i = 0;
+    for(i=0;i<file_vec.size();i++)
+    {
+        SMapFile obj_map;
+        if(MapFileOpen(file_vec.at(i).c_str(), &obj_map, option.use_mmap) != 0) return -1;
+        std::string name = ObjToolGetName(file_vec.at(i));
+        hash = HashBytes(name.data(), name.size() + 1, hash);
+        hash = HashBytes(obj_map.pdata, obj_map.size, hash);
+        MapFileClose(&obj_map);
+    }
+    *phash = hash;
+    return 0;
+}
 
-            //  格式处理
-            //tmp_t.u = 1.0f - tmp_t.u;
-            tmp_t.v = 1.0f - tmp_t.v;
+//  得到path_str对应的全部输出文件
+std::vector<std::string> GetOutputFileList(std::string path_str)
+{
+    std::vector<std::string> file_vec;
+    file_vec.push_back(path_str + ObjToolGetOutputExtName(&option));
+    if(option.out_mode != OUT_MODE_CPP) file_vec.push_back(path_str + ".h");
+    return file_vec;
+}
 
-            //  保存数据
-            UVVec.insert(UVVec.end(), tmp_t);
+//  标记文件中的哈希与hash相同，并且输出文件都存在时返回1
+int IsOutputUpToDate(std::string path_str, uint64_t hash)
+{
+    uint64_t stamp_hash = 0;
+    if(ReadHashStamp((path_str + STAMP_EXT_NAME).c_str(), &stamp_hash) != 0) return 0;
+    if(stamp_hash != hash) return 0;
+    return IsAllFileExist(GetOutputFileList(path_str));
+}
 
-            #if DEBUG_DECODE
-            printf("vt:%f %f\r\n", tmp_t.u, tmp_t.v);
-            #endif
-        }
-        //  当为法线数据
-        else if((buff[0] == 'v') && (buff[1] == 'n') && (buff[2] == ' ') && (gen_level >= 3))
-        {
-            //  定义临时法线数据
-            SVertexNormal tmp_vn;
-            tmp_vn.x = 0.0f;
-            tmp_vn.y = 0.0f;
-            tmp_vn.z = 0.0f;
+//  输出完成后写入标记文件和依赖文件，内容没有变化时不改写，成功返回0
+//  cube.c cube.h: cube.obj
+int FinishOutput(std::string path_str, uint64_t hash, const std::vector<std::string>& dep_vec)
+{
+    if(incremental && (WriteHashStamp((path_str + STAMP_EXT_NAME).c_str(), hash) != 0)) return -1;
+    if(dep_file && (WriteFileIfChanged((path_str + ".d").c_str(), GetDepFileString(GetOutputFileList(path_str), dep_vec)) != 0)) return -1;
+    return 0;
+}
 
-            //  获取数据
-            sscanf(&buff[3], "%f %f %f", &tmp_vn.x, &tmp_vn.y, &tmp_vn.z);
+//  定义批量转换的一个任务
+typedef struct
+{
+    std::string filename;                       //  输入文件
+    int re;                                     //  结果，0=成功
+    int plane_cnt;                              //  平面个数
 
-            //  保存数据
-            VertexNormalVec.insert(VertexNormalVec.end(), tmp_vn);
+    SObjOutput output;                          //  合并输出时暂存在内存中的生成结果
+    SObjStats stats;                            //  各阶段的时间和计数
+}SBatchJob;
 
-            #if DEBUG_DECODE
-            printf("vn:%f %f %f\r\n", tmp_vn.x, tmp_vn.y, tmp_vn.z);
-            #endif
-        }
-        //  当为平面数据
-        else if((buff[0] == 'f') && (buff[1] == ' '))
+//  定义批量转换的参数
+typedef struct
+{
+    std::vector<SBatchJob>* pjob_vec;           //  全部任务
+    unsigned int gen_level;                     //  生成等级
+    int combine;                                //  是否合并输出到一个文件
+}SBatchInfo;
+
+//  流式转换一个文件，增量生成的检查与普通模式相同
+//  成功返回0，文件打开失败返回-2，生成失败返回-3，最新时返回1
+int StreamConvert(const SObjOption* popt, unsigned int gen_level, std::string filename, int* pplane_cnt)
+{
+    std::string path_str = ObjToolGetOutputPath(filename);
+    std::vector<std::string> dep_vec(1, filename);
+    uint64_t hash = 0;
+    if(incremental)
+    {
+        if(GetInputFileHash(gen_level, filename.c_str(), &hash) != 0) return -2;
+        if(IsOutputUpToDate(path_str, hash))
         {
-            line_cnt++;
- 
-            //  获取当前字符串中含有多少个/符号
-            int ch_cnt = GetStringCountChar(&buff[2], '/');
-
-            //  定义临时平面数据
-            SPlaneInfo tmp_p;
-            tmp_p.point_index1 = -1;
-            tmp_p.uv_index1 = -1;
-            tmp_p.vn_index1 = -1;
-            tmp_p.point_index2 = -1;
-            tmp_p.uv_index2 = -1;
-            tmp_p.vn_index2 = -1;
-            tmp_p.point_index3 = -1;
-            tmp_p.uv_index3 = -1;
-            tmp_p.vn_index3 = -1;
-
-            //  根据数量不同，判断OBJ的格式
-            //  此时仅仅含有顶点数据
-            if(ch_cnt == (0*3))
-            {
-                //  获取数据
-                sscanf(&buff[2], "%d %d %d", 
-                       &tmp_p.point_index1, 
-                       &tmp_p.point_index2, 
-                       &tmp_p.point_index3
-                      );
-
-                //  计算成0基序的格式
-                tmp_p.point_index1--;
-                tmp_p.point_index2--;
-                tmp_p.point_index3--;
-            
-                //  保存数据
-                PlaneInfoVec.insert(PlaneInfoVec.end(), tmp_p);
-
-                #if DEBUG_DECODE
-                printf("f:%d %d %d\r\n", 
-                       tmp_p.point_index1, 
-                       tmp_p.point_index2, 
-                       tmp_p.point_index3
-                      );
-                #endif
-            }
-            //  此时有 顶点数据 和 UV数据
-            else if(ch_cnt == (1*3))
-            {
-                //  获取数据
-                sscanf(&buff[2], "%d/%d %d/%d %d/%d", 
-                       &tmp_p.point_index1, 
-                       &tmp_p.uv_index1,
-                       &tmp_p.point_index2, 
-                       &tmp_p.uv_index2,
-                       &tmp_p.point_index3,
-                       &tmp_p.uv_index3
-                      );
-            
-                //  计算成0基序的格式
-                tmp_p.point_index1--;
-                tmp_p.uv_index1--;
-                tmp_p.point_index2--;
-                tmp_p.uv_index2--;
-                tmp_p.point_index3--;
-                tmp_p.uv_index3--;
-
-                //  保存数据
-                PlaneInfoVec.insert(PlaneInfoVec.end(), tmp_p);
-
-                #if DEBUG_DECODE
-                printf("f:%d/%d %d/%d %d/%d\r\n", 
-                       tmp_p.point_index1, 
-                       tmp_p.uv_index1,
-                       tmp_p.point_index2, 
-                       tmp_p.uv_index2,
-                       tmp_p.point_index3,
-                       tmp_p.uv_index3
-                      );
-                #endif
-            }
-            //  此时有 顶点数据 和 UV数据 和 法线数据
-            else if(ch_cnt == (2*3))
-            {
-                //  获取数据
-                sscanf(&buff[2], "%d/%d/%d %d/%d/%d %d/%d/%d", 
-                       &tmp_p.point_index1, 
-                       &tmp_p.uv_index1,
-                       &tmp_p.vn_index1,
-                       &tmp_p.point_index2, 
-                       &tmp_p.uv_index2,
-                       &tmp_p.vn_index2,
-                       &tmp_p.point_index3,
-                       &tmp_p.uv_index3,
-                       &tmp_p.vn_index3
-                      );
-            
-                //  计算成0基序的格式
-                tmp_p.point_index1--;
-                tmp_p.uv_index1--;
-                tmp_p.vn_index1--;
-                tmp_p.point_index2--;
-                tmp_p.uv_index2--;
-                tmp_p.vn_index2--;
-                tmp_p.point_index3--;
-                tmp_p.uv_index3--;
-                tmp_p.vn_index3--;
-
-                //  保存数据
-                PlaneInfoVec.insert(PlaneInfoVec.end(), tmp_p);
-
-                #if DEBUG_DECODE
-                printf("f:%d/%d/%d %d/%d/%d %d/%d/%d\r\n", 
-                       tmp_p.point_index1, 
-                       tmp_p.uv_index1,
-                       tmp_p.vn_index1,
-                       tmp_p.point_index2, 
-                       tmp_p.uv_index2,
-                       tmp_p.vn_index2,
-                       tmp_p.point_index3,
-                       tmp_p.uv_index3,
-                       tmp_p.vn_index3
-                      );
-                #endif
-            }
-            //  不支持的格式 忽略
-            else
-            {
-            }
+            if(FinishOutput(path_str, hash, dep_vec) != 0) return -3;
+            if(popt->pstats != 0) popt->pstats->up_to_date = 1;
+            return 1;
         }
-
     }
-    while(pre != 0);
 
-    printf("line_cnt = %d\r\n", line_cnt);
+    SObjContext obj_ctx;
+    obj_ctx.gen_level = gen_level;
+    SObjCount count;
+    int re = ObjToolStreamCode(&obj_ctx, popt, filename, &count);
+    if(re == -1) return -2;
+    if(re != 0) return -3;
+    *pplane_cnt = (int)count.f_cnt;
+    if(FinishOutput(path_str, hash, dep_vec) != 0) return -3;
+    return 0;
 }
 
-//  从路径中获取文件名，含扩展名
-std::string GetFileNameExFromPath(std::string in_str)
+//  执行一个批量转换任务，在线程池中调用
+void RunBatchJob(size_t job, void* puser)
 {
-    //  定义返回字符串
-    std::string re_str;
-
-    //  遍历每个字符
-    int len = in_str.size();
-    int i = 0;
-    for(i=0;i<len;i++)
+    SBatchInfo* pinfo = (SBatchInfo*)puser;
+    SBatchJob* pjob = &pinfo->pjob_vec->at(job);
+
+    //  每个任务单独统计
+    std::chrono::steady_clock::time_point t_start = ObjStatsNow();
+    SObjOption job_opt = option;
+    job_opt.pstats = 0;
+    if(IsStatsOn())
     {
-        //  当不为路径分割符号，插入输出字符串
-        if((in_str.at(len-1-i) != '\\')&&(in_str.at(len-1-i) != '/'))
-        {
-            re_str.insert(re_str.begin(), in_str.at(len-1-i));
-        }
-        //  当为路径分割，直接跳出
-        else
-        {
-            break;
-        }
+        BeginStats(&pjob->stats, pinfo->gen_level, pjob->filename);
+        job_opt.pstats = &pjob->stats;
     }
 
-    //  返回字符串
-    return re_str;
-}
-
-//  从文件名中删除文件中的扩展名，输入必须仅仅是带扩展名的文件名，不能是带路径的
-std::string GetFileNameNoExFormFileName(std::string in_str)
-{
-    //  定义返回字符串
-    std::string re_str;
+    //  流式转换
+    if(stream_mode && !pinfo->combine && IsRegularFile(pjob->filename.c_str()))
+    {
+        int re = StreamConvert(&job_opt, pinfo->gen_level, pjob->filename, &pjob->plane_cnt);
+        if(job_opt.pstats != 0) EndStats(job_opt.pstats, t_start);
+        pjob->re = (re == 1) ? 0 : re;
+        if(re == -2)      printf("%s: File Open Error!!\r\n", pjob->filename.c_str());
+        else if(re < 0)   printf("%s: Gen C Code Error!!\r\n", pjob->filename.c_str());
+        else if(re == 1)  printf("%s: Up To Date!!\r\n", pjob->filename.c_str());
+        else              printf("%s: Gen %d Plane!!\r\n", pjob->filename.c_str(), pjob->plane_cnt);
+        return;
+    }
 
-    //  完全赋值给返回
-    re_str = in_str;
+    //  每个任务独立的数据
+    SObjContext obj_ctx;
+    obj_ctx.gen_level = pinfo->gen_level;
 
-    //  统计其中含有多少点
-    int dot_cnt = 0;
-    int len = in_str.size();
-    int i = 0;
-    for(i=0;i<len;i++)
+    //  尝试打开obj文件
+    SMapFile obj_map;
+    if(MapFileOpen(pjob->filename.c_str(), &obj_map, option.use_mmap) != 0)
     {
-        //  当为点的时候
-        if(in_str.at(len-1-i) == '.')
-        {
-            dot_cnt++;
-        }
+        printf("%s: File Open Error!!\r\n", pjob->filename.c_str());
+        pjob->re = -2;
+        return;
     }
+    if(job_opt.pstats != 0) job_opt.pstats->open_ms = ObjStatsElapsedMs(t_start);
 
-    //  只要里面含有点
-    if(dot_cnt >= 1)
+    //  增量生成，输出为最新时跳过解码和生成
+    std::string path_str = ObjToolGetOutputPath(pjob->filename);
+    std::vector<std::string> dep_vec(1, pjob->filename);
+    uint64_t hash = 0;
+    if(incremental && !pinfo->combine)
     {
-        //  遍历每个字符，从后面网前执行删除
-        for(i=0;i<len;i++)
+        hash = GetInputHash(pinfo->gen_level, obj_map.pdata, obj_map.size);
+        if(IsOutputUpToDate(path_str, hash))
         {
-            //  当为点
-            if(re_str.at(len-1-i) == '.')
+            MapFileClose(&obj_map);
+            pjob->re = FinishOutput(path_str, hash, dep_vec);
+            if(job_opt.pstats != 0)
             {
-                //  删除
-                re_str.erase(re_str.end()-1);
-                break;
-            }
-            //  不为点
-            else
-            {
-                re_str.erase(re_str.end()-1);
+                job_opt.pstats->up_to_date = 1;
+                EndStats(job_opt.pstats, t_start);
             }
+            if(pjob->re != 0) printf("%s: Gen C Code Error!!\r\n", pjob->filename.c_str());
+            else              printf("%s: Up To Date!!\r\n", pjob->filename.c_str());
+            return;
         }
     }
 
-    //  返回字符串
-    return re_str;
+    //  解码该文件
+    ObjToolParseMemory(&obj_ctx, &job_opt, obj_map.pdata, obj_map.size, 0);
+    MapFileClose(&obj_map);
+    pjob->plane_cnt = (int)PlaneListSize(obj_ctx.PlaneList);
+
+    //  生成数据
+    if(pinfo->combine) pjob->re = ObjToolGenData(&obj_ctx, &job_opt, ObjToolGetName(pjob->filename), &pjob->output);
+    else               pjob->re = ObjToolGenCode(&obj_ctx, &job_opt, pjob->filename);
+    if((pjob->re == 0) && !pinfo->combine) pjob->re = FinishOutput(path_str, hash, dep_vec);
+    if(job_opt.pstats != 0) EndStats(job_opt.pstats, t_start);
+
+    if(pjob->re != 0) printf("%s: Gen C Code Error!!\r\n", pjob->filename.c_str());
+    else              printf("%s: Gen %d Plane!!\r\n", pjob->filename.c_str(), pjob->plane_cnt);
+}
+
+//  将全部任务的生成结果按输入顺序合并输出到path_str对应的文件，成功返回0
+//  pstats不为0时统计写文件的时间
+int GenCCodeCombine(std::string path_str, std::vector<SBatchJob>* pjob_vec, SObjStats* pstats)
+{
+    SObjOutput output;
+    size_t i = 0;
+    for(i=0;i<pjob_vec->size();i++)
+    {
+        SObjOutput* pout = &pjob_vec->at(i).output;
+        output.c_str += pout->c_str;
+        BinDataAppend(&output.bin_data, &pout->bin_data);
+        output.decl_vec.insert(output.decl_vec.end(), pout->decl_vec.begin(), pout->decl_vec.end());
+        output.def_vec.insert(output.def_vec.end(), pout->def_vec.begin(), pout->def_vec.end());
+
+        //  释放任务占用的内存
+        std::string().swap(pout->c_str);
+        std::vector<unsigned char>().swap(pout->bin_data.data_vec);
+    }
+    SObjOption combine_opt = option;
+    combine_opt.pstats = pstats;
+    return ObjToolWriteOutput(&combine_opt, path_str, &output);
 }
 
-//  从完整路径或文件名中提取纯文件名部分，不含扩展名
-std::string GetOnlyFileNameNoEx(std::string in_str)
+//  解析多级细节的目标列表，如"0.5,0.25,0.1"，成功返回0
+//  比例需要在(0,1]范围内，按从大到小排列，误差不能为负数，按从小到大排列，都是从精细到粗糙
+int ParseLodList(const char* pstr, int target, std::vector<double>* plod_vec)
 {
-    return GetFileNameNoExFormFileName(GetFileNameExFromPath(in_str));
+    plod_vec->clear();
+    const char* p = pstr;
+    while(1)
+    {
+        char* pend = 0;
+        double val = strtod(p, &pend);
+        if(pend == p) return -1;
+        if((target == LOD_TARGET_RATIO) && ((val <= 0.0) || (val > 1.0))) return -1;
+        if((target == LOD_TARGET_ERROR) && !(val >= 0.0)) return -1;
+        plod_vec->push_back(val);
+        if(*pend == '\0') break;
+        if(*pend != ',') return -1;
+        p = pend + 1;
+    }
+    std::sort(plod_vec->begin(), plod_vec->end());
+    if(target == LOD_TARGET_RATIO) std::reverse(plod_vec->begin(), plod_vec->end());
+    return 0;
 }
 
-//  从完整路径含文件名中提取出纯路径部分
-std::string GetOnlyFilePath(std::string in_str)
+//  判断文件名是否为.obj扩展名，不区分大小写
+int IsObjFileName(const char* pname)
 {
-    //  定义返回字符串
-    std::string re_str;
+    size_t len = strlen(pname);
+    if(len < 4) return 0;
+    return strcasecmp(pname + len - 4, ".obj") == 0;
+}
 
-    //  完全赋值给返回
-    re_str = in_str;
+//  展开批量转换的输入参数，加入到pfile_vec中，成功返回0
+//  @list.txt  每行一个文件的列表文件
+//  目录       目录中全部.obj文件，按名字排序
+//  含有*?[    按通配符匹配的文件
+//  其他       文件本身
+int ExpandBatchInput(const char* parg, std::vector<std::string>* pfile_vec)
+{
+    size_t i = 0;
 
-    //  统计其中含有多少个路径分割符号
-    int ch_cnt = 0;
-    int len = in_str.size();
-    int i = 0;
-    for(i=0;i<len;i++)
+    //  列表文件
+    if(parg[0] == '@')
     {
-        //  当为路径分割符号的时候
-        if((in_str.at(len-1-i) == '\\') || (in_str.at(len-1-i) == '/'))
+        SMapFile list_map;
+        if(MapFileOpen(parg + 1, &list_map, option.use_mmap) != 0) return -1;
+        const char* p = list_map.pdata;
+        const char* pend = list_map.pdata + list_map.size;
+        while(p < pend)
         {
-            ch_cnt++;
+            const char* peol = (const char*)memchr(p, '\n', pend - p);
+            if(peol == 0) peol = pend;
+            std::string tmp_str(p, peol - p);
+            if(!tmp_str.empty() && (tmp_str.back() == '\r')) tmp_str.pop_back();
+            if(!tmp_str.empty() && (tmp_str.at(0) != '#')) pfile_vec->push_back(tmp_str);
+            p = peol + 1;
         }
+        MapFileClose(&list_map);
+        return 0;
     }
 
-    //  只要里面含有路径分割符号
-    if(ch_cnt >= 1)
+    //  目录
+    struct stat st;
+    if((stat(parg, &st) == 0) && S_ISDIR(st.st_mode))
     {
-        //  遍历每个字符，从后面网前执行删除
-        for(i=0;i<len;i++)
+        DIR* pdir = opendir(parg);
+        if(pdir == 0) return -1;
+        std::vector<std::string> name_vec;
+        struct dirent* pent = 0;
+        while((pent = readdir(pdir)) != 0)
         {
-            //  当为分割符号
-            if((in_str.at(len-1-i) == '\\') || (in_str.at(len-1-i) == '/'))
-            {
-                //  删除
-                re_str.erase(re_str.end()-1);
-                break;
-            }
-            //  不为分割符号
-            else
-            {
-                re_str.erase(re_str.end()-1);
-            }
-        }
-    }
-    //  当没有分隔符的时候，返回空
-    else
-    {
-        re_str.clear();
-    }
-
-    //  返回字符串
-    return re_str;
-}
-
-//  根据内存中的数据生成对应的C程序,成功返回0
-int GenCCode(std::string in_filename)
-{
-    //  生成目标文件的完全路径
-    std::string filename;
-    filename += GetOnlyFilePath(in_filename);
-    filename += GetOnlyFileNameNoEx(in_filename);
-    filename += ".c";
-
-    //  尝试创建新文件
-    FILE* pfile_c = fopen(filename.c_str(), "w");
-
-    //  检测文件是否创建成功
-    if(pfile_c == 0)  return -1;
-
-    //  定义临时字符串变量
-    std::string tmp_str;
-
-    //  生成包含头文件
-    //  #include "cube.h"
-    tmp_str = "#include \"";
-    tmp_str += GetOnlyFileNameNoEx(in_filename);
-    tmp_str += ".h\"\r\n";
-    fprintf(pfile_c, "%s", tmp_str.c_str());    //  写入文件
-
-    //  计算数据总量，单位float个
-    unsigned int dot_float = 0;           //  一个点有多少个float组成
-    dot_float = 3;                        //  最少的时候，1个点有3个坐标xyz组成
-    if(UVVec.size() > 0) dot_float += 2;  //  当存在UV贴图信息时，还需要两个float表示uv坐标
-    if(VertexNormalVec.size() > 0) dot_float += 3;  //  当存在法线信息时，存在法线向量
-    unsigned int float_cnt = dot_float * PlaneInfoVec.size() * 3;  //  每个平面有3个点确定
-
-    //  生成数据头部
-    //  const float cube_3d_vtn_data[324852354] = 
-    //  {
-    tmp_str = "const float ";
-    tmp_str += GetOnlyFileNameNoEx(in_filename);
-    tmp_str += "_3d_v";
-    if(UVVec.size() > 0) tmp_str += "t";
-    if(VertexNormalVec.size() > 0) tmp_str += "n";
-    tmp_str += "_data[";
-    char num_str[200];
-    memset(num_str, 0, sizeof(num_str));
-    sprintf(num_str, "%d", float_cnt);
-    tmp_str += num_str;
-    tmp_str += "] =\r\n{\r\n";
-    fprintf(pfile_c, "%s", tmp_str.c_str());    //  写入文件
-
-    //  开始写入数据
-    int plane_cnt=0;
-    int total_plane = PlaneInfoVec.size();    //  获取可用平面数量
-    int total_vex = VertexVec.size();         //  获取可用顶点数量
-    int total_uv = UVVec.size();              //  获取可用UV数量
-    int total_vn = VertexNormalVec.size();    //  获取可用法线数量
-    for(plane_cnt=0;plane_cnt<total_plane;plane_cnt++)   //  遍历每个平面
-    {
-        //  定义临时变量
-        SPlaneInfo tmp_info = PlaneInfoVec.at(plane_cnt);   //  获取当前平面信息
-        SVertex tmp_v;                                      //  临时顶点数据
-
-        //-------------------------------------------------写入顶点数据1
-        //  检查平面序号
-        if((tmp_info.point_index1 >= total_vex) || (tmp_info.point_index1 < 0)) 
-        {
-            fclose(pfile_c);    //  关闭文件 释放资源
-            return -2;
+            if(IsObjFileName(pent->d_name)) name_vec.push_back(pent->d_name);
         }
+        closedir(pdir);
+        std::sort(name_vec.begin(), name_vec.end());
 
-        //  获取顶点数据
-        tmp_v = VertexVec.at(tmp_info.point_index1);
-
-        //  写入顶点数据
-        fprintf(pfile_c, "    %f, %f, %f,    ", tmp_v.x, tmp_v.y, tmp_v.z);
-
-        //  检查是否含有UV数据
-        if((tmp_info.uv_index1 < total_uv) && (tmp_info.uv_index1 >= 0)) 
+        std::string dir_str = parg;
+        if((dir_str.back() != '/') && (dir_str.back() != '\\')) dir_str += "/";
+        for(i=0;i<name_vec.size();i++)
         {
-            //  定义临时UV数据
-            SUV tmp_uv;
-
-            //  获取UV数据
-            tmp_uv = UVVec.at(tmp_info.uv_index1);
-
-            //  写入UV数据
-            fprintf(pfile_c, "%f, %f,    ", tmp_uv.u, tmp_uv.v);
+            pfile_vec->push_back(dir_str + name_vec.at(i));
         }
+        return 0;
+    }
 
-        //  检查是否含有法线数据
-        if((tmp_info.vn_index1 < total_vn) && (tmp_info.vn_index1 >= 0) && (gen_level >= 2)) 
+    //  通配符
+    if(strpbrk(parg, "*?[") != 0)
+    {
+        glob_t tmp_glob;
+        if(glob(parg, 0, 0, &tmp_glob) != 0) return -1;
+        for(i=0;i<tmp_glob.gl_pathc;i++)
         {
-            //  定义临时法线数据
-            SVertexNormal tmp_vn;
-
-            //  获取法线数据
-            tmp_vn = VertexNormalVec.at(tmp_info.vn_index1);
-
-            //  写入法线数据
-            fprintf(pfile_c, "%f, %f, %f,    ", tmp_vn.x, tmp_vn.y, tmp_vn.z);
+            pfile_vec->push_back(tmp_glob.gl_pathv[i]);
         }
+        globfree(&tmp_glob);
+        return 0;
+    }
 
-        //  完成一个点的写入
-        fprintf(pfile_c, "\r\n");
+    //  单个文件
+    pfile_vec->push_back(parg);
+    return 0;
+}
 
-        //-------------------------------------------------写入顶点数据2
-        //  检查平面序号
-        if((tmp_info.point_index2 >= total_vex) || (tmp_info.point_index2 < 0) && (gen_level >= 3)) 
+//  批量转换，输入参数为生成等级后面的全部位置参数，成功返回0
+int RunBatch(unsigned int gen_level, const std::vector<char*>& input_vec)
+{
+    //  展开全部输入
+    std::vector<std::string> file_vec;
+    size_t i = 0;
+    for(i=0;i<input_vec.size();i++)
+    {
+        if(ExpandBatchInput(input_vec.at(i), &file_vec) != 0)
         {
-            fclose(pfile_c);    //  关闭文件 释放资源
+            printf("Batch Input Error:%s\r\n", input_vec.at(i));
             return -2;
         }
+    }
+    if(file_vec.empty())
+    {
+        printf("Batch No Input File!!\r\n");
+        return -2;
+    }
 
-        //  获取顶点数据
-        tmp_v = VertexVec.at(tmp_info.point_index2);
-
-        //  写入顶点数据
-        fprintf(pfile_c, "    %f, %f, %f,    ", tmp_v.x, tmp_v.y, tmp_v.z);
-
-        //  检查是否含有UV数据
-        if((tmp_info.uv_index2 < total_uv) && (tmp_info.uv_index2 >= 0)) 
+    //  合并输出时数组的名字不能重复
+    if(!combine_path.empty())
+    {
+        std::vector<std::string> name_vec;
+        for(i=0;i<file_vec.size();i++)
         {
-            //  定义临时UV数据
-            SUV tmp_uv;
-
-            //  获取UV数据
-            tmp_uv = UVVec.at(tmp_info.uv_index2);
-
-            //  写入UV数据
-            fprintf(pfile_c, "%f, %f,    ", tmp_uv.u, tmp_uv.v);
+            name_vec.push_back(ObjToolGetName(file_vec.at(i)));
         }
-
-        //  检查是否含有法线数据
-        if((tmp_info.vn_index2 < total_vn) && (tmp_info.vn_index2 >= 0)) 
+        std::sort(name_vec.begin(), name_vec.end());
+        for(i=1;i<name_vec.size();i++)
         {
-            //  定义临时法线数据
-            SVertexNormal tmp_vn;
-
-            //  获取法线数据
-            tmp_vn = VertexNormalVec.at(tmp_info.vn_index2);
-
-            //  写入法线数据
-            fprintf(pfile_c, "%f, %f, %f,    ", tmp_vn.x, tmp_vn.y, tmp_vn.z);
+            if(name_vec.at(i) == name_vec.at(i - 1))
+            {
+                printf("Combine Duplicate OBJ Name:%s\r\n", name_vec.at(i).c_str());
+                return -2;
+            }
         }
+    }
 
-        //  完成一个点的写入
-        fprintf(pfile_c, "\r\n");
-        
-        //-------------------------------------------------写入顶点数据3
-        //  检查平面序号
-        if((tmp_info.point_index3 >= total_vex) || (tmp_info.point_index3 < 0)) 
+    //  增量生成，合并输出为最新时跳过全部任务
+    uint64_t combine_hash = 0;
+    if(!combine_path.empty() && incremental && (GetCombineHash(gen_level, file_vec, &combine_hash) == 0))
+    {
+        if(IsOutputUpToDate(combine_path, combine_hash))
         {
-            fclose(pfile_c);    //  关闭文件 释放资源
-            return -2;
+            if(FinishOutput(combine_path, combine_hash, file_vec) != 0)
+            {
+                printf("Combine Gen C Code Error!!\r\n");
+                return -3;
+            }
+            printf("Combine %d File Up To Date!!\r\n", (int)file_vec.size());
+            return 0;
         }
+    }
 
-        //  获取顶点数据
-        tmp_v = VertexVec.at(tmp_info.point_index3);
-
-        //  写入顶点数据
-        fprintf(pfile_c, "    %f, %f, %f,    ", tmp_v.x, tmp_v.y, tmp_v.z);
+    std::vector<SBatchJob> job_vec(file_vec.size());
+    for(i=0;i<file_vec.size();i++)
+    {
+        job_vec.at(i).filename = file_vec.at(i);
+        job_vec.at(i).re = -1;
+        job_vec.at(i).plane_cnt = 0;
+    }
+    printf("Batch %d File, %d Job Thread\r\n", (int)job_vec.size(), job_num);
+
+    //  在线程池中执行
+    std::chrono::steady_clock::time_point t_start = std::chrono::steady_clock::now();
+    SBatchInfo info;
+    info.pjob_vec = &job_vec;
+    info.gen_level = gen_level;
+    info.combine = !combine_path.empty();
+    RunWorkPool(job_vec.size(), job_num, RunBatchJob, &info);
+
+    //  统计结果
+    int err_cnt = 0;
+    long long plane_cnt = 0;
+    for(i=0;i<job_vec.size();i++)
+    {
+        if(job_vec.at(i).re != 0) err_cnt++;
+        plane_cnt += job_vec.at(i).plane_cnt;
+    }
 
-        //  检查是否含有UV数据
-        if((tmp_info.uv_index3 < total_uv) && (tmp_info.uv_index3 >= 0)) 
+    //  合并输出，写文件单独统计为一行
+    std::chrono::steady_clock::time_point t_combine = ObjStatsNow();
+    SObjStats combine_stats;
+    BeginStats(&combine_stats, gen_level, combine_path + ObjToolGetOutputExtName(&option));
+    if(info.combine && (err_cnt == 0))
+    {
+        if((GenCCodeCombine(combine_path, &job_vec, IsStatsOn() ? &combine_stats : 0) != 0) || (FinishOutput(combine_path, combine_hash, file_vec) != 0))
         {
-            //  定义临时UV数据
-            SUV tmp_uv;
-
-            //  获取UV数据
-            tmp_uv = UVVec.at(tmp_info.uv_index3);
-
-            //  写入UV数据
-            fprintf(pfile_c, "%f, %f,    ", tmp_uv.u, tmp_uv.v);
+            printf("Combine Gen C Code Error!!\r\n");
+            return -3;
         }
+        printf("Combine %d File -> %s%s\r\n", (int)job_vec.size(), combine_path.c_str(), ObjToolGetOutputExtName(&option));
+        EndStats(&combine_stats, t_combine);
+    }
 
-        //  检查是否含有法线数据
-        if((tmp_info.vn_index3 < total_vn) && (tmp_info.vn_index3 >= 0)) 
+    //  全部任务完成后按输入顺序输出统计
+    if(IsStatsOn())
+    {
+        std::vector<const SObjStats*> stats_vec;
+        for(i=0;i<job_vec.size();i++)
         {
-            //  定义临时法线数据
-            SVertexNormal tmp_vn;
-
-            //  获取法线数据
-            tmp_vn = VertexNormalVec.at(tmp_info.vn_index3);
-
-            //  写入法线数据
-            fprintf(pfile_c, "%f, %f, %f,    ", tmp_vn.x, tmp_vn.y, tmp_vn.z);
+            stats_vec.push_back(&job_vec.at(i).stats);
         }
-
-        //  完成一个面的写入
-        fprintf(pfile_c, "\r\n\r\n");
+        if(info.combine && (err_cnt == 0)) stats_vec.push_back(&combine_stats);
+        if(ReportStats(stats_vec) != 0) return -3;
     }
 
-    //  结束
-    //  };
-    tmp_str = "};\r\n";
-    fprintf(pfile_c, "%s", tmp_str.c_str());    //  写入文件
-
-    //  关闭文件
-    fclose(pfile_c);
-
-    //  生成目标文件的完全路径
-    filename = "";
-    filename += GetOnlyFilePath(in_filename);
-    filename += GetOnlyFileNameNoEx(in_filename);
-    filename += ".h";
-
-    //  创建头文件
-    FILE* pfile_h = fopen(filename.c_str(), "w");
-
-    //  检测文件是否创建成功
-    if(pfile_h == 0)  return -1;
-
-    //  生成包含头文件
-    //  #ifndef __cube_h__
-    //  #define __cube_h__
-    tmp_str = "#ifndef __";
-    tmp_str += GetOnlyFileNameNoEx(in_filename);
-    tmp_str += "_h__\r\n";
-    tmp_str += "#define __";
-    tmp_str += GetOnlyFileNameNoEx(in_filename);
-    tmp_str += "_h__\r\n";
-    fprintf(pfile_h, "%s", tmp_str.c_str());    //  写入文件
-
-    //  生成C++/C兼容
-    tmp_str = "#ifdef __cplusplus\r\nextern \"C\"\r\n{\r\n#endif\r\n";
-    fprintf(pfile_h, "%s", tmp_str.c_str());    //  写入文件
-
-    //  生成数据头部
-    //  extern const float cube_3d_vtn_data[324852354];
-    tmp_str = "extern const float ";
-    tmp_str += GetOnlyFileNameNoEx(in_filename);
-    tmp_str += "_3d_v";
-    if(UVVec.size() > 0) tmp_str += "t";
-    if(VertexNormalVec.size() > 0) tmp_str += "n";
-    tmp_str += "_data[";
-    memset(num_str, 0, sizeof(num_str));
-    sprintf(num_str, "%d", float_cnt);
-    tmp_str += num_str;
-    tmp_str += "];\r\n";
-    fprintf(pfile_h, "%s", tmp_str.c_str());    //  写入文件
-
-    //  生成C++/C兼容
-    tmp_str = "#ifdef __cplusplus\r\n}\r\n#endif\r\n";
-    fprintf(pfile_h, "%s", tmp_str.c_str());    //  写入文件
-
-    //  结束
-    //  #endif
-    tmp_str = "#endif \r\n";
-    fprintf(pfile_h, "%s", tmp_str.c_str());    //  写入文件
-    
-    //  关闭文件
-    fclose(pfile_h);
-
-    //  操作成功
-    return 0;
+    std::chrono::steady_clock::time_point t_end = std::chrono::steady_clock::now();
+    printf("Batch %d File, %d Error, %lld Plane, %.3f s, Peak RSS %.1f MB\r\n",
+           (int)job_vec.size(),
+           err_cnt,
+           plane_cnt,
+           std::chrono::duration<double>(t_end - t_start).count(),
+           ObjStatsGetPeakRSS()
+          );
+    return (err_cnt == 0) ? 0 : -3;
 }
 
 //---------------------------------------------------------------------------
 //  主函数
+//  用法：3dobjtool [选项] 生成等级 OBJ文件
 int main(int argc, char** argv)
 {
     //  打印信息
     printf("\r\n");
     printf("--------------3D OBJ to C Tool----------------\r\n");
-    printf("--------------REV 0.2 20201110----------------\r\n");
+    printf("--------------" TOOL_VERSION "----------------\r\n");
     printf("----------------By rainhenry------------------\r\n");
 
+    //  选项的默认值
+    ObjToolDefaultOption(&option);
+
+    //  分离选项参数和位置参数
+    std::vector<char*> pos_args;
+    int i = 0;
+    for(i=1;i<argc;i++)
+    {
+        //  不是选项的为位置参数
+        if(strncmp(argv[i], "--", 2) != 0)
+        {
+            pos_args.push_back(argv[i]);
+        }
+        //  禁止使用mmap，强制使用read()读取输入文件
+        else if(strcmp(argv[i], "--no-mmap") == 0)
+        {
+            option.use_mmap = 0;
+        }
+        //  解析吞吐量测试
+        else if(strcmp(argv[i], "--parse-bench") == 0)
+        {
+            parse_bench = 1;
+        }
+        //  解码线程数，0=使用全部CPU核心
+        else if((strcmp(argv[i], "--threads") == 0) && ((i + 1) < argc))
+        {
+            i++;
+            option.thread_num = atoi(argv[i]);
+            if(option.thread_num <= 0) option.thread_num = (int)std::thread::hardware_concurrency();
+            if(option.thread_num <= 0) option.thread_num = 1;
+        }
+        //  输出去重后的顶点数组和索引数组
+        else if(strcmp(argv[i], "--indexed") == 0)
+        {
+            option.index_mode = 1;
+        }
+        //  重新排列三角形顺序，提高顶点缓存命中率，需要索引输出模式
+        else if(strcmp(argv[i], "--vcache") == 0)
+        {
+            option.index_mode = 1;
+            option.vcache_opt = 1;
+        }
+        //  在顶点缓存的顺序上按遮挡关系重新排列三角形，参数为簇的ACMR允许增加的比例，需要索引输出模式
+        else if((strcmp(argv[i], "--overdraw") == 0) && ((i + 1) < argc))
+        {
+            i++;
+            option.index_mode = 1;
+            option.vcache_opt = 1;
+            option.overdraw_threshold = OVERDRAW_DEF_THRESHOLD;
+            if((strcmp(argv[i], "default") != 0) &&
+               ((sscanf(argv[i], "%lf", &option.overdraw_threshold) != 1) || !(option.overdraw_threshold >= 1.0) || (option.overdraw_threshold > 3.0)))
+            {
+                printf("Not Support Overdraw:%s\r\n", argv[i]);
+                return -1;
+            }
+        }
+        //  按照首次使用的顺序重新排列顶点数据，需要索引输出模式
+        else if(strcmp(argv[i], "--vfetch") == 0)
+        {
+            option.index_mode = 1;
+            option.vfetch_opt = 1;
+        }
+        //  输出三角形带，多条带之间用图元重启索引或者退化三角形连接，需要索引输出模式
+        else if((strcmp(argv[i], "--strip") == 0) && ((i + 1) < argc))
+        {
+            i++;
+            option.index_mode = 1;
+            if(strcmp(argv[i], "restart") == 0)     option.strip_mode = STRIP_JOIN_RESTART;
+            else if(strcmp(argv[i], "degen") == 0)  option.strip_mode = STRIP_JOIN_DEGENERATE;
+            else
+            {
+                printf("Not Support Strip Join:%s\r\n", argv[i]);
+                return -1;
+            }
+        }
+        //  同时输出meshlet，参数为每块的顶点数和三角形数的上限，如"64,124"，需要索引输出模式
+        else if((strcmp(argv[i], "--meshlet") == 0) && ((i + 1) < argc))
+        {
+            i++;
+            option.index_mode = 1;
+            option.meshlet_vertex = MESHLET_DEF_VERTEX;
+            option.meshlet_tri = MESHLET_DEF_TRI;
+            if((strcmp(argv[i], "default") != 0) &&
+               ((sscanf(argv[i], "%d,%d", &option.meshlet_vertex, &option.meshlet_tri) != 2) ||
+                (option.meshlet_vertex < 3) || (option.meshlet_vertex > MESHLET_MAX_VERTEX) ||
+                (option.meshlet_tri < 1) || (option.meshlet_tri > MESHLET_MAX_TRI)))
+            {
+                printf("Not Support Meshlet:%s\r\n", argv[i]);
+                return -1;
+            }
+        }
+        //  同时输出三角形的BVH，参数为叶节点的三角形数的上限
+        else if((strcmp(argv[i], "--bvh") == 0) && ((i + 1) < argc))
+        {
+            i++;
+            option.bvh_leaf = BVH_DEF_LEAF_TRI;
+            if((strcmp(argv[i], "default") != 0) &&
+               ((sscanf(argv[i], "%d", &option.bvh_leaf) != 1) || (option.bvh_leaf < 1) || (option.bvh_leaf > BVH_MAX_LEAF_TRI)))
+            {
+                printf("Not Support BVH:%s\r\n", argv[i]);
+                return -1;
+            }
+        }
+        //  同时输出简化后的多级细节，参数为每一级三角形个数的比例或者允许的最大误差，如"0.5,0.25,0.1"
+        else if(((strcmp(argv[i], "--lod") == 0) || (strcmp(argv[i], "--lod-error") == 0)) && ((i + 1) < argc))
+        {
+            option.index_mode = 1;
+            option.lod_target = (strcmp(argv[i], "--lod") == 0) ? LOD_TARGET_RATIO : LOD_TARGET_ERROR;
+            i++;
+            if(ParseLodList(argv[i], option.lod_target, &option.lod_vec) != 0)
+            {
+                printf("Not Support LOD:%s\r\n", argv[i]);
+                return -1;
+            }
+        }
+        //  没有法线时生成平滑法线，参数为折痕角(度)，相邻平面的法线夹角大于折痕角时为硬边
+        else if((strcmp(argv[i], "--gen-normals") == 0) && ((i + 1) < argc))
+        {
+            i++;
+            option.normal_crease = NORMAL_DEF_CREASE;
+            if((strcmp(argv[i], "default") != 0) &&
+               ((sscanf(argv[i], "%lf", &option.normal_crease) != 1) || !(option.normal_crease >= 0.0) || (option.normal_crease > 180.0)))
+            {
+                printf("Not Support Normal Crease:%s\r\n", argv[i]);
+                return -1;
+            }
+        }
+        //  同时输出切线空间，没有法线时按默认的折痕角生成
+        else if(strcmp(argv[i], "--tangent") == 0)
+        {
+            option.tangent = 1;
+            if(option.normal_crease < 0.0) option.normal_crease = NORMAL_DEF_CREASE;
+        }
+        //  按o/g/usemtl排序为绘制批次，并输出批次表
+        else if(strcmp(argv[i], "--batches") == 0)
+        {
+            option.draw_batch = 1;
+        }
+        //  属性的分组布局，如"p|t|n"、"p | tn"
+        else if((strcmp(argv[i], "--layout") == 0) && ((i + 1) < argc))
+        {
+            i++;
+            if(ObjToolParseLayout(argv[i], &option.layout_vec) != 0)
+            {
+                printf("Not Support Layout:%s\r\n", argv[i]);
+                return -1;
+            }
+        }
+        //  批量转换
+        else if(strcmp(argv[i], "--batch") == 0)
+        {
+            batch_mode = 1;
+        }
+        //  批量转换的线程数
+        else if((strcmp(argv[i], "--jobs") == 0) && ((i + 1) < argc))
+        {
+            i++;
+            job_num = atoi(argv[i]);
+            if(job_num <= 0) job_num = (int)std::thread::hardware_concurrency();
+            if(job_num <= 0) job_num = 1;
+        }
+        //  批量转换时合并输出到一个文件，需要批量转换模式
+        else if((strcmp(argv[i], "--combine") == 0) && ((i + 1) < argc))
+        {
+            i++;
+            batch_mode = 1;
+            combine_path = argv[i];
+        }
+        //  增量生成
+        else if(strcmp(argv[i], "--incremental") == 0)
+        {
+            incremental = 1;
+            option.keep_unchanged = 1;
+        }
+        //  生成make的依赖文件
+        else if(strcmp(argv[i], "--depfile") == 0)
+        {
+            dep_file = 1;
+        }
+        //  流式转换
+        else if(strcmp(argv[i], "--stream") == 0)
+        {
+            stream_mode = 1;
+        }
+        //  打印各阶段的时间和计数
+        else if(strcmp(argv[i], "--stats") == 0)
+        {
+            stats_table = 1;
+        }
+        //  各阶段的时间和计数写为JSON
+        else if((strcmp(argv[i], "--stats-json") == 0) && ((i + 1) < argc))
+        {
+            i++;
+            stats_json_path = argv[i];
+        }
+        //  输出文件的类型 c/obj/bin/hpp
+        else if((strcmp(argv[i], "--out") == 0) && ((i + 1) < argc))
+        {
+            i++;
+            if(strcmp(argv[i], "c") == 0)         option.out_mode = OUT_MODE_C;
+            else if(strcmp(argv[i], "obj") == 0)  option.out_mode = OUT_MODE_OBJ;
+            else if(strcmp(argv[i], "bin") == 0)  option.out_mode = OUT_MODE_BIN;
+            else if(strcmp(argv[i], "hpp") == 0)  option.out_mode = OUT_MODE_CPP;
+            else
+            {
+                printf("Not Support Output Type:%s\r\n", argv[i]);
+                return -1;
+            }
+        }
+        //  ELF目标文件的体系结构
+        else if((strcmp(argv[i], "--elf-arch") == 0) && ((i + 1) < argc))
+        {
+            i++;
+            option.elf_arch = GetElfArchByName(argv[i]);
+            if(option.elf_arch == -2)
+            {
+                printf("Not Support ELF Arch:%s\r\n", argv[i]);
+                return -1;
+            }
+        }
+        //  顶点坐标的编码 f32/f16/s16/auto
+        else if((strcmp(argv[i], "--pos") == 0) && ((i + 1) < argc))
+        {
+            i++;
+            option.pos_fmt = GetAttrFormatByName(argv[i]);
+            if((option.pos_fmt != ATTR_FMT_AUTO) && (option.pos_fmt != ATTR_FMT_F32) && (option.pos_fmt != ATTR_FMT_F16) && (option.pos_fmt != ATTR_FMT_SNORM16))
+            {
+                printf("Not Support Position Format:%s\r\n", argv[i]);
+                return -1;
+            }
+        }
+        //  UV的编码 f32/f16/u16/auto
+        else if((strcmp(argv[i], "--uv") == 0) && ((i + 1) < argc))
+        {
+            i++;
+            option.uv_fmt = GetAttrFormatByName(argv[i]);
+            if((option.uv_fmt != ATTR_FMT_AUTO) && (option.uv_fmt != ATTR_FMT_F32) && (option.uv_fmt != ATTR_FMT_F16) && (option.uv_fmt != ATTR_FMT_UNORM16))
+            {
+                printf("Not Support UV Format:%s\r\n", argv[i]);
+                return -1;
+            }
+        }
+        //  法线的编码 f32/oct8/oct16/auto
+        else if((strcmp(argv[i], "--normal") == 0) && ((i + 1) < argc))
+        {
+            i++;
+            option.normal_fmt = GetAttrFormatByName(argv[i]);
+            if((option.normal_fmt != ATTR_FMT_AUTO) && (option.normal_fmt != ATTR_FMT_F32) && (option.normal_fmt != ATTR_FMT_OCT8) && (option.normal_fmt != ATTR_FMT_OCT16))
+            {
+                printf("Not Support Normal Format:%s\r\n", argv[i]);
+                return -1;
+            }
+        }
+        //  自动选择编码时允许的最大误差，没有单独指定编码的属性都自动选择
+        else if((strcmp(argv[i], "--max-error") == 0) && ((i + 1) < argc))
+        {
+            i++;
+            option.max_error = atof(argv[i]);
+            if(!(option.max_error >= 0.0))
+            {
+                printf("Not Support Max Error:%s\r\n", argv[i]);
+                return -1;
+            }
+        }
+        //  浮点数格式 fixed=固定小数位 short=最短可还原 hex=十六进制
+        else if((strcmp(argv[i], "--float") == 0) && ((i + 1) < argc))
+        {
+            i++;
+            if(strcmp(argv[i], "fixed") == 0)       option.float_fmt = FLOAT_FMT_FIXED;
+            else if(strcmp(argv[i], "short") == 0)  option.float_fmt = FLOAT_FMT_SHORT;
+            else if(strcmp(argv[i], "hex") == 0)    option.float_fmt = FLOAT_FMT_HEX;
+            else
+            {
+                printf("Not Support Float Format:%s\r\n", argv[i]);
+                return -1;
+            }
+        }
+        //  浮点数的小数位数
+        else if((strcmp(argv[i], "--precision") == 0) && ((i + 1) < argc))
+        {
+            i++;
+            option.float_precision = atoi(argv[i]);
+            if((option.float_precision < 0) || (option.float_precision > FLOAT_MAX_PRECISION))
+            {
+                printf("Not Support Precision:%s\r\n", argv[i]);
+                return -1;
+            }
+        }
+        //  不支持的选项
+        else
+        {
+            printf("Unknown Option:%s\r\n", argv[i]);
+            return -1;
+        }
+    }
+
     //  检查输入参数的个数
     //  当参数个数错误
-    if(argc != 3)
+    if((pos_args.size() != 2) && !(batch_mode && (pos_args.size() > 2)))
     {
         printf("Input arg number Error!!\r\n");
         return -1;
     }
+    char* level_arg = pos_args.at(0);
+    char* obj_arg = pos_args.at(1);
 
-    //  尝试打开obj文件
-    FILE* pfile_obj = fopen(argv[2], "r");
-    if(pfile_obj == 0)
+    //  流式转换只支持按三角形展开的C代码输出
+    if(stream_mode && (!ObjToolIsStreamSupported(&option) || !combine_path.empty()))
     {
-        printf("File Open Error!!\r\n");
-        return -2;
+        printf("Stream Not Support This Option, Use Normal Mode!!\r\n");
+        stream_mode = 0;
+    }
+
+    //  批量转换
+    if(batch_mode)
+    {
+        SObjContext obj_ctx;
+        sscanf(level_arg, "%d", &obj_ctx.gen_level);
+        if((obj_ctx.gen_level != 1) && (obj_ctx.gen_level != 2) && (obj_ctx.gen_level != 3))
+        {
+            printf("Not Support Generate Level!!\r\n");
+            return -3;
+        }
+        if(job_num <= 0) job_num = (int)std::thread::hardware_concurrency();
+        if(job_num <= 0) job_num = 1;
+        printf("Generate Level = %d\r\n", obj_ctx.gen_level);
+        std::vector<char*> input_vec(pos_args.begin() + 1, pos_args.end());
+        return RunBatch(obj_ctx.gen_level, input_vec);
     }
 
     //  获取生成等级
-    sscanf(argv[1], "%d", &gen_level);
-    if((gen_level != 1) && (gen_level != 2) && (gen_level != 3))
+    SObjContext obj_ctx;
+    obj_ctx.gen_level = 1;
+    sscanf(level_arg, "%d", &obj_ctx.gen_level);
+    if((obj_ctx.gen_level != 1) && (obj_ctx.gen_level != 2) && (obj_ctx.gen_level != 3))
     {
         printf("Not Support Generate Level!!\r\n");
         return -3;
     }
-    printf("Generate Level = %d\r\n", gen_level);
+
+    //  统计从打开文件开始
+    std::chrono::steady_clock::time_point t_total = ObjStatsNow();
+    SObjStats stats;
+    std::vector<const SObjStats*> stats_vec(1, &stats);
+    if(IsStatsOn())
+    {
+        BeginStats(&stats, obj_ctx.gen_level, obj_arg);
+        option.pstats = &stats;
+    }
+
+    //  流式转换，管道等无法读两遍的输入使用普通模式
+    if(stream_mode && !parse_bench && IsRegularFile(obj_arg))
+    {
+        printf("Generate Level = %d\r\n", obj_ctx.gen_level);
+        printf("Input File Name:%s\r\nOBJ Name:%s\r\n",
+               obj_arg,
+               ObjToolGetName(obj_arg).c_str()
+              );
+        int plane_cnt = 0;
+        int re = StreamConvert(&option, obj_ctx.gen_level, obj_arg, &plane_cnt);
+        if(re == -2)
+        {
+            printf("File Open Error!!\r\n");
+            return -2;
+        }
+        if(re < 0)
+        {
+            printf("Gen C Code Error!!\r\n");
+            return -3;
+        }
+        if(re == 1) printf("Up To Date!!\r\n");
+        else        printf("Gen %d Plane!!\r\n", plane_cnt);
+        printf("Peak RSS = %.1f MB\r\n", ObjStatsGetPeakRSS());
+        if(option.pstats != 0)
+        {
+            EndStats(&stats, t_total);
+            if(ReportStats(stats_vec) != 0) return -3;
+        }
+        return 0;
+    }
+
+    //  尝试打开obj文件
+    SMapFile obj_map;
+    if(MapFileOpen(obj_arg, &obj_map, option.use_mmap) != 0)
+    {
+        printf("File Open Error!!\r\n");
+        return -2;
+    }
+    if(option.pstats != 0) stats.open_ms = ObjStatsElapsedMs(t_total);
+    printf("Generate Level = %d\r\n", obj_ctx.gen_level);
+
+    //  增量生成，输出为最新时跳过解码和生成
+    std::string path_str = ObjToolGetOutputPath(obj_arg);
+    std::vector<std::string> dep_vec(1, obj_arg);
+    uint64_t hash = 0;
+    if(incremental && !parse_bench)
+    {
+        hash = GetInputHash(obj_ctx.gen_level, obj_map.pdata, obj_map.size);
+        if(IsOutputUpToDate(path_str, hash))
+        {
+            MapFileClose(&obj_map);
+            if(FinishOutput(path_str, hash, dep_vec) != 0)
+            {
+                printf("Gen C Code Error!!\r\n");
+                return -3;
+            }
+            printf("Up To Date!!\r\n");
+            if(option.pstats != 0)
+            {
+                stats.up_to_date = 1;
+                EndStats(&stats, t_total);
+                if(ReportStats(stats_vec) != 0) return -3;
+            }
+            return 0;
+        }
+    }
 
     //  获取输入文件的纯名字部分，不含扩展名
-    std::string filename_only_str = GetOnlyFileNameNoEx(argv[2]);
+    std::string filename_only_str = ObjToolGetName(obj_arg);
     printf("Input File Name:%s\r\nOBJ Name:%s\r\n",
-           argv[2],
+           obj_arg,
            filename_only_str.c_str()
           );
 
     //  解码该文件
-    DecodingOBJ(pfile_obj);
+    std::chrono::steady_clock::time_point t_start = std::chrono::steady_clock::now();
+    ObjToolParseMemory(&obj_ctx, &option, obj_map.pdata, obj_map.size, 0);
+    std::chrono::steady_clock::time_point t_end = std::chrono::steady_clock::now();
+
+    //  解码完成后即可释放输入文件
+    size_t obj_size = obj_map.size;
+    MapFileClose(&obj_map);
+
+    //  吞吐量测试模式，报告解析速度后结束
+    if(parse_bench)
+    {
+        double sec = std::chrono::duration<double>(t_end - t_start).count();
+        double mb = (double)obj_size / (1024.0 * 1024.0);
+        printf("Parse %.3f MB in %.3f ms, %.1f MB/s\r\n", mb, sec * 1000.0, (sec > 0.0) ? (mb / sec) : 0.0);
+        printf("v=%d vt=%d vn=%d f=%d\r\n",
+               (int)obj_ctx.VertexVec.size(),
+               (int)obj_ctx.UVVec.size(),
+               (int)obj_ctx.VertexNormalVec.size(),
+               (int)PlaneListSize(obj_ctx.PlaneList)
+              );
+        if(option.pstats != 0)
+        {
+            EndStats(&stats, t_total);
+            if(ReportStats(stats_vec) != 0) return -3;
+        }
+        return 0;
+    }
 
     //  写入到C文件和H文件
-    int re = GenCCode(argv[2]);
+    int re = ObjToolGenCode(&obj_ctx, &option, obj_arg);
+    if(re == 0) re = FinishOutput(path_str, hash, dep_vec);
 
     //  当生成失败
     if(re != 0)
     {
         printf("Gen C Code Error!!\r\n");
 
-        //  关闭obj文件
-        fclose(pfile_obj);
-
         //  返回失败
         return -3;
     }
     //  生成成功
     else
     {
-        printf("Gen %d Plane!!\r\n", (int)PlaneInfoVec.size());
+        printf("Gen %d Plane!!\r\n", (int)PlaneListSize(obj_ctx.PlaneList));
+        printf("Peak RSS = %.1f MB\r\n", ObjStatsGetPeakRSS());
+        if(option.pstats != 0)
+        {
+            EndStats(&stats, t_total);
+            if(ReportStats(stats_vec) != 0) return -3;
+        }
     }
 
-    //  关闭obj文件
-    fclose(pfile_obj);
-
     //  返回成功
     return 0;
 }
@@ -811,5 +1114,3 @@ int main(int argc, char** argv)
 
 //---------------------------------------------------------------------------
 //  文件结束
-
-
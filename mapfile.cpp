@@ -0,0 +1,258 @@
+/****************************************************************************
+
+    程序名称：输入文件的内存映射读取
+    程序设计：rainhenry
+    程序版本：REV 0.1
+    创建日期：20261016
+
+    版本修订：
+        REV 0.1      rainhenry     20261016    创建文档
+        REV 0.2      rainhenry     20261017    增加按块读取完整行的SLineReader
+
+****************************************************************************/
+//---------------------------------------------------------------------------
+//  包含头文件
+#include "mapfile.h"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+//  read()方式每次读取的块大小
+#define MAPFILE_READ_BLOCK      (1024*1024)
+
+//  使用read()将整个流读入堆内存，用于管道等无法映射的情况，成功返回0
+static int MapFileReadAll(int fd, SMapFile* pmap)
+{
+    char* pbuf = 0;
+    size_t cap = 0;
+    size_t len = 0;
+
+    //  循环读取直到流结束
+    for(;;)
+    {
+        //  空间不足时扩容
+        if(cap - len < MAPFILE_READ_BLOCK)
+        {
+            size_t new_cap = (cap == 0) ? (MAPFILE_READ_BLOCK * 2) : (cap * 2);
+            char* pnew = (char*)realloc(pbuf, new_cap);
+            if(pnew == 0)
+            {
+                free(pbuf);
+                return -2;
+            }
+            pbuf = pnew;
+            cap = new_cap;
+        }
+
+        //  读取一块
+        ssize_t re = read(fd, pbuf + len, cap - len);
+
+        //  被信号打断时重试
+        if((re < 0) && (errno == EINTR)) continue;
+
+        //  读取出错
+        if(re < 0)
+        {
+            free(pbuf);
+            return -2;
+        }
+
+        //  流结束
+        if(re == 0) break;
+
+        len += (size_t)re;
+    }
+
+    pmap->pdata = pbuf;
+    pmap->size = len;
+    pmap->is_mapped = 0;
+    return 0;
+}
+
+//  打开并映射文件，allow_mmap为0时强制使用read()读取
+int MapFileOpen(const char* path, SMapFile* pmap, int allow_mmap)
+{
+    //  检测指针
+    if((path == 0) || (pmap == 0)) return -1;
+
+    pmap->pdata = 0;
+    pmap->size = 0;
+    pmap->is_mapped = 0;
+
+    //  打开文件
+    int fd = open(path, O_RDONLY);
+    if(fd < 0) return -1;
+
+    //  普通文件尝试整体映射
+    struct stat st;
+    if(allow_mmap && (fstat(fd, &st) == 0) && S_ISREG(st.st_mode))
+    {
+        //  空文件无需映射
+        if(st.st_size == 0)
+        {
+            close(fd);
+            return 0;
+        }
+
+        void* paddr = mmap(0, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(paddr != MAP_FAILED)
+        {
+            //  解码为顺序访问，提示内核预读
+            madvise(paddr, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+            pmap->pdata = (const char*)paddr;
+            pmap->size = (size_t)st.st_size;
+            pmap->is_mapped = 1;
+
+            //  映射建立后即可关闭文件描述符
+            close(fd);
+            return 0;
+        }
+    }
+
+    //  映射失败或者不是普通文件，使用read()读取
+    int re = MapFileReadAll(fd, pmap);
+    close(fd);
+    return re;
+}
+
+//  释放映射或者读入的内存
+void MapFileClose(SMapFile* pmap)
+{
+    //  检测指针
+    if(pmap == 0) return;
+
+    if(pmap->pdata != 0)
+    {
+        if(pmap->is_mapped)
+        {
+            munmap((void*)pmap->pdata, pmap->size);
+        }
+        else
+        {
+            free((void*)pmap->pdata);
+        }
+    }
+
+    pmap->pdata = 0;
+    pmap->size = 0;
+    pmap->is_mapped = 0;
+}
+
+//  打开文件，成功返回0，文件打开失败返回-1
+int LineReaderOpen(const char* path, SLineReader* preader)
+{
+    //  检测指针
+    if((path == 0) || (preader == 0)) return -1;
+
+    preader->fd = -1;
+    preader->pbuf = 0;
+    preader->cap = 0;
+    preader->len = 0;
+    preader->used = 0;
+    preader->eof = 0;
+    preader->is_regular = 0;
+
+    preader->fd = open(path, O_RDONLY);
+    if(preader->fd < 0) return -1;
+
+    struct stat st;
+    if((fstat(preader->fd, &st) == 0) && S_ISREG(st.st_mode)) preader->is_regular = 1;
+    posix_fadvise(preader->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    return 0;
+}
+
+//  读取下一块数据，[*ppbegin, *ppend)从行首开始，到行尾结束，最后一行可以没有换行符
+//  得到数据返回1，文件结束返回0，读取失败返回-2
+int LineReaderNext(SLineReader* preader, const char** ppbegin, const char** ppend)
+{
+    //  移走上一次返回的数据，保留不完整的行
+    if(preader->used > 0)
+    {
+        memmove(preader->pbuf, preader->pbuf + preader->used, preader->len - preader->used);
+        preader->len -= preader->used;
+        preader->used = 0;
+    }
+
+    for(;;)
+    {
+        //  缓冲区中有完整的行，返回到最后一个换行符为止
+        if(preader->len > 0)
+        {
+            const char* p = preader->pbuf + preader->len;
+            while((p > preader->pbuf) && (p[-1] != '\n')) p--;
+            if(p > preader->pbuf)
+            {
+                preader->used = p - preader->pbuf;
+                *ppbegin = preader->pbuf;
+                *ppend = p;
+                return 1;
+            }
+        }
+
+        //  文件结束，返回最后一行
+        if(preader->eof)
+        {
+            if(preader->len == 0) return 0;
+            preader->used = preader->len;
+            *ppbegin = preader->pbuf;
+            *ppend = preader->pbuf + preader->len;
+            return 1;
+        }
+
+        //  缓冲区已满仍然没有换行符时扩大
+        if((preader->cap - preader->len) < (MAPFILE_READ_BLOCK / 2))
+        {
+            size_t new_cap = (preader->cap == 0) ? MAPFILE_READ_BLOCK : (preader->cap * 2);
+            char* pnew = (char*)realloc(preader->pbuf, new_cap);
+            if(pnew == 0) return -2;
+            preader->pbuf = pnew;
+            preader->cap = new_cap;
+        }
+
+        //  读取一块
+        ssize_t re = read(preader->fd, preader->pbuf + preader->len, preader->cap - preader->len);
+
+        //  被信号打断时重试
+        if((re < 0) && (errno == EINTR)) continue;
+
+        //  读取出错
+        if(re < 0) return -2;
+
+        if(re == 0) preader->eof = 1;
+        preader->len += (size_t)re;
+    }
+}
+
+//  回到文件开头，不是普通文件时返回-1，成功返回0
+int LineReaderRewind(SLineReader* preader)
+{
+    if(!preader->is_regular) return -1;
+    if(lseek(preader->fd, 0, SEEK_SET) != 0) return -1;
+    preader->len = 0;
+    preader->used = 0;
+    preader->eof = 0;
+    return 0;
+}
+
+//  关闭文件，释放缓冲区
+void LineReaderClose(SLineReader* preader)
+{
+    //  检测指针
+    if(preader == 0) return;
+
+    if(preader->fd >= 0) close(preader->fd);
+    free(preader->pbuf);
+    preader->fd = -1;
+    preader->pbuf = 0;
+    preader->cap = 0;
+    preader->len = 0;
+    preader->used = 0;
+}
+
+//---------------------------------------------------------------------------
+//  文件结束
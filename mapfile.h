@@ -0,0 +1,71 @@
+/****************************************************************************
+
+    程序名称：输入文件的内存映射读取
+    程序设计：rainhenry
+    程序版本：REV 0.1
+    创建日期：20261016
+
+    说明：
+        普通文件使用mmap整体映射到内存，解码时直接在映射的字节上进行，
+        不经过stdio，也没有行长度限制
+        当输入为管道等无法映射的文件时，退化为read()分块读入堆内存
+        流式转换时使用SLineReader，每次读入一块完整的行，内存占用与文件大小无关
+
+    版本修订：
+        REV 0.1      rainhenry     20261016    创建文档
+        REV 0.2      rainhenry     20261017    增加按块读取完整行的SLineReader
+
+****************************************************************************/
+//---------------------------------------------------------------------------
+//  防止重复包含
+#ifndef __mapfile_h__
+#define __mapfile_h__
+
+//---------------------------------------------------------------------------
+//  包含头文件
+#include <cstddef>
+
+//  定义输入文件映射结构体
+typedef struct
+{
+    const char* pdata;      //  文件数据的起始地址
+    size_t size;            //  文件数据的字节数
+    int is_mapped;          //  1=数据来自mmap  0=数据来自read()读入的堆内存
+}SMapFile;
+
+//  打开并映射文件，allow_mmap为0时强制使用read()读取
+//  成功返回0，文件打开失败返回-1，读取失败返回-2
+int MapFileOpen(const char* path, SMapFile* pmap, int allow_mmap);
+
+//  释放映射或者读入的内存
+void MapFileClose(SMapFile* pmap);
+
+//  定义按块读取完整行的结构体
+typedef struct
+{
+    int fd;                 //  文件描述符
+    char* pbuf;             //  缓冲区
+    size_t cap;             //  缓冲区大小，一行超过缓冲区时扩大
+    size_t len;             //  缓冲区中的字节数
+    size_t used;            //  上一次返回的字节数，下一次读取前移走
+    int eof;                //  是否已经读到文件结束
+    int is_regular;         //  是否为普通文件，只有普通文件可以重新读取
+}SLineReader;
+
+//  打开文件，成功返回0，文件打开失败返回-1
+int LineReaderOpen(const char* path, SLineReader* preader);
+
+//  读取下一块数据，[*ppbegin, *ppend)从行首开始，到行尾结束，最后一行可以没有换行符
+//  得到数据返回1，文件结束返回0，读取失败返回-2
+int LineReaderNext(SLineReader* preader, const char** ppbegin, const char** ppend);
+
+//  回到文件开头，不是普通文件时返回-1，成功返回0
+int LineReaderRewind(SLineReader* preader);
+
+//  关闭文件，释放缓冲区
+void LineReaderClose(SLineReader* preader);
+
+#endif
+
+//---------------------------------------------------------------------------
+//  文件结束
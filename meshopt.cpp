@@ -0,0 +1,1820 @@
+/****************************************************************************
+
+    程序名称：网格的索引化与优化处理
+    程序设计：rainhenry
+    程序版本：REV 0.1
+    创建日期：20261016
+
+    版本修订：
+        REV 0.1      rainhenry     20261016    创建文档
+        REV 0.2      rainhenry     20261016    增加顶点缓存优化和ACMR/ATVR统计
+        REV 0.3      rainhenry     20261016    增加顶点数据重排和取数据局部性统计
+        REV 0.4      rainhenry     20261016    增加不去重的网格，用于属性量化编码
+        REV 0.5      rainhenry     20261016    增加三角形带的生成
+        REV 0.6      rainhenry     20261017    平面数据改为紧凑保存的SPlaneList
+        REV 0.7      rainhenry     20261017    增加meshlet的生成
+        REV 0.8      rainhenry     20261017    增加SAH包围盒层次的生成
+        REV 0.9      rainhenry     20261017    增加QEM网格简化
+        REV 1.0      rainhenry     20261017    增加减少过度绘制的三角形排序和软件光栅化统计
+
+****************************************************************************/
+//---------------------------------------------------------------------------
+//  包含头文件
+#include "meshopt.h"
+#include <cstdint>
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+
+//  计算顶点索引组合的哈希值
+static inline uint64_t HashVertexKey(const SVertexKey& key)
+{
+    uint64_t h = (uint64_t)(uint32_t)key.point_index;
+    h = (h * 0x9E3779B97F4A7C15ULL) ^ (uint64_t)(uint32_t)key.uv_index;
+    h = (h * 0x9E3779B97F4A7C15ULL) ^ (uint64_t)(uint32_t)key.vn_index;
+    h ^= h >> 29;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 32;
+    return h;
+}
+
+//  取出全部平面中第corner个点的索引组合，不可用的UV和法线统一为-1
+//  成功返回0，顶点索引无效时返回-2
+static int GetPlaneVertexKey(const SPlaneList& plane_list, size_t corner, int total_v, int total_uv, int total_vn, SVertexKey* pkey)
+{
+    PlaneListGetCorner(plane_list, corner, &pkey->point_index, &pkey->uv_index, &pkey->vn_index);
+
+    //  检查顶点序号
+    if((pkey->point_index >= total_v) || (pkey->point_index < 0)) return -2;
+
+    if((pkey->uv_index >= total_uv) || (pkey->uv_index < 0)) pkey->uv_index = -1;
+    if((pkey->vn_index >= total_vn) || (pkey->vn_index < 0)) pkey->vn_index = -1;
+    return 0;
+}
+
+//  对平面描述进行索引化
+int BuildIndexedMesh(const SPlaneList& plane_list, int total_v, int total_uv, int total_vn, SIndexedMesh* pmesh)
+{
+    //  检测指针
+    if(pmesh == 0) return -1;
+
+    pmesh->vertex_vec.clear();
+    pmesh->index_vec.clear();
+
+    //  开放寻址哈希表，存放顶点序号+1，0表示空位，容量不少于点数的2倍
+    size_t corner_cnt = PlaneListSize(plane_list) * 3;
+    size_t table_size = 16;
+    while(table_size < (corner_cnt * 2)) table_size *= 2;
+    std::vector<unsigned int> table_vec(table_size, 0);
+    size_t table_mask = table_size - 1;
+
+    pmesh->index_vec.reserve(corner_cnt);
+
+    //  遍历每个点
+    size_t i = 0;
+    for(i=0;i<corner_cnt;i++)
+    {
+        SVertexKey key;
+        if(GetPlaneVertexKey(plane_list, i, total_v, total_uv, total_vn, &key) != 0) return -2;
+
+        //  查找哈希表
+        size_t pos = (size_t)HashVertexKey(key) & table_mask;
+        for(;;)
+        {
+            unsigned int slot = table_vec[pos];
+
+            //  新的顶点
+            if(slot == 0)
+            {
+                pmesh->vertex_vec.push_back(key);
+                table_vec[pos] = (unsigned int)pmesh->vertex_vec.size();
+                pmesh->index_vec.push_back((unsigned int)(pmesh->vertex_vec.size() - 1));
+                break;
+            }
+
+            //  已经存在的顶点
+            const SVertexKey& old_key = pmesh->vertex_vec[slot - 1];
+            if((old_key.point_index == key.point_index) &&
+               (old_key.uv_index == key.uv_index) &&
+               (old_key.vn_index == key.vn_index))
+            {
+                pmesh->index_vec.push_back(slot - 1);
+                break;
+            }
+
+            pos = (pos + 1) & table_mask;
+        }
+    }
+
+    return 0;
+}
+
+//  不去重，每个点都作为单独的顶点，索引为0,1,2,...
+int BuildFlatMesh(const SPlaneList& plane_list, int total_v, int total_uv, int total_vn, SIndexedMesh* pmesh)
+{
+    //  检测指针
+    if(pmesh == 0) return -1;
+
+    size_t corner_cnt = PlaneListSize(plane_list) * 3;
+    pmesh->vertex_vec.resize(corner_cnt);
+    pmesh->index_vec.resize(corner_cnt);
+
+    size_t i = 0;
+    for(i=0;i<corner_cnt;i++)
+    {
+        if(GetPlaneVertexKey(plane_list, i, total_v, total_uv, total_vn, &pmesh->vertex_vec[i]) != 0) return -2;
+        pmesh->index_vec[i] = (unsigned int)i;
+    }
+
+    return 0;
+}
+
+//  根据顶点个数选择能容纳全部索引的最小索引字节数 1/2/4
+int GetIndexSize(size_t vertex_cnt)
+{
+    if(vertex_cnt <= 0x100)   return 1;
+    if(vertex_cnt <= 0x10000) return 2;
+    return 4;
+}
+
+//  模拟cache_size大小的FIFO顶点缓存
+void AnalyzeVertexCache(const std::vector<unsigned int>& index_vec, size_t vertex_cnt, int cache_size, double* pacmr, double* patvr)
+{
+    //  每个顶点最后一次进入缓存时的时间戳，缓存中的顶点满足 当前时间戳 - 进入时间戳 < 缓存大小
+    std::vector<unsigned long long> stamp_vec(vertex_cnt, 0);
+    unsigned long long now = (unsigned long long)cache_size + 1;
+    unsigned long long miss = 0;
+
+    size_t i = 0;
+    for(i=0;i<index_vec.size();i++)
+    {
+        unsigned int v = index_vec[i];
+        if((now - stamp_vec[v]) > (unsigned long long)cache_size)
+        {
+            stamp_vec[v] = now;
+            now++;
+            miss++;
+        }
+    }
+
+    size_t tri_cnt = index_vec.size() / 3;
+    *pacmr = (tri_cnt > 0) ? ((double)miss / (double)tri_cnt) : 0.0;
+    *patvr = (vertex_cnt > 0) ? ((double)miss / (double)vertex_cnt) : 0.0;
+}
+
+//  Forsyth算法中顶点在缓存中位置的得分表和剩余三角形数的得分表
+#define VCACHE_VALENCE_MAX      32
+
+static float vcache_pos_score[VCACHE_OPT_SIZE];
+static float vcache_valence_score[VCACHE_VALENCE_MAX];
+
+//  初始化得分表
+static void InitVertexScoreTable(void)
+{
+    int i = 0;
+    for(i=0;i<VCACHE_OPT_SIZE;i++)
+    {
+        //  最近的一个三角形的3个顶点得分固定，以免总是选择刚刚用过的三角形
+        if(i < 3)
+        {
+            vcache_pos_score[i] = 0.75f;
+        }
+        else
+        {
+            float scaler = 1.0f / (float)(VCACHE_OPT_SIZE - 3);
+            vcache_pos_score[i] = powf(1.0f - ((float)(i - 3) * scaler), 1.5f);
+        }
+    }
+
+    //  剩余三角形越少的顶点得分越高，尽快用完，避免留下孤立的三角形
+    vcache_valence_score[0] = 0.0f;
+    for(i=1;i<VCACHE_VALENCE_MAX;i++)
+    {
+        vcache_valence_score[i] = 2.0f * powf((float)i, -0.5f);
+    }
+}
+
+//  计算一个顶点的得分，cache_pos小于0表示不在缓存中
+static inline float GetVertexScore(int cache_pos, unsigned int remain)
+{
+    //  所有三角形都已输出的顶点不再有得分
+    if(remain == 0) return -1.0f;
+
+    float score = 0.0f;
+    if(cache_pos >= 0) score = vcache_pos_score[cache_pos];
+    score += vcache_valence_score[(remain < VCACHE_VALENCE_MAX) ? remain : (VCACHE_VALENCE_MAX - 1)];
+    return score;
+}
+
+//  重新排列三角形的顺序，提高顶点变换后缓存的命中率
+//  线性时间的Forsyth算法：每次从缓存中顶点关联的三角形里选得分最高的输出
+void OptimizeVertexCache(std::vector<unsigned int>* pindex_vec, size_t vertex_cnt)
+{
+    //  检测指针
+    if(pindex_vec == 0) return;
+
+    std::vector<unsigned int>& index_vec = *pindex_vec;
+    size_t tri_cnt = index_vec.size() / 3;
+    if(tri_cnt == 0) return;
+
+    InitVertexScoreTable();
+
+    //  统计每个顶点关联的三角形，按顶点顺序连续存放
+    std::vector<unsigned int> offset_vec(vertex_cnt + 1, 0);
+    size_t i = 0;
+    for(i=0;i<(tri_cnt * 3);i++)
+    {
+        offset_vec[index_vec[i] + 1]++;
+    }
+    for(i=0;i<vertex_cnt;i++)
+    {
+        offset_vec[i + 1] += offset_vec[i];
+    }
+    std::vector<unsigned int> adj_vec(tri_cnt * 3);
+    std::vector<unsigned int> remain_vec(vertex_cnt, 0);        //  每个顶点尚未输出的三角形数
+    for(i=0;i<(tri_cnt * 3);i++)
+    {
+        unsigned int v = index_vec[i];
+        adj_vec[offset_vec[v] + remain_vec[v]] = (unsigned int)(i / 3);
+        remain_vec[v]++;
+    }
+
+    //  顶点和三角形的初始得分
+    std::vector<int> cache_pos_vec(vertex_cnt, -1);
+    std::vector<float> vertex_score_vec(vertex_cnt);
+    for(i=0;i<vertex_cnt;i++)
+    {
+        vertex_score_vec[i] = GetVertexScore(-1, remain_vec[i]);
+    }
+    std::vector<float> tri_score_vec(tri_cnt);
+    std::vector<unsigned char> emitted_vec(tri_cnt, 0);
+    for(i=0;i<tri_cnt;i++)
+    {
+        tri_score_vec[i] = vertex_score_vec[index_vec[(i * 3) + 0]] +
+                           vertex_score_vec[index_vec[(i * 3) + 1]] +
+                           vertex_score_vec[index_vec[(i * 3) + 2]];
+    }
+
+    //  模拟的LRU缓存，多出3个位置存放新加入的顶点
+    unsigned int cache[VCACHE_OPT_SIZE + 3];
+    unsigned int new_cache[VCACHE_OPT_SIZE + 3];
+    int cache_cnt = 0;
+
+    std::vector<unsigned int> out_vec;
+    out_vec.reserve(tri_cnt * 3);
+
+    //  缓存中没有可用三角形时，从此位置开始顺序查找未输出的三角形
+    size_t scan_pos = 0;
+
+    //  先选择得分最高的三角形作为起点
+    size_t best_tri = 0;
+    for(i=1;i<tri_cnt;i++)
+    {
+        if(tri_score_vec[i] > tri_score_vec[best_tri]) best_tri = i;
+    }
+
+    size_t out_cnt = 0;
+    while(out_cnt < tri_cnt)
+    {
+        //  输出三角形
+        emitted_vec[best_tri] = 1;
+        out_cnt++;
+        int k = 0;
+        for(k=0;k<3;k++)
+        {
+            out_vec.push_back(index_vec[(best_tri * 3) + k]);
+        }
+
+        //  三角形的3个顶点移到缓存最前面，其余顶点依次后移
+        int new_cnt = 0;
+        for(k=0;k<3;k++)
+        {
+            unsigned int v = index_vec[(best_tri * 3) + k];
+            if((new_cnt == 0) || ((new_cache[0] != v) && (new_cache[new_cnt - 1] != v)))
+            {
+                new_cache[new_cnt++] = v;
+            }
+
+            //  从顶点的关联三角形中移除已输出的三角形
+            unsigned int* padj = &adj_vec[offset_vec[v]];
+            unsigned int n = remain_vec[v];
+            unsigned int j = 0;
+            for(j=0;j<n;j++)
+            {
+                if(padj[j] == best_tri)
+                {
+                    padj[j] = padj[n - 1];
+                    break;
+                }
+            }
+            remain_vec[v]--;
+        }
+        for(k=0;k<cache_cnt;k++)
+        {
+            unsigned int v = cache[k];
+            if((v != new_cache[0]) && ((new_cnt < 2) || (v != new_cache[1])) && ((new_cnt < 3) || (v != new_cache[2])))
+            {
+                new_cache[new_cnt++] = v;
+            }
+        }
+
+        //  更新缓存中顶点的得分，以及它们关联的三角形的得分，同时找出得分最高的三角形
+        float best_score = -1.0f;
+        size_t next_tri = tri_cnt;
+        for(k=0;k<new_cnt;k++)
+        {
+            unsigned int v = new_cache[k];
+            int pos = (k < VCACHE_OPT_SIZE) ? k : -1;
+            cache_pos_vec[v] = pos;
+            float new_score = GetVertexScore(pos, remain_vec[v]);
+            float diff = new_score - vertex_score_vec[v];
+            vertex_score_vec[v] = new_score;
+
+            unsigned int* padj = &adj_vec[offset_vec[v]];
+            unsigned int j = 0;
+            for(j=0;j<remain_vec[v];j++)
+            {
+                unsigned int t = padj[j];
+                tri_score_vec[t] += diff;
+                if((pos >= 0) && (tri_score_vec[t] > best_score))
+                {
+                    best_score = tri_score_vec[t];
+                    next_tri = t;
+                }
+            }
+        }
+
+        //  被挤出缓存的顶点不再保留
+        cache_cnt = (new_cnt < VCACHE_OPT_SIZE) ? new_cnt : VCACHE_OPT_SIZE;
+        for(k=0;k<cache_cnt;k++)
+        {
+            cache[k] = new_cache[k];
+        }
+
+        //  缓存中的顶点都没有剩余的三角形，顺序找下一个未输出的三角形
+        if(next_tri == tri_cnt)
+        {
+            while((scan_pos < tri_cnt) && emitted_vec[scan_pos]) scan_pos++;
+            if(scan_pos >= tri_cnt) break;
+            next_tri = scan_pos;
+        }
+        best_tri = next_tri;
+    }
+
+    index_vec.swap(out_vec);
+}
+
+//  模拟FIFO顶点缓存处理一个三角形，返回未命中的次数
+static inline int GetOverdrawCacheMiss(std::vector<unsigned long long>* pstamp_vec, unsigned long long* pnow, const unsigned int* ptri)
+{
+    int miss = 0;
+    int k = 0;
+    for(k=0;k<3;k++)
+    {
+        if((*pnow - (*pstamp_vec)[ptri[k]]) > (unsigned long long)VCACHE_STAT_SIZE)
+        {
+            (*pstamp_vec)[ptri[k]] = *pnow;
+            (*pnow)++;
+            miss++;
+        }
+    }
+    return miss;
+}
+
+//  定义排序用的簇
+typedef struct
+{
+    double key;                     //  朝外的程度，越大越先画
+    size_t index;                   //  簇的序号，key相同时保持原来的顺序
+}SOverdrawCluster;
+
+//  按key从大到小排序
+static inline bool OverdrawClusterLess(const SOverdrawCluster& a, const SOverdrawCluster& b)
+{
+    if(a.key != b.key) return a.key > b.key;
+    return a.index < b.index;
+}
+
+//  计算三角形的叉积(面积的2倍乘以法线)和重心
+static inline void GetOverdrawTriangle(const std::vector<float>& pos_vec, const unsigned int* ptri, double* pn, double* pc)
+{
+    const float* p0 = &pos_vec[ptri[0] * 3];
+    const float* p1 = &pos_vec[ptri[1] * 3];
+    const float* p2 = &pos_vec[ptri[2] * 3];
+    double e1[3] = { (double)p1[0] - p0[0], (double)p1[1] - p0[1], (double)p1[2] - p0[2] };
+    double e2[3] = { (double)p2[0] - p0[0], (double)p2[1] - p0[1], (double)p2[2] - p0[2] };
+    pn[0] = e1[1] * e2[2] - e1[2] * e2[1];
+    pn[1] = e1[2] * e2[0] - e1[0] * e2[2];
+    pn[2] = e1[0] * e2[1] - e1[1] * e2[0];
+    int k = 0;
+    for(k=0;k<3;k++) pc[k] = ((double)p0[k] + p1[k] + p2[k]) / 3.0;
+}
+
+//  按遮挡关系重新排列三角形
+void OptimizeOverdraw(std::vector<unsigned int>* pindex_vec, const std::vector<float>& pos_vec, double threshold, size_t* pcluster_cnt)
+{
+    std::vector<unsigned int>& index_vec = *pindex_vec;
+    size_t tri_cnt = index_vec.size() / 3;
+    if(pcluster_cnt != 0) *pcluster_cnt = 0;
+    if(tri_cnt == 0) return;
+
+    //  每个三角形的缓存未命中次数，3次未命中的三角形作为一部分的开始
+    std::vector<unsigned long long> stamp_vec(pos_vec.size() / 3, 0);
+    unsigned long long now = (unsigned long long)VCACHE_STAT_SIZE + 1;
+    std::vector<unsigned char> miss_vec(tri_cnt);
+    std::vector<size_t> part_vec;
+    size_t t = 0;
+    for(t=0;t<tri_cnt;t++)
+    {
+        miss_vec[t] = (unsigned char)GetOverdrawCacheMiss(&stamp_vec, &now, &index_vec[t * 3]);
+        if((t == 0) || (miss_vec[t] == 3)) part_vec.push_back(t);
+    }
+    part_vec.push_back(tri_cnt);
+
+    //  每部分按顺序累加，ACMR降到该部分的threshold倍以内时结束一个簇
+    //  簇的第一个三角形按空缓存计算，所以重新模拟缓存
+    std::vector<size_t> bound_vec;
+    size_t p = 0;
+    for(p=0;(p+1)<part_vec.size();p++)
+    {
+        size_t start = part_vec[p];
+        size_t end = part_vec[p + 1];
+        unsigned long long part_miss = 0;
+        for(t=start;t<end;t++) part_miss += miss_vec[t];
+        double limit = (double)part_miss / (double)(end - start) * threshold;
+
+        now += (unsigned long long)VCACHE_STAT_SIZE + 1;
+        bound_vec.push_back(start);
+        unsigned long long run_miss = 0;
+        size_t run_tri = 0;
+        for(t=start;t<end;t++)
+        {
+            run_miss += (unsigned long long)GetOverdrawCacheMiss(&stamp_vec, &now, &index_vec[t * 3]);
+            run_tri++;
+            if(((double)run_miss <= (limit * (double)run_tri)) && ((t + 1) < end))
+            {
+                bound_vec.push_back(t + 1);
+                now += (unsigned long long)VCACHE_STAT_SIZE + 1;
+                run_miss = 0;
+                run_tri = 0;
+            }
+        }
+
+        //  最后一个簇没有达到目标时并入前一个簇，避免剩下几个三角形单独成为ACMR很差的簇
+        if(((double)run_miss > (limit * (double)run_tri)) && (bound_vec.back() != start)) bound_vec.pop_back();
+    }
+    bound_vec.push_back(tri_cnt);
+    size_t cluster_cnt = bound_vec.size() - 1;
+    if(pcluster_cnt != 0) *pcluster_cnt = cluster_cnt;
+    if(cluster_cnt <= 1) return;
+
+    //  按面积加权的网格中心和每个簇的中心、平均法线
+    std::vector<double> center_vec(cluster_cnt * 3, 0.0);
+    std::vector<double> normal_vec(cluster_cnt * 3, 0.0);
+    std::vector<double> area_vec(cluster_cnt, 0.0);
+    double mesh_center[3] = { 0.0, 0.0, 0.0 };
+    double mesh_area = 0.0;
+    size_t c = 0;
+    int k = 0;
+    for(c=0;c<cluster_cnt;c++)
+    {
+        for(t=bound_vec[c];t<bound_vec[c + 1];t++)
+        {
+            double n[3];
+            double tc[3];
+            GetOverdrawTriangle(pos_vec, &index_vec[t * 3], n, tc);
+            double area = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            for(k=0;k<3;k++)
+            {
+                center_vec[c * 3 + k] += tc[k] * area;
+                normal_vec[c * 3 + k] += n[k];
+                mesh_center[k] += tc[k] * area;
+            }
+            area_vec[c] += area;
+        }
+        mesh_area += area_vec[c];
+    }
+    if(mesh_area > 0.0)
+    {
+        for(k=0;k<3;k++) mesh_center[k] /= mesh_area;
+    }
+
+    //  簇的中心相对网格中心的位置在平均法线上的投影作为排序的依据
+    std::vector<SOverdrawCluster> sort_vec(cluster_cnt);
+    for(c=0;c<cluster_cnt;c++)
+    {
+        sort_vec[c].index = c;
+        sort_vec[c].key = 0.0;
+        const double* pn = &normal_vec[c * 3];
+        double len = sqrt(pn[0] * pn[0] + pn[1] * pn[1] + pn[2] * pn[2]);
+        if((area_vec[c] <= 0.0) || (len <= 0.0)) continue;
+        for(k=0;k<3;k++)
+        {
+            sort_vec[c].key += (center_vec[c * 3 + k] / area_vec[c] - mesh_center[k]) * (pn[k] / len);
+        }
+    }
+    std::sort(sort_vec.begin(), sort_vec.end(), OverdrawClusterLess);
+
+    //  按簇的新顺序输出
+    std::vector<unsigned int> out_vec;
+    out_vec.reserve(index_vec.size());
+    for(c=0;c<cluster_cnt;c++)
+    {
+        size_t src = sort_vec[c].index;
+        out_vec.insert(out_vec.end(), index_vec.begin() + bound_vec[src] * 3, index_vec.begin() + bound_vec[src + 1] * 3);
+    }
+    index_vec.swap(out_vec);
+}
+
+//  边函数，p在从a到b的有向边左侧时为正
+static inline float GetOverdrawEdge(const float* pa, const float* pb, float px, float py)
+{
+    return (pb[0] - pa[0]) * (py - pa[1]) - (pb[1] - pa[1]) * (px - pa[0]);
+}
+
+//  像素中心正好在边上时只归属于共用该边的两个三角形中的一个
+static inline int IsOverdrawEdgeOwner(const float* pa, const float* pb)
+{
+    float dx = pb[0] - pa[0];
+    float dy = pb[1] - pa[1];
+    return ((dy < 0.0f) || ((dy == 0.0f) && (dx > 0.0f))) ? 1 : 0;
+}
+
+//  光栅化一个三角形，pv为3个点的屏幕坐标x,y和深度z，深度小的在前面
+//  逆时针的三角形为正面，背面和退化的三角形不绘制，*pshaded累加通过深度测试的像素数
+static void RasterizeOverdraw(const float (*pv)[3], std::vector<float>* pdepth_vec, unsigned long long* pshaded)
+{
+    float area = GetOverdrawEdge(pv[0], pv[1], pv[2][0], pv[2][1]);
+    if(!(area > 0.0f)) return;
+
+    //  像素中心在(x+0.5, y+0.5)
+    float min_x = std::min(pv[0][0], std::min(pv[1][0], pv[2][0]));
+    float max_x = std::max(pv[0][0], std::max(pv[1][0], pv[2][0]));
+    float min_y = std::min(pv[0][1], std::min(pv[1][1], pv[2][1]));
+    float max_y = std::max(pv[0][1], std::max(pv[1][1], pv[2][1]));
+    int x0 = std::max(0, (int)floorf(min_x - 0.5f));
+    int x1 = std::min(OVERDRAW_VIEW_SIZE - 1, (int)ceilf(max_x - 0.5f));
+    int y0 = std::max(0, (int)floorf(min_y - 0.5f));
+    int y1 = std::min(OVERDRAW_VIEW_SIZE - 1, (int)ceilf(max_y - 0.5f));
+
+    int own0 = IsOverdrawEdgeOwner(pv[1], pv[2]);
+    int own1 = IsOverdrawEdgeOwner(pv[2], pv[0]);
+    int own2 = IsOverdrawEdgeOwner(pv[0], pv[1]);
+    float inv_area = 1.0f / area;
+
+    int x = 0;
+    int y = 0;
+    for(y=y0;y<=y1;y++)
+    {
+        float py = (float)y + 0.5f;
+        for(x=x0;x<=x1;x++)
+        {
+            float px = (float)x + 0.5f;
+            float w0 = GetOverdrawEdge(pv[1], pv[2], px, py);
+            float w1 = GetOverdrawEdge(pv[2], pv[0], px, py);
+            float w2 = GetOverdrawEdge(pv[0], pv[1], px, py);
+            if((w0 < 0.0f) || ((w0 == 0.0f) && !own0)) continue;
+            if((w1 < 0.0f) || ((w1 == 0.0f) && !own1)) continue;
+            if((w2 < 0.0f) || ((w2 == 0.0f) && !own2)) continue;
+
+            float z = (w0 * pv[0][2] + w1 * pv[1][2] + w2 * pv[2][2]) * inv_area;
+            float& depth = (*pdepth_vec)[y * OVERDRAW_VIEW_SIZE + x];
+            if(z < depth)
+            {
+                depth = z;
+                (*pshaded)++;
+            }
+        }
+    }
+}
+
+//  用软件光栅化估计过度绘制
+double AnalyzeOverdraw(const std::vector<unsigned int>& index_vec, const std::vector<float>& pos_vec)
+{
+    size_t tri_cnt = index_vec.size() / 3;
+    size_t vertex_cnt = pos_vec.size() / 3;
+    if((tri_cnt == 0) || (vertex_cnt == 0)) return 0.0;
+
+    //  包围盒，3个方向使用相同的比例，最长的边占满视口
+    float box_min[3] = { pos_vec[0], pos_vec[1], pos_vec[2] };
+    float box_max[3] = { pos_vec[0], pos_vec[1], pos_vec[2] };
+    size_t i = 0;
+    int k = 0;
+    for(i=1;i<vertex_cnt;i++)
+    {
+        for(k=0;k<3;k++)
+        {
+            box_min[k] = std::min(box_min[k], pos_vec[i * 3 + k]);
+            box_max[k] = std::max(box_max[k], pos_vec[i * 3 + k]);
+        }
+    }
+    float extent = 0.0f;
+    for(k=0;k<3;k++) extent = std::max(extent, box_max[k] - box_min[k]);
+    float scale = (extent > 0.0f) ? ((float)OVERDRAW_VIEW_SIZE / extent) : 0.0f;
+
+    std::vector<float> depth_vec((size_t)OVERDRAW_VIEW_SIZE * OVERDRAW_VIEW_SIZE);
+    unsigned long long shaded = 0;
+    unsigned long long covered = 0;
+
+    //  沿axis轴从正方向和负方向观察，屏幕坐标取另外2个轴，负方向时交换x y保持右手坐标系
+    int axis = 0;
+    int side = 0;
+    for(axis=0;axis<3;axis++)
+    {
+        int b = (axis + 1) % 3;
+        int c = (axis + 2) % 3;
+        for(side=0;side<2;side++)
+        {
+            std::fill(depth_vec.begin(), depth_vec.end(), FLT_MAX);
+            for(i=0;i<tri_cnt;i++)
+            {
+                float v[3][3];
+                for(k=0;k<3;k++)
+                {
+                    const float* p = &pos_vec[index_vec[i * 3 + k] * 3];
+                    float sx = (p[b] - box_min[b]) * scale;
+                    float sy = (p[c] - box_min[c]) * scale;
+                    float sz = (p[axis] - box_min[axis]) * scale;
+                    v[k][0] = (side == 0) ? sx : sy;
+                    v[k][1] = (side == 0) ? sy : sx;
+                    v[k][2] = (side == 0) ? -sz : sz;
+                }
+                RasterizeOverdraw(v, &depth_vec, &shaded);
+            }
+            for(i=0;i<depth_vec.size();i++)
+            {
+                if(depth_vec[i] < FLT_MAX) covered++;
+            }
+        }
+    }
+
+    return (covered > 0) ? ((double)shaded / (double)covered) : 0.0;
+}
+
+//  模拟取顶点数据的过程
+void AnalyzeVertexFetch(const std::vector<unsigned int>& index_vec, size_t vertex_cnt, unsigned int vertex_size, double* pbytes, double* poverfetch)
+{
+    //  顶点缓存，与AnalyzeVertexCache相同的FIFO模型
+    std::vector<unsigned long long> stamp_vec(vertex_cnt, 0);
+    unsigned long long now = (unsigned long long)VCACHE_STAT_SIZE + 1;
+
+    //  内存缓存，按缓存行记录最后一次访问的时间，使用LRU淘汰
+    size_t line_total = (((size_t)vertex_cnt * vertex_size) + VFETCH_LINE_SIZE - 1) / VFETCH_LINE_SIZE;
+    std::vector<unsigned long long> line_stamp_vec(line_total, 0);
+    unsigned long long line_now = VFETCH_LINE_CNT + 1;
+    std::vector<size_t> lru_vec;            //  缓存中的缓存行
+    lru_vec.reserve(VFETCH_LINE_CNT);
+
+    unsigned long long shaded = 0;
+    unsigned long long fetched = 0;
+
+    size_t i = 0;
+    for(i=0;i<index_vec.size();i++)
+    {
+        unsigned int v = index_vec[i];
+
+        //  顶点缓存命中，不需要取数据
+        if((now - stamp_vec[v]) <= (unsigned long long)VCACHE_STAT_SIZE) continue;
+        stamp_vec[v] = now;
+        now++;
+        shaded++;
+
+        //  读取顶点覆盖的所有缓存行
+        size_t line_begin = ((size_t)v * vertex_size) / VFETCH_LINE_SIZE;
+        size_t line_end = (((size_t)v * vertex_size) + vertex_size - 1) / VFETCH_LINE_SIZE;
+        size_t line = 0;
+        for(line=line_begin;line<=line_end;line++)
+        {
+            //  缓存中已有
+            if(line_stamp_vec[line] != 0)
+            {
+                line_stamp_vec[line] = line_now++;
+                continue;
+            }
+
+            //  缓存已满时淘汰最久未使用的缓存行
+            fetched += VFETCH_LINE_SIZE;
+            if(lru_vec.size() >= VFETCH_LINE_CNT)
+            {
+                size_t oldest = 0;
+                size_t k = 0;
+                for(k=1;k<lru_vec.size();k++)
+                {
+                    if(line_stamp_vec[lru_vec[k]] < line_stamp_vec[lru_vec[oldest]]) oldest = k;
+                }
+                line_stamp_vec[lru_vec[oldest]] = 0;
+                lru_vec[oldest] = line;
+            }
+            else
+            {
+                lru_vec.push_back(line);
+            }
+            line_stamp_vec[line] = line_now++;
+        }
+    }
+
+    *pbytes = (shaded > 0) ? ((double)fetched / (double)shaded) : 0.0;
+    *poverfetch = (vertex_cnt > 0) ? ((double)fetched / ((double)vertex_cnt * vertex_size)) : 0.0;
+}
+
+//  按照顶点在索引中首次出现的顺序重新排列顶点，同时改写索引
+void OptimizeVertexFetch(SIndexedMesh* pmesh)
+{
+    //  检测指针
+    if(pmesh == 0) return;
+
+    //  旧顶点序号到新顶点序号的映射，0xFFFFFFFF表示尚未分配
+    std::vector<unsigned int> remap_vec(pmesh->vertex_vec.size(), 0xFFFFFFFFU);
+    std::vector<SVertexKey> new_vertex_vec;
+    new_vertex_vec.reserve(pmesh->vertex_vec.size());
+
+    size_t i = 0;
+    for(i=0;i<pmesh->index_vec.size();i++)
+    {
+        unsigned int v = pmesh->index_vec[i];
+        if(remap_vec[v] == 0xFFFFFFFFU)
+        {
+            remap_vec[v] = (unsigned int)new_vertex_vec.size();
+            new_vertex_vec.push_back(pmesh->vertex_vec[v]);
+        }
+        pmesh->index_vec[i] = remap_vec[v];
+    }
+
+    pmesh->vertex_vec.swap(new_vertex_vec);
+}
+
+//  三角形带中查找相邻三角形用的有向边，按key排序后二分查找
+typedef struct
+{
+    uint64_t key;           //  起点 << 32 | 终点
+    unsigned int tri;       //  三角形序号
+}SStripEdge;
+
+static inline bool StripEdgeLess(const SStripEdge& a, const SStripEdge& b)
+{
+    return a.key < b.key;
+}
+
+static inline uint64_t GetStripEdgeKey(unsigned int a, unsigned int b)
+{
+    return ((uint64_t)a << 32) | b;
+}
+
+//  在三角形tri中沿有向边a->b后的第三个顶点
+static inline unsigned int GetStripThird(const std::vector<unsigned int>& index_vec, unsigned int tri, unsigned int a)
+{
+    const unsigned int* p = &index_vec[tri * 3];
+    if(p[0] == a) return p[2];
+    if(p[1] == a) return p[0];
+    return p[1];
+}
+
+//  把三角形列表转换为三角形带
+//  从剩余相邻三角形最少的三角形开始，分别尝试3种起始边，沿着公共边向前延伸，取最长的一条
+//  三角形带中第k个三角形为(s[k],s[k+1],s[k+2])，k为奇数时交换前两个顶点，保证与原来的环绕方向一致
+//  有重复顶点的退化三角形不绘制任何内容，直接丢弃
+void StripifyMesh(const std::vector<unsigned int>& index_vec, int join, unsigned int restart_index, std::vector<unsigned int>* pstrip_vec, size_t* pstrip_cnt)
+{
+    size_t tri_cnt = index_vec.size() / 3;
+    size_t i = 0;
+    int k = 0;
+
+    pstrip_vec->clear();
+    *pstrip_cnt = 0;
+
+    //  全部有向边
+    std::vector<SStripEdge> edge_vec;
+    edge_vec.reserve(tri_cnt * 3);
+    std::vector<unsigned char> used_vec(tri_cnt, 0);
+    for(i=0;i<tri_cnt;i++)
+    {
+        const unsigned int* p = &index_vec[i * 3];
+        if((p[0] == p[1]) || (p[1] == p[2]) || (p[0] == p[2]))
+        {
+            used_vec[i] = 1;
+            continue;
+        }
+        for(k=0;k<3;k++)
+        {
+            SStripEdge tmp_edge;
+            tmp_edge.key = GetStripEdgeKey(p[k], p[(k + 1) % 3]);
+            tmp_edge.tri = (unsigned int)i;
+            edge_vec.push_back(tmp_edge);
+        }
+    }
+    std::sort(edge_vec.begin(), edge_vec.end(), StripEdgeLess);
+
+    //  每个三角形尚未使用的相邻三角形个数(通过反向的有向边相邻)
+    std::vector<unsigned char> adj_vec(tri_cnt, 0);
+    for(i=0;i<edge_vec.size();i++)
+    {
+        uint64_t rev_key = (edge_vec[i].key << 32) | (edge_vec[i].key >> 32);
+        SStripEdge tmp_edge = {rev_key, 0};
+        std::vector<SStripEdge>::const_iterator it = std::lower_bound(edge_vec.begin(), edge_vec.end(), tmp_edge, StripEdgeLess);
+        if((it != edge_vec.end()) && (it->key == rev_key) && (adj_vec[edge_vec[i].tri] < 3)) adj_vec[edge_vec[i].tri]++;
+    }
+
+    //  按照相邻个数分桶，选择起点时从个数最少的桶中取，桶中可能有已经使用或者相邻个数已经减少的过期项
+    std::vector<unsigned int> bucket_vec[4];
+    for(i=0;i<tri_cnt;i++)
+    {
+        if(!used_vec[i]) bucket_vec[adj_vec[i]].push_back((unsigned int)i);
+    }
+    for(k=0;k<4;k++) std::reverse(bucket_vec[k].begin(), bucket_vec[k].end());
+
+    //  尝试延伸时的临时标记
+    std::vector<unsigned int> stamp_vec(tri_cnt, 0);
+    unsigned int stamp = 0;
+    std::vector<unsigned int> try_vec;
+    std::vector<unsigned int> try_tri_vec;
+    std::vector<unsigned int> best_vec;
+    std::vector<unsigned int> best_tri_vec;
+
+    for(;;)
+    {
+        //  选择起始三角形
+        unsigned int start = 0xFFFFFFFFU;
+        for(k=0;(k<4) && (start == 0xFFFFFFFFU);k++)
+        {
+            while(!bucket_vec[k].empty())
+            {
+                unsigned int tri = bucket_vec[k].back();
+                bucket_vec[k].pop_back();
+                if(used_vec[tri]) continue;
+
+                //  过期的项相邻个数只会更少，同样可以作为起点
+                start = tri;
+                break;
+            }
+        }
+        if(start == 0xFFFFFFFFU) break;
+
+        //  分别以3条边作为起始边，沿公共边延伸
+        best_vec.clear();
+        best_tri_vec.clear();
+        int r = 0;
+        for(r=0;r<3;r++)
+        {
+            const unsigned int* p = &index_vec[start * 3];
+            stamp++;
+            stamp_vec[start] = stamp;
+            try_vec.clear();
+            try_tri_vec.clear();
+            try_vec.push_back(p[r]);
+            try_vec.push_back(p[(r + 1) % 3]);
+            try_vec.push_back(p[(r + 2) % 3]);
+            try_tri_vec.push_back(start);
+
+            for(;;)
+            {
+                //  下一个三角形在带中的序号为偶数时需要有向边x->y，奇数时需要y->x
+                size_t n = try_vec.size();
+                unsigned int x = try_vec[n - 2];
+                unsigned int y = try_vec[n - 1];
+                unsigned int a = ((n - 2) % 2 == 0) ? x : y;
+                unsigned int b = ((n - 2) % 2 == 0) ? y : x;
+                SStripEdge tmp_edge = {GetStripEdgeKey(a, b), 0};
+                std::vector<SStripEdge>::const_iterator it = std::lower_bound(edge_vec.begin(), edge_vec.end(), tmp_edge, StripEdgeLess);
+                unsigned int next = 0xFFFFFFFFU;
+                for(;(it != edge_vec.end()) && (it->key == tmp_edge.key);++it)
+                {
+                    if(!used_vec[it->tri] && (stamp_vec[it->tri] != stamp))
+                    {
+                        next = it->tri;
+                        break;
+                    }
+                }
+                if(next == 0xFFFFFFFFU) break;
+
+                stamp_vec[next] = stamp;
+                try_vec.push_back(GetStripThird(index_vec, next, a));
+                try_tri_vec.push_back(next);
+            }
+
+            if(try_tri_vec.size() > best_tri_vec.size())
+            {
+                best_vec.swap(try_vec);
+                best_tri_vec.swap(try_tri_vec);
+            }
+        }
+
+        //  标记使用过的三角形，并更新相邻三角形的相邻个数
+        for(i=0;i<best_tri_vec.size();i++)
+        {
+            unsigned int tri = best_tri_vec[i];
+            used_vec[tri] = 1;
+            const unsigned int* p = &index_vec[tri * 3];
+            for(k=0;k<3;k++)
+            {
+                SStripEdge tmp_edge = {GetStripEdgeKey(p[(k + 1) % 3], p[k]), 0};
+                std::vector<SStripEdge>::const_iterator it = std::lower_bound(edge_vec.begin(), edge_vec.end(), tmp_edge, StripEdgeLess);
+                for(;(it != edge_vec.end()) && (it->key == tmp_edge.key);++it)
+                {
+                    if(!used_vec[it->tri] && (adj_vec[it->tri] > 0)) adj_vec[it->tri]--;
+                }
+            }
+        }
+
+        //  连接到已有的三角形带
+        if(!pstrip_vec->empty())
+        {
+            if(join == STRIP_JOIN_RESTART)
+            {
+                pstrip_vec->push_back(restart_index);
+            }
+            //  重复前一条的最后一个顶点和这一条的第一个顶点，
+            //  前一条结束在奇数位置时再多重复一次，保证这一条从偶数位置开始
+            else
+            {
+                unsigned int last = pstrip_vec->back();
+                pstrip_vec->push_back(last);
+                if((pstrip_vec->size() % 2) == 0) pstrip_vec->push_back(best_vec[0]);
+                pstrip_vec->push_back(best_vec[0]);
+            }
+        }
+        pstrip_vec->insert(pstrip_vec->end(), best_vec.begin(), best_vec.end());
+        (*pstrip_cnt)++;
+    }
+}
+
+//  两点距离的平方，用double计算
+static inline double GetDistance2(const float* pa, const float* pb)
+{
+    double dx = (double)pa[0] - pb[0];
+    double dy = (double)pa[1] - pb[1];
+    double dz = (double)pa[2] - pb[2];
+    return (dx * dx) + (dy * dy) + (dz * dz);
+}
+
+//  计算一组点的包围球，Ritter算法，结果比最小包围球最多大5%左右
+//  先用相距较远的两个点确定初始球，再把球外的点逐个包进来，坐标很大时平方会超出float，用double计算
+static void GetBoundingSphere(const std::vector<float>& pos_vec, const unsigned int* pvertex, size_t cnt, float* pcenter, float* pradius)
+{
+    size_t i = 0;
+    int k = 0;
+    const float* p0 = &pos_vec[pvertex[0] * 3];
+
+    //  离第一个点最远的点a，离a最远的点b
+    const float* pa = p0;
+    const float* pb = p0;
+    double max_d = -1.0;
+    for(i=0;i<cnt;i++)
+    {
+        const float* p = &pos_vec[pvertex[i] * 3];
+        double d = GetDistance2(p, p0);
+        if(d > max_d)
+        {
+            max_d = d;
+            pa = p;
+        }
+    }
+    max_d = -1.0;
+    for(i=0;i<cnt;i++)
+    {
+        const float* p = &pos_vec[pvertex[i] * 3];
+        double d = GetDistance2(p, pa);
+        if(d > max_d)
+        {
+            max_d = d;
+            pb = p;
+        }
+    }
+
+    double center[3];
+    for(k=0;k<3;k++) center[k] = ((double)pa[k] + pb[k]) * 0.5;
+    double radius = sqrt(max_d) * 0.5;
+
+    //  球外的点，把球扩大到刚好包含该点
+    for(i=0;i<cnt;i++)
+    {
+        const float* p = &pos_vec[pvertex[i] * 3];
+        double d = sqrt(((p[0] - center[0]) * (p[0] - center[0])) + ((p[1] - center[1]) * (p[1] - center[1])) + ((p[2] - center[2]) * (p[2] - center[2])));
+        if(d > radius)
+        {
+            double new_radius = (radius + d) * 0.5;
+            double t = (new_radius - radius) / d;
+            for(k=0;k<3;k++) center[k] += (p[k] - center[k]) * t;
+            radius = new_radius;
+        }
+    }
+
+    //  转换为float时向上取整，保证仍然包含全部点
+    for(k=0;k<3;k++) pcenter[k] = (float)center[k];
+    for(i=0;i<cnt;i++)
+    {
+        const float* p = &pos_vec[pvertex[i] * 3];
+        double d = sqrt(GetDistance2(p, pcenter));
+        if(d > radius) radius = d;
+    }
+    *pradius = nextafterf((float)radius, INFINITY);
+}
+
+//  计算一块三角形的法线锥
+//  轴为各三角形单位法线的平均方向，半角由与轴夹角最大的法线决定
+//  退化三角形没有法线，不参与计算
+static void GetNormalCone(const std::vector<unsigned int>& index_vec, const std::vector<float>& pos_vec, size_t tri_begin, size_t tri_end, SMeshlet* pmeshlet)
+{
+    std::vector<double> normal_vec;
+    double axis[3] = {0.0, 0.0, 0.0};
+    size_t t = 0;
+    int k = 0;
+    for(t=tri_begin;t<tri_end;t++)
+    {
+        const float* pa = &pos_vec[index_vec[(t * 3) + 0] * 3];
+        const float* pb = &pos_vec[index_vec[(t * 3) + 1] * 3];
+        const float* pc = &pos_vec[index_vec[(t * 3) + 2] * 3];
+        double e1[3] = {(double)pb[0] - pa[0], (double)pb[1] - pa[1], (double)pb[2] - pa[2]};
+        double e2[3] = {(double)pc[0] - pa[0], (double)pc[1] - pa[1], (double)pc[2] - pa[2]};
+        double n[3] = {(e1[1] * e2[2]) - (e1[2] * e2[1]), (e1[2] * e2[0]) - (e1[0] * e2[2]), (e1[0] * e2[1]) - (e1[1] * e2[0])};
+        double len = sqrt((n[0] * n[0]) + (n[1] * n[1]) + (n[2] * n[2]));
+        if(!(len > 0.0) || !std::isfinite(len)) continue;
+        for(k=0;k<3;k++)
+        {
+            n[k] /= len;
+            axis[k] += n[k];
+            normal_vec.push_back(n[k]);
+        }
+    }
+
+    //  没有有效的法线，或者法线互相抵消时不能剔除
+    pmeshlet->cone_axis[0] = 0.0f;
+    pmeshlet->cone_axis[1] = 0.0f;
+    pmeshlet->cone_axis[2] = 0.0f;
+    pmeshlet->cone_cutoff = 1.0f;
+    double len = sqrt((axis[0] * axis[0]) + (axis[1] * axis[1]) + (axis[2] * axis[2]));
+    if(len <= 1e-6) return;
+    for(k=0;k<3;k++) axis[k] /= len;
+
+    //  与轴夹角最大的法线，夹角超过90度时法线分布超过半球
+    double min_dot = 1.0;
+    for(t=0;t<normal_vec.size();t+=3)
+    {
+        double d = (normal_vec[t] * axis[0]) + (normal_vec[t + 1] * axis[1]) + (normal_vec[t + 2] * axis[2]);
+        if(d < min_dot) min_dot = d;
+    }
+    for(k=0;k<3;k++) pmeshlet->cone_axis[k] = (float)axis[k];
+    if(min_dot <= 0.0) return;
+
+    //  向上取整，剔除只会更保守
+    pmeshlet->cone_cutoff = nextafterf((float)sqrt(1.0 - (min_dot * min_dot)), INFINITY);
+    if(pmeshlet->cone_cutoff > 1.0f) pmeshlet->cone_cutoff = 1.0f;
+}
+
+//  把三角形列表按顺序拆分为meshlet
+//  slot_vec记录每个全局顶点在当前块内的序号，块结束时只清除用到的顶点
+void BuildMeshlets(const std::vector<unsigned int>& index_vec, const std::vector<float>& pos_vec, size_t max_vertex, size_t max_tri, std::vector<SMeshlet>* pmeshlet_vec, std::vector<unsigned int>* pvertex_vec, std::vector<unsigned char>* ptri_vec)
+{
+    pmeshlet_vec->clear();
+    pvertex_vec->clear();
+    ptri_vec->clear();
+    if(max_vertex > MESHLET_MAX_VERTEX) max_vertex = MESHLET_MAX_VERTEX;
+    if(max_vertex < 3) max_vertex = 3;
+    if(max_tri > MESHLET_MAX_TRI) max_tri = MESHLET_MAX_TRI;
+    if(max_tri < 1) max_tri = 1;
+
+    std::vector<int> slot_vec(pos_vec.size() / 3, -1);
+    size_t tri_cnt = index_vec.size() / 3;
+    SMeshlet tmp_m;
+    tmp_m.vertex_offset = 0;
+    tmp_m.vertex_cnt = 0;
+    tmp_m.tri_offset = 0;
+    tmp_m.tri_cnt = 0;
+    size_t t = 0;
+    int k = 0;
+    for(t=0;t<=tri_cnt;t++)
+    {
+        //  当前三角形需要新加入的顶点个数，同一个三角形中重复的顶点只计一次
+        const unsigned int* p = (t < tri_cnt) ? &index_vec[t * 3] : 0;
+        size_t new_cnt = 0;
+        if(p != 0)
+        {
+            for(k=0;k<3;k++)
+            {
+                if((slot_vec[p[k]] < 0) && ((k < 1) || (p[k] != p[0])) && ((k < 2) || (p[k] != p[1]))) new_cnt++;
+            }
+        }
+
+        //  放不下或者已经结束时完成当前块
+        if((tmp_m.tri_cnt > 0) && ((p == 0) || ((tmp_m.vertex_cnt + new_cnt) > max_vertex) || ((tmp_m.tri_cnt + 1) > max_tri)))
+        {
+            size_t i = 0;
+            for(i=tmp_m.vertex_offset;i<pvertex_vec->size();i++) slot_vec[(*pvertex_vec)[i]] = -1;
+            GetBoundingSphere(pos_vec, pvertex_vec->data() + tmp_m.vertex_offset, tmp_m.vertex_cnt, tmp_m.center, &tmp_m.radius);
+            GetNormalCone(index_vec, pos_vec, t - tmp_m.tri_cnt, t, &tmp_m);
+            pmeshlet_vec->push_back(tmp_m);
+            tmp_m.vertex_offset = pvertex_vec->size();
+            tmp_m.vertex_cnt = 0;
+            tmp_m.tri_offset = ptri_vec->size() / 3;
+            tmp_m.tri_cnt = 0;
+        }
+        if(p == 0) break;
+
+        //  加入当前块
+        for(k=0;k<3;k++)
+        {
+            if(slot_vec[p[k]] < 0)
+            {
+                slot_vec[p[k]] = (int)tmp_m.vertex_cnt;
+                pvertex_vec->push_back(p[k]);
+                tmp_m.vertex_cnt++;
+            }
+            ptri_vec->push_back((unsigned char)slot_vec[p[k]]);
+        }
+        tmp_m.tri_cnt++;
+    }
+}
+
+//  定义BVH中的轴对齐包围盒
+typedef struct
+{
+    float bmin[3];
+    float bmax[3];
+}SBvhBox;
+
+//  清空包围盒，最小坐标为+inf，最大坐标为-inf
+static inline void BvhBoxReset(SBvhBox* pbox)
+{
+    int k = 0;
+    for(k=0;k<3;k++)
+    {
+        pbox->bmin[k] = INFINITY;
+        pbox->bmax[k] = -INFINITY;
+    }
+}
+
+//  扩大包围盒，包含一个点
+static inline void BvhBoxAddPoint(SBvhBox* pbox, const float* p)
+{
+    int k = 0;
+    for(k=0;k<3;k++)
+    {
+        if(p[k] < pbox->bmin[k]) pbox->bmin[k] = p[k];
+        if(p[k] > pbox->bmax[k]) pbox->bmax[k] = p[k];
+    }
+}
+
+//  扩大包围盒，包含另一个包围盒
+static inline void BvhBoxAddBox(SBvhBox* pbox, const SBvhBox& other)
+{
+    BvhBoxAddPoint(pbox, other.bmin);
+    BvhBoxAddPoint(pbox, other.bmax);
+}
+
+//  包围盒的表面积，空的包围盒为0，坐标很大时平方会超出float，用double计算
+static inline double BvhBoxArea(const float* pmin, const float* pmax)
+{
+    double dx = (double)pmax[0] - pmin[0];
+    double dy = (double)pmax[1] - pmin[1];
+    double dz = (double)pmax[2] - pmin[2];
+    if((dx < 0.0) || (dy < 0.0) || (dz < 0.0)) return 0.0;
+    return 2.0 * ((dx * dy) + (dy * dz) + (dz * dx));
+}
+
+//  三角形包围盒的中心在轴上分到的桶
+static inline int GetBvhBin(float center, float center_min, double scale)
+{
+    int bin = (int)(((double)center - center_min) * scale);
+    if(bin < 0) return 0;
+    if(bin >= BVH_SAH_BIN) return BVH_SAH_BIN - 1;
+    return bin;
+}
+
+//  没有父节点的建立任务，即根节点和左子节点
+#define BVH_NO_PARENT           ((size_t)-1)
+
+//  定义一个等待建立的节点，包含三角形引用表中[begin, end)的三角形
+//  右子节点建立时把自己的序号写入父节点
+typedef struct
+{
+    size_t begin;
+    size_t end;
+    size_t parent;
+}SBvhTask;
+
+//  按SAH建立三角形列表的BVH
+//  用栈代替递归，先建立左子节点，保证左子节点紧跟在父节点后面，退化的网格也不会因为递归太深而栈溢出
+void BuildBvh(const std::vector<unsigned int>& index_vec, const std::vector<float>& pos_vec, size_t max_leaf, std::vector<SBvhNode>* pnode_vec, std::vector<unsigned int>* ptri_vec)
+{
+    pnode_vec->clear();
+    ptri_vec->clear();
+    if(max_leaf > BVH_MAX_LEAF_TRI) max_leaf = BVH_MAX_LEAF_TRI;
+    if(max_leaf < 1) max_leaf = 1;
+
+    size_t tri_cnt = index_vec.size() / 3;
+    if(tri_cnt == 0) return;
+
+    //  每个三角形的包围盒和中心
+    std::vector<SBvhBox> box_vec(tri_cnt);
+    std::vector<float> center_vec(tri_cnt * 3);
+    size_t t = 0;
+    int k = 0;
+    for(t=0;t<tri_cnt;t++)
+    {
+        BvhBoxReset(&box_vec[t]);
+        for(k=0;k<3;k++) BvhBoxAddPoint(&box_vec[t], &pos_vec[(size_t)index_vec[(t * 3) + k] * 3]);
+        for(k=0;k<3;k++) center_vec[(t * 3) + k] = (box_vec[t].bmin[k] * 0.5f) + (box_vec[t].bmax[k] * 0.5f);
+        ptri_vec->push_back((unsigned int)t);
+    }
+    unsigned int* pref = ptri_vec->data();
+
+    std::vector<SBvhTask> task_vec;
+    SBvhTask tmp_task = {0, tri_cnt, BVH_NO_PARENT};
+    task_vec.push_back(tmp_task);
+    while(!task_vec.empty())
+    {
+        tmp_task = task_vec.back();
+        task_vec.pop_back();
+        size_t node_index = pnode_vec->size();
+        if(tmp_task.parent != BVH_NO_PARENT) (*pnode_vec)[tmp_task.parent].index = (unsigned int)node_index;
+
+        //  节点的包围盒和三角形中心的范围
+        SBvhBox node_box;
+        SBvhBox center_box;
+        BvhBoxReset(&node_box);
+        BvhBoxReset(&center_box);
+        size_t i = 0;
+        for(i=tmp_task.begin;i<tmp_task.end;i++)
+        {
+            BvhBoxAddBox(&node_box, box_vec[pref[i]]);
+            BvhBoxAddPoint(&center_box, &center_vec[(size_t)pref[i] * 3]);
+        }
+        size_t cnt = tmp_task.end - tmp_task.begin;
+        double node_area = BvhBoxArea(node_box.bmin, node_box.bmax);
+
+        //  在每个轴上按桶划分，代价为1次遍历加上两侧的表面积与三角形个数的乘积，相对于本节点的表面积
+        //  所有三角形都在同一个点或者同一条线上时没有表面积，不计算代价
+        int best_axis = -1;
+        int best_bin = 0;
+        double best_cost = 0.0;
+        int axis = 0;
+        for(axis=0;(axis<3)&&(cnt>1)&&(node_area>0.0);axis++)
+        {
+            float center_min = center_box.bmin[axis];
+            double extent = (double)center_box.bmax[axis] - center_min;
+            if(!(extent > 0.0)) continue;
+            double scale = BVH_SAH_BIN / extent;
+
+            SBvhBox bin_box[BVH_SAH_BIN];
+            size_t bin_cnt[BVH_SAH_BIN];
+            int b = 0;
+            for(b=0;b<BVH_SAH_BIN;b++)
+            {
+                BvhBoxReset(&bin_box[b]);
+                bin_cnt[b] = 0;
+            }
+            for(i=tmp_task.begin;i<tmp_task.end;i++)
+            {
+                b = GetBvhBin(center_vec[((size_t)pref[i] * 3) + axis], center_min, scale);
+                BvhBoxAddBox(&bin_box[b], box_vec[pref[i]]);
+                bin_cnt[b]++;
+            }
+
+            //  从右向左累计右侧的表面积和三角形个数
+            double right_area[BVH_SAH_BIN];
+            size_t right_cnt[BVH_SAH_BIN];
+            SBvhBox acc_box;
+            size_t acc_cnt = 0;
+            BvhBoxReset(&acc_box);
+            for(b=BVH_SAH_BIN-1;b>0;b--)
+            {
+                BvhBoxAddBox(&acc_box, bin_box[b]);
+                acc_cnt += bin_cnt[b];
+                right_area[b] = BvhBoxArea(acc_box.bmin, acc_box.bmax);
+                right_cnt[b] = acc_cnt;
+            }
+
+            //  从左向右累计，在桶b和b+1之间划分
+            BvhBoxReset(&acc_box);
+            acc_cnt = 0;
+            for(b=0;b<(BVH_SAH_BIN-1);b++)
+            {
+                BvhBoxAddBox(&acc_box, bin_box[b]);
+                acc_cnt += bin_cnt[b];
+                if((acc_cnt == 0) || (right_cnt[b + 1] == 0)) continue;
+                double cost = 1.0 + (((BvhBoxArea(acc_box.bmin, acc_box.bmax) * acc_cnt) + (right_area[b + 1] * right_cnt[b + 1])) / node_area);
+                if((best_axis < 0) || (cost < best_cost))
+                {
+                    best_axis = axis;
+                    best_bin = b;
+                    best_cost = cost;
+                }
+            }
+        }
+
+        SBvhNode tmp_n;
+        for(k=0;k<3;k++)
+        {
+            tmp_n.bound_min[k] = node_box.bmin[k];
+            tmp_n.bound_max[k] = node_box.bmax[k];
+        }
+
+        //  叶节点，求交的代价为三角形个数
+        if((cnt <= max_leaf) && ((best_axis < 0) || (best_cost >= (double)cnt)))
+        {
+            tmp_n.index = (unsigned int)tmp_task.begin;
+            tmp_n.tri_cnt = (unsigned int)cnt;
+            pnode_vec->push_back(tmp_n);
+            continue;
+        }
+
+        //  按最好的划分把三角形引用分为左右两部分，无法按中心划分时从中间分开
+        size_t mid = tmp_task.begin + (cnt / 2);
+        if(best_axis >= 0)
+        {
+            float center_min = center_box.bmin[best_axis];
+            double scale = BVH_SAH_BIN / ((double)center_box.bmax[best_axis] - center_min);
+            size_t left = tmp_task.begin;
+            size_t right = tmp_task.end;
+            while(left < right)
+            {
+                if(GetBvhBin(center_vec[((size_t)pref[left] * 3) + best_axis], center_min, scale) <= best_bin)
+                {
+                    left++;
+                }
+                else
+                {
+                    right--;
+                    std::swap(pref[left], pref[right]);
+                }
+            }
+            mid = left;
+        }
+
+        tmp_n.index = 0;
+        tmp_n.tri_cnt = 0;
+        pnode_vec->push_back(tmp_n);
+
+        SBvhTask child_task = {mid, tmp_task.end, node_index};
+        task_vec.push_back(child_task);
+        child_task.begin = tmp_task.begin;
+        child_task.end = mid;
+        child_task.parent = BVH_NO_PARENT;
+        task_vec.push_back(child_task);
+    }
+}
+
+//  统计BVH的叶节点个数、最大深度和SAH代价
+void AnalyzeBvh(const std::vector<SBvhNode>& node_vec, size_t* pleaf_cnt, size_t* pmax_depth, double* psah_cost)
+{
+    *pleaf_cnt = 0;
+    *pmax_depth = 0;
+    *psah_cost = 0.0;
+    if(node_vec.empty()) return;
+
+    //  按深度优先顺序，每个节点的深度由父节点得到，右子节点的深度先记录下来
+    std::vector<size_t> depth_vec(node_vec.size(), 1);
+    double cost = 0.0;
+    size_t i = 0;
+    for(i=0;i<node_vec.size();i++)
+    {
+        const SBvhNode& tmp_n = node_vec[i];
+        double area = BvhBoxArea(tmp_n.bound_min, tmp_n.bound_max);
+        if(depth_vec[i] > *pmax_depth) *pmax_depth = depth_vec[i];
+        if(tmp_n.tri_cnt > 0)
+        {
+            (*pleaf_cnt)++;
+            cost += area * tmp_n.tri_cnt;
+        }
+        else
+        {
+            cost += area;
+            depth_vec[i + 1] = depth_vec[i] + 1;
+            depth_vec[tmp_n.index] = depth_vec[i] + 1;
+        }
+    }
+    double root_area = BvhBoxArea(node_vec[0].bound_min, node_vec[0].bound_max);
+    *psah_cost = (root_area > 0.0) ? (cost / root_area) : 0.0;
+}
+
+//  定义一个顶点的二次误差矩阵，对称的4x4矩阵按行保存上三角的10个元素，weight为累计的面积
+typedef struct
+{
+    double a[10];
+    double weight;
+}SQuadric;
+
+//  把平面ax+by+cz+d=0按weight加权加入，(a,b,c)为单位法线
+static inline void QuadricAddPlane(SQuadric* pq, double a, double b, double c, double d, double weight)
+{
+    pq->a[0] += weight * a * a;
+    pq->a[1] += weight * a * b;
+    pq->a[2] += weight * a * c;
+    pq->a[3] += weight * a * d;
+    pq->a[4] += weight * b * b;
+    pq->a[5] += weight * b * c;
+    pq->a[6] += weight * b * d;
+    pq->a[7] += weight * c * c;
+    pq->a[8] += weight * c * d;
+    pq->a[9] += weight * d * d;
+    pq->weight += weight;
+}
+
+//  两个矩阵之和在点p的误差，即p到各平面的距离平方的加权和
+static inline double QuadricEval(const SQuadric& q0, const SQuadric& q1, const double* p)
+{
+    double a[10];
+    int i = 0;
+    for(i=0;i<10;i++) a[i] = q0.a[i] + q1.a[i];
+    double x = p[0];
+    double y = p[1];
+    double z = p[2];
+    double r = (a[0] * x * x) + (a[4] * y * y) + (a[7] * z * z) +
+               (2.0 * ((a[1] * x * y) + (a[2] * x * z) + (a[5] * y * z))) +
+               (2.0 * ((a[3] * x) + (a[6] * y) + (a[8] * z))) + a[9];
+    return (r > 0.0) ? r : 0.0;
+}
+
+//  顶点的状态
+#define LOD_VERTEX_FREE         0       //  可以折叠
+#define LOD_VERTEX_LOCK         1       //  在边界、接缝或者非流形的边上，不折叠
+#define LOD_VERTEX_GONE         2       //  已经折叠到其他顶点
+
+//  角链表的结束
+#define LOD_NO_CORNER           0xFFFFFFFFU
+
+//  定义一个折叠，把顶点vertex折叠到target
+typedef struct
+{
+    double error;
+    unsigned int vertex;
+    unsigned int target;
+}SLodCollapse;
+
+//  按误差从小到大排列，误差相同时按顶点序号，保证结果与平台无关
+static inline bool LodCollapseLess(const SLodCollapse& a, const SLodCollapse& b)
+{
+    if(a.error != b.error) return a.error < b.error;
+    return a.vertex < b.vertex;
+}
+
+//  定义简化过程中的网格
+//  每个顶点用到的角(三角形序号*3+点序号)串成单向链表，折叠时整个链表接到目标顶点上，已删除三角形的角留在链表中跳过
+typedef struct
+{
+    std::vector<unsigned int> index_vec;        //  当前的索引，折叠后改写
+    std::vector<unsigned char> tri_alive;       //  三角形是否还存在
+    std::vector<unsigned int> corner_next;      //  同一顶点的下一个角
+    std::vector<unsigned int> first_corner;     //  每个顶点的第一个角
+    std::vector<double> pos_vec;                //  相对包围盒中心的坐标，坐标很大时也能保留误差矩阵的精度
+    std::vector<SQuadric> quadric_vec;          //  每个顶点的误差矩阵
+    std::vector<unsigned char> state_vec;       //  每个顶点的状态LOD_VERTEX_XXX
+    std::vector<unsigned int> mark_vec;         //  检查相邻顶点时的标记
+    unsigned int mark;
+    std::vector<unsigned int> dirty_vec;        //  顶点周围的三角形在第几遍折叠中发生了变化
+    unsigned int pass;                          //  当前是第几遍折叠，从1开始
+    size_t live_tri;                            //  剩余的三角形个数
+}SLodMesh;
+
+//  把顶点u折叠到相邻的顶点v的误差，为按面积加权的均方根距离
+static inline double GetLodCollapseError(const SLodMesh* pm, unsigned int u, unsigned int v)
+{
+    const SQuadric& qu = pm->quadric_vec[u];
+    const SQuadric& qv = pm->quadric_vec[v];
+    double weight = qu.weight + qv.weight;
+    if(weight <= 0.0) return 0.0;
+    return sqrt(QuadricEval(qu, qv, &pm->pos_vec[(size_t)v * 3]) / weight);
+}
+
+//  三角形(p0,p1,p2)的法线，长度为面积的2倍
+static inline void GetLodNormal(const double* p0, const double* p1, const double* p2, double* pn)
+{
+    double e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+    double e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+    pn[0] = (e1[1] * e2[2]) - (e1[2] * e2[1]);
+    pn[1] = (e1[2] * e2[0]) - (e1[0] * e2[2]);
+    pn[2] = (e1[0] * e2[1]) - (e1[1] * e2[0]);
+}
+
+//  判断能否把顶点u折叠到v
+//  u和v的公共相邻顶点只能是共用边(u,v)的三角形的第三个顶点，否则会产生非流形的边
+//  不含v的三角形中u移动到v后，法线方向不能翻转
+static int CanLodCollapse(SLodMesh* pm, unsigned int u, unsigned int v)
+{
+    unsigned int mark_u = ++pm->mark;
+    unsigned int mark_common = ++pm->mark;
+    int shared = 0;
+    int common = 0;
+    unsigned int c = 0;
+    int k = 0;
+    for(c=pm->first_corner[u];c!=LOD_NO_CORNER;c=pm->corner_next[c])
+    {
+        unsigned int t = c / 3;
+        if(!pm->tri_alive[t]) continue;
+        const unsigned int* p = &pm->index_vec[(size_t)t * 3];
+        if((p[0] == v) || (p[1] == v) || (p[2] == v)) shared++;
+        for(k=0;k<3;k++) if(p[k] != u) pm->mark_vec[p[k]] = mark_u;
+    }
+    for(c=pm->first_corner[v];c!=LOD_NO_CORNER;c=pm->corner_next[c])
+    {
+        unsigned int t = c / 3;
+        if(!pm->tri_alive[t]) continue;
+        const unsigned int* p = &pm->index_vec[(size_t)t * 3];
+        for(k=0;k<3;k++)
+        {
+            if((p[k] != v) && (pm->mark_vec[p[k]] == mark_u))
+            {
+                pm->mark_vec[p[k]] = mark_common;
+                common++;
+            }
+        }
+    }
+    if(common > shared) return 0;
+
+    for(c=pm->first_corner[u];c!=LOD_NO_CORNER;c=pm->corner_next[c])
+    {
+        unsigned int t = c / 3;
+        if(!pm->tri_alive[t]) continue;
+        const unsigned int* p = &pm->index_vec[(size_t)t * 3];
+        if((p[0] == v) || (p[1] == v) || (p[2] == v)) continue;
+
+        const double* pp[3];
+        for(k=0;k<3;k++) pp[k] = &pm->pos_vec[(size_t)p[k] * 3];
+        double n_old[3];
+        GetLodNormal(pp[0], pp[1], pp[2], n_old);
+        pp[c % 3] = &pm->pos_vec[(size_t)v * 3];
+        double n_new[3];
+        GetLodNormal(pp[0], pp[1], pp[2], n_new);
+        double len_old = sqrt((n_old[0] * n_old[0]) + (n_old[1] * n_old[1]) + (n_old[2] * n_old[2]));
+        double len_new = sqrt((n_new[0] * n_new[0]) + (n_new[1] * n_new[1]) + (n_new[2] * n_new[2]));
+        if(len_old <= 0.0) continue;
+        double dot = (n_old[0] * n_new[0]) + (n_old[1] * n_new[1]) + (n_old[2] * n_new[2]);
+        if(dot <= (1e-2 * len_old * len_new)) return 0;
+    }
+    return 1;
+}
+
+//  找到顶点u误差最小的折叠目标，check为1时只考虑可以折叠的目标
+//  返回误差，没有目标时返回-1
+static double FindLodCollapse(SLodMesh* pm, unsigned int u, int check, unsigned int* pv)
+{
+    double best = -1.0;
+    unsigned int c = 0;
+    int k = 0;
+    for(c=pm->first_corner[u];c!=LOD_NO_CORNER;c=pm->corner_next[c])
+    {
+        unsigned int t = c / 3;
+        if(!pm->tri_alive[t]) continue;
+        for(k=1;k<3;k++)
+        {
+            unsigned int v = pm->index_vec[((size_t)t * 3) + ((c % 3) + k) % 3];
+            double err = GetLodCollapseError(pm, u, v);
+            if((best >= 0.0) && (err >= best)) continue;
+            if(check && !CanLodCollapse(pm, u, v)) continue;
+            best = err;
+            *pv = v;
+        }
+    }
+    return best;
+}
+
+//  把顶点u折叠到v，共用边(u,v)的三角形被删除，其他三角形中的u改为v
+//  v和v的相邻顶点周围的三角形发生了变化，标记为本遍不能再参与折叠
+static void LodCollapse(SLodMesh* pm, unsigned int u, unsigned int v)
+{
+    unsigned int c = 0;
+    unsigned int last = LOD_NO_CORNER;
+    for(c=pm->first_corner[u];c!=LOD_NO_CORNER;c=pm->corner_next[c])
+    {
+        last = c;
+        unsigned int t = c / 3;
+        if(!pm->tri_alive[t]) continue;
+        const unsigned int* p = &pm->index_vec[(size_t)t * 3];
+        if((p[0] == v) || (p[1] == v) || (p[2] == v))
+        {
+            pm->tri_alive[t] = 0;
+            pm->live_tri--;
+        }
+        else
+        {
+            pm->index_vec[c] = v;
+        }
+    }
+    if(last != LOD_NO_CORNER)
+    {
+        pm->corner_next[last] = pm->first_corner[v];
+        pm->first_corner[v] = pm->first_corner[u];
+        pm->first_corner[u] = LOD_NO_CORNER;
+    }
+
+    int i = 0;
+    for(i=0;i<10;i++) pm->quadric_vec[v].a[i] += pm->quadric_vec[u].a[i];
+    pm->quadric_vec[v].weight += pm->quadric_vec[u].weight;
+    pm->state_vec[u] = LOD_VERTEX_GONE;
+    pm->dirty_vec[v] = pm->pass;
+
+    //  同时从链表中去掉已删除三角形的角，链表长度不随折叠次数增长
+    unsigned int prev = LOD_NO_CORNER;
+    int k = 0;
+    for(c=pm->first_corner[v];c!=LOD_NO_CORNER;c=pm->corner_next[c])
+    {
+        unsigned int t = c / 3;
+        if(!pm->tri_alive[t])
+        {
+            if(prev == LOD_NO_CORNER) pm->first_corner[v] = pm->corner_next[c];
+            else                      pm->corner_next[prev] = pm->corner_next[c];
+            continue;
+        }
+        prev = c;
+        for(k=0;k<3;k++) pm->dirty_vec[pm->index_vec[((size_t)t * 3) + k]] = pm->pass;
+    }
+}
+
+//  保存当前剩余的三角形，保持原来的顺序
+static void GetLodIndex(const SLodMesh* pm, std::vector<unsigned int>* pindex_vec)
+{
+    pindex_vec->clear();
+    pindex_vec->reserve(pm->live_tri * 3);
+    size_t t = 0;
+    for(t=0;t<pm->tri_alive.size();t++)
+    {
+        if(!pm->tri_alive[t]) continue;
+        pindex_vec->push_back(pm->index_vec[t * 3]);
+        pindex_vec->push_back(pm->index_vec[(t * 3) + 1]);
+        pindex_vec->push_back(pm->index_vec[(t * 3) + 2]);
+    }
+}
+
+//  按QEM简化网格
+void SimplifyMesh(const std::vector<unsigned int>& index_vec, const std::vector<float>& pos_vec, int target_kind, const std::vector<double>& target_vec, std::vector<std::vector<unsigned int> >* plod_vec, std::vector<double>* perror_vec)
+{
+    plod_vec->clear();
+    perror_vec->clear();
+    size_t tri_cnt = index_vec.size() / 3;
+    size_t vertex_cnt = pos_vec.size() / 3;
+    size_t i = 0;
+    size_t t = 0;
+    int k = 0;
+
+    //  坐标移动到包围盒中心
+    SLodMesh mesh;
+    double bound_min[3] = {INFINITY, INFINITY, INFINITY};
+    double bound_max[3] = {-INFINITY, -INFINITY, -INFINITY};
+    for(i=0;i<vertex_cnt;i++)
+    {
+        for(k=0;k<3;k++)
+        {
+            if(pos_vec[(i * 3) + k] < bound_min[k]) bound_min[k] = pos_vec[(i * 3) + k];
+            if(pos_vec[(i * 3) + k] > bound_max[k]) bound_max[k] = pos_vec[(i * 3) + k];
+        }
+    }
+    mesh.pos_vec.resize(vertex_cnt * 3);
+    for(i=0;i<vertex_cnt;i++)
+    {
+        for(k=0;k<3;k++) mesh.pos_vec[(i * 3) + k] = (double)pos_vec[(i * 3) + k] - ((bound_min[k] * 0.5) + (bound_max[k] * 0.5));
+    }
+
+    //  有重复顶点的退化三角形不绘制任何内容，直接删除
+    mesh.index_vec = index_vec;
+    mesh.tri_alive.assign(tri_cnt, 1);
+    mesh.live_tri = 0;
+    for(t=0;t<tri_cnt;t++)
+    {
+        const unsigned int* p = &index_vec[t * 3];
+        if((p[0] == p[1]) || (p[1] == p[2]) || (p[2] == p[0])) mesh.tri_alive[t] = 0;
+        else                                                   mesh.live_tri++;
+    }
+
+    //  不是恰好被2个三角形使用的边，两端的顶点都不折叠
+    mesh.state_vec.assign(vertex_cnt, LOD_VERTEX_FREE);
+    std::vector<uint64_t> edge_vec;
+    edge_vec.reserve(mesh.live_tri * 3);
+    for(t=0;t<tri_cnt;t++)
+    {
+        if(!mesh.tri_alive[t]) continue;
+        for(k=0;k<3;k++)
+        {
+            unsigned int a = index_vec[(t * 3) + k];
+            unsigned int b = index_vec[(t * 3) + ((k + 1) % 3)];
+            edge_vec.push_back((a < b) ? (((uint64_t)a << 32) | b) : (((uint64_t)b << 32) | a));
+        }
+    }
+    std::sort(edge_vec.begin(), edge_vec.end());
+    for(i=0;i<edge_vec.size();)
+    {
+        size_t j = i + 1;
+        while((j < edge_vec.size()) && (edge_vec[j] == edge_vec[i])) j++;
+        if((j - i) != 2)
+        {
+            mesh.state_vec[(size_t)(edge_vec[i] >> 32)] = LOD_VERTEX_LOCK;
+            mesh.state_vec[(size_t)(edge_vec[i] & 0xFFFFFFFFU)] = LOD_VERTEX_LOCK;
+        }
+        i = j;
+    }
+    std::vector<uint64_t>().swap(edge_vec);
+
+    //  每个顶点的误差矩阵为相邻平面按面积加权之和，角链表按三角形的顺序
+    SQuadric zero_q;
+    for(k=0;k<10;k++) zero_q.a[k] = 0.0;
+    zero_q.weight = 0.0;
+    mesh.quadric_vec.assign(vertex_cnt, zero_q);
+    mesh.corner_next.assign(tri_cnt * 3, LOD_NO_CORNER);
+    mesh.first_corner.assign(vertex_cnt, LOD_NO_CORNER);
+    for(t=tri_cnt;t>0;t--)
+    {
+        if(!mesh.tri_alive[t - 1]) continue;
+        const unsigned int* p = &index_vec[(t - 1) * 3];
+        double n[3];
+        GetLodNormal(&mesh.pos_vec[(size_t)p[0] * 3], &mesh.pos_vec[(size_t)p[1] * 3], &mesh.pos_vec[(size_t)p[2] * 3], n);
+        double len = sqrt((n[0] * n[0]) + (n[1] * n[1]) + (n[2] * n[2]));
+        for(k=2;k>=0;k--)
+        {
+            if(len > 0.0)
+            {
+                const double* p0 = &mesh.pos_vec[(size_t)p[0] * 3];
+                double d = -((n[0] * p0[0]) + (n[1] * p0[1]) + (n[2] * p0[2])) / len;
+                QuadricAddPlane(&mesh.quadric_vec[p[k]], n[0] / len, n[1] / len, n[2] / len, d, len * 0.5);
+            }
+            size_t c = ((t - 1) * 3) + k;
+            mesh.corner_next[c] = mesh.first_corner[p[k]];
+            mesh.first_corner[p[k]] = (unsigned int)c;
+        }
+    }
+
+    mesh.mark_vec.assign(vertex_cnt, 0);
+    mesh.mark = 0;
+    mesh.dirty_vec.assign(vertex_cnt, 0);
+    mesh.pass = 0;
+
+    //  依次达到每一级的目标
+    //  每一遍先找到每个顶点误差最小的折叠，按误差从小到大依次折叠，
+    //  一个折叠改变了周围的三角形后，这些顶点在本遍中不再参与折叠，保证其他折叠的误差和合法性仍然有效
+    //  按比例简化时一遍最多折叠剩余目标的一半(每次折叠大约删除2个三角形)，
+    //  并且误差不超过第goal个折叠的1.5倍，避免误差大的折叠提前进行
+    //  查找时只按误差选择目标，折叠前再检查是否合法，不合法时重新查找合法的目标，下一遍使用
+    //  顶点和折叠目标周围的三角形都没有变化时，上一遍找到的折叠仍然有效，不重新查找
+    size_t tri_base = mesh.live_tri;
+    double max_error = 0.0;
+    size_t level = 0;
+    std::vector<SLodCollapse> best_vec(vertex_cnt);
+    std::vector<unsigned int> best_pass_vec(vertex_cnt, 0);
+    std::vector<SLodCollapse> collapse_vec;
+    while(level < target_vec.size())
+    {
+        size_t target_tri = (target_kind == LOD_TARGET_RATIO) ? (size_t)(target_vec[level] * tri_base) : 0;
+        size_t collapse_cnt = 0;
+        if((target_kind != LOD_TARGET_RATIO) || (mesh.live_tri > target_tri))
+        {
+            mesh.pass++;
+            collapse_vec.clear();
+            for(i=0;i<vertex_cnt;i++)
+            {
+                if(mesh.state_vec[i] != LOD_VERTEX_FREE) continue;
+                SLodCollapse& tmp_c = best_vec[i];
+                if((best_pass_vec[i] == 0) || (mesh.dirty_vec[i] >= best_pass_vec[i]) ||
+                   ((tmp_c.error >= 0.0) && (mesh.dirty_vec[tmp_c.target] >= best_pass_vec[i])))
+                {
+                    tmp_c.vertex = (unsigned int)i;
+                    tmp_c.error = FindLodCollapse(&mesh, (unsigned int)i, 0, &tmp_c.target);
+                    best_pass_vec[i] = mesh.pass;
+                }
+                if(tmp_c.error < 0.0) continue;
+                if((target_kind == LOD_TARGET_ERROR) && (tmp_c.error > target_vec[level])) continue;
+                collapse_vec.push_back(tmp_c);
+            }
+
+            //  只排序误差不超过error_goal的折叠，至少保留误差最小的一个
+            size_t goal = (target_kind == LOD_TARGET_RATIO) ? (((mesh.live_tri - target_tri) / 2) + 1) : collapse_vec.size();
+            if(goal < collapse_vec.size())
+            {
+                std::nth_element(collapse_vec.begin(), collapse_vec.begin() + goal, collapse_vec.end(), LodCollapseLess);
+                double error_goal = collapse_vec[goal].error * 1.5;
+                size_t keep = 0;
+                size_t j = 0;
+                for(j=0;j<collapse_vec.size();j++)
+                {
+                    if((j < goal) || (collapse_vec[j].error <= error_goal)) collapse_vec[keep++] = collapse_vec[j];
+                }
+                collapse_vec.resize(keep);
+            }
+            std::sort(collapse_vec.begin(), collapse_vec.end(), LodCollapseLess);
+
+            for(i=0;(i<collapse_vec.size())&&(collapse_cnt<goal);i++)
+            {
+                const SLodCollapse& tmp_c = collapse_vec[i];
+                if((mesh.dirty_vec[tmp_c.vertex] == mesh.pass) || (mesh.dirty_vec[tmp_c.target] == mesh.pass)) continue;
+                if(!CanLodCollapse(&mesh, tmp_c.vertex, tmp_c.target))
+                {
+                    SLodCollapse& valid_c = best_vec[tmp_c.vertex];
+                    valid_c.error = FindLodCollapse(&mesh, tmp_c.vertex, 1, &valid_c.target);
+                    continue;
+                }
+                LodCollapse(&mesh, tmp_c.vertex, tmp_c.target);
+                if(tmp_c.error > max_error) max_error = tmp_c.error;
+                collapse_cnt++;
+            }
+        }
+
+        //  达到目标或者不能再折叠时保存这一级
+        if((collapse_cnt == 0) || ((target_kind == LOD_TARGET_RATIO) && (mesh.live_tri <= target_tri)))
+        {
+            std::vector<unsigned int> lod_index_vec;
+            GetLodIndex(&mesh, &lod_index_vec);
+            plod_vec->push_back(lod_index_vec);
+            perror_vec->push_back(max_error);
+            level++;
+        }
+    }
+}
+
+//---------------------------------------------------------------------------
+//  文件结束
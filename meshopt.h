@@ -0,0 +1,198 @@
+/****************************************************************************
+
+    程序名称：网格的索引化与优化处理
+    程序设计：rainhenry
+    程序版本：REV 0.1
+    创建日期：20261016
+
+    说明：
+        把平面描述中每个点的(顶点,UV,法线)索引组合去重，得到紧凑的顶点表和三角形索引表
+        按照GPU顶点变换后缓存的命中率重新排列三角形的顺序(Forsyth算法)
+        在顶点缓存的顺序上按簇重新排列，朝外的簇先画，减少不透明网格的过度绘制
+        按照顶点首次被使用的顺序重新排列顶点数据，使取顶点数据时顺序访问内存
+        把三角形列表转换为三角形带，多条带之间用图元重启索引或者退化三角形连接
+        把三角形列表拆分为顶点数和三角形数有上限的小块(meshlet)，每块带有包围球和法线锥，用于按块剔除
+        按表面积启发(SAH)建立三角形的包围盒层次(BVH)，按深度优先顺序展开为数组，用于运行时的剔除和拾取
+        按二次误差度量(QEM)折叠边简化网格，得到共用顶点数据的多级细节(LOD)索引
+
+    版本修订：
+        REV 0.1      rainhenry     20261016    创建文档
+        REV 0.2      rainhenry     20261016    增加顶点缓存优化和ACMR/ATVR统计
+        REV 0.3      rainhenry     20261016    增加顶点数据重排和取数据局部性统计
+        REV 0.4      rainhenry     20261016    增加不去重的网格，用于属性量化编码
+        REV 0.5      rainhenry     20261016    增加三角形带的生成
+        REV 0.6      rainhenry     20261017    平面数据改为紧凑保存的SPlaneList
+        REV 0.7      rainhenry     20261017    增加meshlet的生成
+        REV 0.8      rainhenry     20261017    增加SAH包围盒层次的生成
+        REV 0.9      rainhenry     20261017    增加QEM网格简化
+        REV 1.0      rainhenry     20261017    增加减少过度绘制的三角形排序和软件光栅化统计
+
+****************************************************************************/
+//---------------------------------------------------------------------------
+//  防止重复包含
+#ifndef __meshopt_h__
+#define __meshopt_h__
+
+//---------------------------------------------------------------------------
+//  包含头文件
+#include "objdata.h"
+#include <cstddef>
+#include <vector>
+
+//  定义索引化后的一个顶点，对应OBJ中的一组(v,vt,vn)索引
+//  UV和法线不可用时为-1
+typedef struct
+{
+    int point_index;
+    int uv_index;
+    int vn_index;
+}SVertexKey;
+
+//  定义索引化的网格
+typedef struct
+{
+    std::vector<SVertexKey> vertex_vec;         //  去重后的顶点
+    std::vector<unsigned int> index_vec;        //  三角形索引，每3个为一个三角形
+}SIndexedMesh;
+
+//  对平面描述进行索引化
+//  total_v/total_uv/total_vn为可用的顶点、UV、法线个数，超出范围的UV和法线索引视为不存在
+//  成功返回0，存在无效的顶点索引时返回-2
+int BuildIndexedMesh(const SPlaneList& plane_list, int total_v, int total_uv, int total_vn, SIndexedMesh* pmesh);
+
+//  不去重，每个点都作为单独的顶点，索引为0,1,2,...
+//  参数和返回值与BuildIndexedMesh相同
+int BuildFlatMesh(const SPlaneList& plane_list, int total_v, int total_uv, int total_vn, SIndexedMesh* pmesh);
+
+//  根据顶点个数选择能容纳全部索引的最小索引字节数 1/2/4
+int GetIndexSize(size_t vertex_cnt);
+
+//  统计顶点缓存性能时模拟的FIFO缓存大小
+#define VCACHE_STAT_SIZE        16
+
+//  排序算法中模拟的LRU缓存大小
+#define VCACHE_OPT_SIZE         32
+
+//  模拟cache_size大小的FIFO顶点缓存
+//  *pacmr返回平均每个三角形的缓存未命中次数，*patvr返回平均每个顶点的变换次数
+void AnalyzeVertexCache(const std::vector<unsigned int>& index_vec, size_t vertex_cnt, int cache_size, double* pacmr, double* patvr);
+
+//  重新排列三角形的顺序，提高顶点变换后缓存的命中率
+void OptimizeVertexCache(std::vector<unsigned int>* pindex_vec, size_t vertex_cnt);
+
+//  按遮挡关系重新排列三角形时，簇的ACMR相对于所在部分允许增加的比例
+#define OVERDRAW_DEF_THRESHOLD  1.05
+
+//  估计过度绘制时软件光栅化的视口大小(像素)
+#define OVERDRAW_VIEW_SIZE      256
+
+//  按遮挡关系重新排列三角形，减少不透明网格的过度绘制，index_vec应该已经按顶点缓存优化
+//  3个顶点都不在缓存(VCACHE_STAT_SIZE的FIFO)中的三角形作为一部分的开始，每部分再拆分为ACMR
+//  不超过该部分的threshold倍的簇，簇内保持原来的顺序，簇之间按朝外的程度排序，
+//  位于网格外侧且朝外的簇先画，可以遮挡后画的簇，threshold越大簇越小，过度绘制越少，顶点缓存命中率越低
+//  pos_vec为每个顶点的xyz坐标，pcluster_cnt返回簇的个数，可以为0
+void OptimizeOverdraw(std::vector<unsigned int>* pindex_vec, const std::vector<float>& pos_vec, double threshold, size_t* pcluster_cnt);
+
+//  用软件光栅化估计过度绘制，沿±x ±y ±z 6个方向把包围盒正交投影到OVERDRAW_VIEW_SIZE的方形视口，
+//  剔除背面后按索引的顺序绘制，返回通过深度测试的像素数与被覆盖的像素数之比，1.0为没有过度绘制
+double AnalyzeOverdraw(const std::vector<unsigned int>& index_vec, const std::vector<float>& pos_vec);
+
+//  统计取顶点数据时模拟的内存缓存，缓存行字节数和缓存行个数
+#define VFETCH_LINE_SIZE        64
+#define VFETCH_LINE_CNT         256
+
+//  模拟取顶点数据的过程，只有顶点缓存(VCACHE_STAT_SIZE的FIFO)未命中的顶点才需要取数据
+//  vertex_size为每个顶点的字节数
+//  *pbytes返回平均每个被处理的顶点从内存读取的字节数
+//  *poverfetch返回读取的总字节数与顶点数据总字节数的比值，1.0为理想值
+void AnalyzeVertexFetch(const std::vector<unsigned int>& index_vec, size_t vertex_cnt, unsigned int vertex_size, double* pbytes, double* poverfetch);
+
+//  按照顶点在索引中首次出现的顺序重新排列顶点，同时改写索引
+//  未被任何三角形使用的顶点会被删除
+void OptimizeVertexFetch(SIndexedMesh* pmesh);
+
+//  三角形带之间的连接方式
+#define STRIP_JOIN_RESTART      0       //  图元重启索引(GL_PRIMITIVE_RESTART_FIXED_INDEX)
+#define STRIP_JOIN_DEGENERATE   1       //  重复顶点构成的退化三角形
+
+//  把三角形列表转换为三角形带，保持每个三角形的环绕方向
+//  join为STRIP_JOIN_XXX，restart_index为图元重启索引，*pstrip_cnt返回三角形带的条数
+void StripifyMesh(const std::vector<unsigned int>& index_vec, int join, unsigned int restart_index, std::vector<unsigned int>* pstrip_vec, size_t* pstrip_cnt);
+
+//  meshlet的顶点数和三角形数的上限，块内的顶点序号用1个字节保存
+#define MESHLET_MAX_VERTEX      256
+#define MESHLET_MAX_TRI         512
+
+//  meshlet默认的顶点数和三角形数，与常见的网格着色器限制一致
+#define MESHLET_DEF_VERTEX      64
+#define MESHLET_DEF_TRI         124
+
+//  定义一个meshlet
+//  块内的第k个顶点为全局顶点vertex_vec[vertex_offset + k]
+//  块内的第t个三角形为tri_vec[(tri_offset + t) * 3 + 0..2]，是块内的顶点序号
+//  法线锥：块内全部三角形的法线n都满足dot(n, cone_axis) >= cos(锥的半角)
+//  观察点为eye时，dot(center - eye, cone_axis) >= cone_cutoff * |center - eye| + radius则整块都是背面
+//  法线分布超过半球时cone_cutoff为1，不能按背面剔除
+typedef struct
+{
+    unsigned int vertex_offset;     //  在顶点重映射表中的起点
+    unsigned int vertex_cnt;        //  顶点个数
+    unsigned int tri_offset;        //  在块内三角形表中的起点，单位为三角形
+    unsigned int tri_cnt;           //  三角形个数
+
+    float center[3];                //  包围球的球心
+    float radius;                   //  包围球的半径
+    float cone_axis[3];             //  法线锥的轴，单位向量
+    float cone_cutoff;              //  sin(锥的半角)，不能剔除时为1
+}SMeshlet;
+
+//  把三角形列表按顺序拆分为meshlet，一块的顶点数超过max_vertex或三角形数超过max_tri时开始新的一块
+//  先做顶点缓存优化时相邻的三角形排在一起，得到的块更紧凑
+//  pos_vec为每个顶点的xyz坐标，用于计算包围球和法线锥
+//  pvertex_vec返回每块的顶点重映射表，ptri_vec返回每个三角形3个块内的顶点序号
+void BuildMeshlets(const std::vector<unsigned int>& index_vec, const std::vector<float>& pos_vec, size_t max_vertex, size_t max_tri, std::vector<SMeshlet>* pmeshlet_vec, std::vector<unsigned int>* pvertex_vec, std::vector<unsigned char>* ptri_vec);
+
+//  BVH叶节点的三角形数的上限和默认值
+#define BVH_MAX_LEAF_TRI        64
+#define BVH_DEF_LEAF_TRI        4
+
+//  建立BVH时每个轴上划分的桶数
+#define BVH_SAH_BIN             16
+
+//  定义BVH的一个节点，全部节点按深度优先顺序保存，根节点为0
+//  内部节点的左子节点紧跟在后面，index为右子节点的序号，tri_cnt为0
+//  叶节点的三角形为tri_vec[index]到tri_vec[index + tri_cnt - 1]，是三角形列表中的序号
+typedef struct
+{
+    float bound_min[3];             //  包围盒的最小坐标
+    float bound_max[3];             //  包围盒的最大坐标
+    unsigned int index;             //  内部节点为右子节点的序号，叶节点为在三角形引用表中的起点
+    unsigned int tri_cnt;           //  叶节点的三角形个数，内部节点为0
+}SBvhNode;
+
+//  按SAH建立三角形列表的BVH，每个轴按三角形包围盒的中心分到BVH_SAH_BIN个桶中，选代价最小的划分
+//  三角形数不超过max_leaf且划分不能降低代价时作为叶节点，三角形数超过max_leaf时总是继续划分
+//  pos_vec为每个顶点的xyz坐标，pnode_vec返回全部节点，ptri_vec返回叶节点引用的三角形序号
+void BuildBvh(const std::vector<unsigned int>& index_vec, const std::vector<float>& pos_vec, size_t max_leaf, std::vector<SBvhNode>* pnode_vec, std::vector<unsigned int>* ptri_vec);
+
+//  统计BVH的叶节点个数、最大深度和SAH代价
+//  代价为每个节点的表面积乘以遍历(内部节点计1)或求交(叶节点每个三角形计1)的次数之和，除以根节点的表面积
+void AnalyzeBvh(const std::vector<SBvhNode>& node_vec, size_t* pleaf_cnt, size_t* pmax_depth, double* psah_cost);
+
+//  网格简化的目标
+#define LOD_TARGET_RATIO        0       //  三角形个数与原网格的比例
+#define LOD_TARGET_ERROR        1       //  允许的最大误差，与顶点坐标的单位相同
+
+//  按QEM简化网格，每次把一个顶点折叠到相邻的顶点上，顶点不移动，简化结果仍是原顶点数据的索引
+//  只被一个三角形使用或者被2个以上三角形使用的边上的顶点不折叠，UV接缝和法线不连续处的顶点
+//  在索引中是不同的顶点，这些边都只被一个三角形使用，所以接缝、硬边和开放的边界保持不变
+//  折叠会使三角形翻转或者产生非流形的边时不折叠
+//  target_vec为每一级的目标，按从精细到粗糙排列，从上一级的结果继续简化，全部目标只需要简化一遍
+//  plod_vec返回每一级的索引，三角形保持原来的顺序，perror_vec返回每一级的误差，
+//  为已经折叠的顶点到原网格相邻平面的按面积加权的均方根距离的最大值
+void SimplifyMesh(const std::vector<unsigned int>& index_vec, const std::vector<float>& pos_vec, int target_kind, const std::vector<double>& target_vec, std::vector<std::vector<unsigned int> >* plod_vec, std::vector<double>* perror_vec);
+
+#endif
+
+//---------------------------------------------------------------------------
+//  文件结束
@@ -0,0 +1,597 @@
+/****************************************************************************
+
+    程序名称：法线和切线空间的生成
+    程序设计：rainhenry
+    程序版本：REV 0.1
+    创建日期：20261017
+
+    版本修订：
+        REV 0.1      rainhenry     20261017    创建文档
+
+****************************************************************************/
+//---------------------------------------------------------------------------
+//  包含头文件
+#include "normalgen.h"
+#include "workpool.h"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+//  每个任务处理的三角形或顶点个数
+#define NORMAL_JOB_SIZE         16384
+
+//  收集为分量连续的数组时每块的三角形个数
+#define NORMAL_BLOCK_SIZE       256
+
+//  定义按三角形计算的任务
+//  没有UV时dir_vec[0~2]为单位化的平面法线，有UV时dir_vec[0~2]为切线、dir_vec[3~5]为副切线
+//  angle_vec为每个点所在的角的弧度，退化的角为0
+typedef struct
+{
+    const unsigned int* pindex;
+    const float* ppos;
+    const float* puv;                           //  为0时计算平面法线
+    size_t tri_cnt;
+    std::vector<float> dir_vec[6];
+    std::vector<float> angle_vec;
+}SFaceTask;
+
+//  得到单位化的系数，零向量返回0
+static inline float GetInvLength(float len2)
+{
+    float inv = 1.0f / sqrtf((len2 > 0.0f) ? len2 : 1.0f);
+    return (len2 > 0.0f) ? inv : 0.0f;
+}
+
+//  计算一块三角形，输入为分量连续的数组，输出写入从base开始的位置
+//  pin[0~8]为3个点的xyz，puv_in[0~3]为两条边的du1 dv1 du2 dv2
+//  循环中只有条件选择，按makefile中的VECTFLAGS编译时可以被向量化
+static void GenFaceBlock(SFaceTask* ptask, float (*pin)[NORMAL_BLOCK_SIZE], float (*puv_in)[NORMAL_BLOCK_SIZE], size_t base, size_t cnt)
+{
+    //  结果先写入栈上的数组，与输入不会重叠，编译器不需要检查指针的重叠
+    float cos_buf[3][NORMAL_BLOCK_SIZE];
+    float dir_buf[6][NORMAL_BLOCK_SIZE];
+    float* pcos0 = cos_buf[0];
+    float* pcos1 = cos_buf[1];
+    float* pcos2 = cos_buf[2];
+    float* pd0 = dir_buf[0];
+    float* pd1 = dir_buf[1];
+    float* pd2 = dir_buf[2];
+    float* pd3 = dir_buf[3];
+    float* pd4 = dir_buf[4];
+    float* pd5 = dir_buf[5];
+    size_t i = 0;
+
+    //  平面法线
+    if(puv_in == 0)
+    {
+        for(i=0;i<cnt;i++)
+        {
+            float e1x = pin[3][i] - pin[0][i];
+            float e1y = pin[4][i] - pin[1][i];
+            float e1z = pin[5][i] - pin[2][i];
+            float e2x = pin[6][i] - pin[0][i];
+            float e2y = pin[7][i] - pin[1][i];
+            float e2z = pin[8][i] - pin[2][i];
+            float nx = (e1y * e2z) - (e1z * e2y);
+            float ny = (e1z * e2x) - (e1x * e2z);
+            float nz = (e1x * e2y) - (e1y * e2x);
+            float inv = GetInvLength((nx * nx) + (ny * ny) + (nz * nz));
+            pd0[i] = nx * inv;
+            pd1[i] = ny * inv;
+            pd2[i] = nz * inv;
+        }
+    }
+    //  切线和副切线，t = e1*dv2 - e2*dv1    b = e2*du1 - e1*du2，按UV面积的符号翻转，UV退化时为0
+    else
+    {
+        for(i=0;i<cnt;i++)
+        {
+            float e1x = pin[3][i] - pin[0][i];
+            float e1y = pin[4][i] - pin[1][i];
+            float e1z = pin[5][i] - pin[2][i];
+            float e2x = pin[6][i] - pin[0][i];
+            float e2y = pin[7][i] - pin[1][i];
+            float e2z = pin[8][i] - pin[2][i];
+            float du1 = puv_in[0][i];
+            float dv1 = puv_in[1][i];
+            float du2 = puv_in[2][i];
+            float dv2 = puv_in[3][i];
+            float area = (du1 * dv2) - (du2 * dv1);
+            float sign = (area < 0.0f) ? -1.0f : 1.0f;
+            sign = (area != 0.0f) ? sign : 0.0f;
+            float tx = ((e1x * dv2) - (e2x * dv1)) * sign;
+            float ty = ((e1y * dv2) - (e2y * dv1)) * sign;
+            float tz = ((e1z * dv2) - (e2z * dv1)) * sign;
+            float bx = ((e2x * du1) - (e1x * du2)) * sign;
+            float by = ((e2y * du1) - (e1y * du2)) * sign;
+            float bz = ((e2z * du1) - (e1z * du2)) * sign;
+            float inv_t = GetInvLength((tx * tx) + (ty * ty) + (tz * tz));
+            float inv_b = GetInvLength((bx * bx) + (by * by) + (bz * bz));
+            pd0[i] = tx * inv_t;
+            pd1[i] = ty * inv_t;
+            pd2[i] = tz * inv_t;
+            pd3[i] = bx * inv_b;
+            pd4[i] = by * inv_b;
+            pd5[i] = bz * inv_b;
+        }
+    }
+
+    //  3个角的余弦，a处为e1和e2，b处为-e1和e3，c处为-e2和-e3，退化的角为1
+    //  e1=b-a  e2=c-a  e3=c-b
+    for(i=0;i<cnt;i++)
+    {
+        float e1x = pin[3][i] - pin[0][i];
+        float e1y = pin[4][i] - pin[1][i];
+        float e1z = pin[5][i] - pin[2][i];
+        float e2x = pin[6][i] - pin[0][i];
+        float e2y = pin[7][i] - pin[1][i];
+        float e2z = pin[8][i] - pin[2][i];
+        float e3x = e2x - e1x;
+        float e3y = e2y - e1y;
+        float e3z = e2z - e1z;
+        float l1 = (e1x * e1x) + (e1y * e1y) + (e1z * e1z);
+        float l2 = (e2x * e2x) + (e2y * e2y) + (e2z * e2z);
+        float l3 = (e3x * e3x) + (e3y * e3y) + (e3z * e3z);
+        float c0 = ((e1x * e2x) + (e1y * e2y) + (e1z * e2z)) * GetInvLength(l1 * l2);
+        float c1 = -((e1x * e3x) + (e1y * e3y) + (e1z * e3z)) * GetInvLength(l1 * l3);
+        float c2 = ((e2x * e3x) + (e2y * e3y) + (e2z * e3z)) * GetInvLength(l2 * l3);
+        pcos0[i] = ((l1 * l2) > 0.0f) ? c0 : 1.0f;
+        pcos1[i] = ((l1 * l3) > 0.0f) ? c1 : 1.0f;
+        pcos2[i] = ((l2 * l3) > 0.0f) ? c2 : 1.0f;
+    }
+
+    int k = 0;
+    for(k=0;k<((puv_in == 0) ? 3 : 6);k++)
+    {
+        memcpy(ptask->dir_vec[k].data() + base, dir_buf[k], cnt * sizeof(float));
+    }
+
+    //  由余弦得到角度
+    float* pangle = ptask->angle_vec.data() + (base * 3);
+    for(i=0;i<cnt;i++)
+    {
+        pangle[(i * 3) + 0] = acosf(fminf(fmaxf(pcos0[i], -1.0f), 1.0f));
+        pangle[(i * 3) + 1] = acosf(fminf(fmaxf(pcos1[i], -1.0f), 1.0f));
+        pangle[(i * 3) + 2] = acosf(fminf(fmaxf(pcos2[i], -1.0f), 1.0f));
+    }
+}
+
+//  按三角形计算的任务，每块的坐标先收集为分量连续的数组再计算
+static void GenFaceJob(size_t job, void* puser)
+{
+    SFaceTask* ptask = (SFaceTask*)puser;
+    size_t begin = job * NORMAL_JOB_SIZE;
+    size_t end = begin + NORMAL_JOB_SIZE;
+    if(end > ptask->tri_cnt) end = ptask->tri_cnt;
+
+    float in_buf[9][NORMAL_BLOCK_SIZE];
+    float uv_buf[4][NORMAL_BLOCK_SIZE];
+    size_t base = 0;
+    for(base=begin;base<end;base+=NORMAL_BLOCK_SIZE)
+    {
+        size_t cnt = end - base;
+        if(cnt > NORMAL_BLOCK_SIZE) cnt = NORMAL_BLOCK_SIZE;
+
+        size_t i = 0;
+        int k = 0;
+        for(i=0;i<cnt;i++)
+        {
+            const unsigned int* ptri = ptask->pindex + ((base + i) * 3);
+            for(k=0;k<3;k++)
+            {
+                const float* pv = ptask->ppos + ((size_t)ptri[k] * 3);
+                in_buf[(k * 3) + 0][i] = pv[0];
+                in_buf[(k * 3) + 1][i] = pv[1];
+                in_buf[(k * 3) + 2][i] = pv[2];
+            }
+            if(ptask->puv != 0)
+            {
+                const float* puv0 = ptask->puv + ((size_t)ptri[0] * 2);
+                const float* puv1 = ptask->puv + ((size_t)ptri[1] * 2);
+                const float* puv2 = ptask->puv + ((size_t)ptri[2] * 2);
+                uv_buf[0][i] = puv1[0] - puv0[0];
+                uv_buf[1][i] = puv1[1] - puv0[1];
+                uv_buf[2][i] = puv2[0] - puv0[0];
+                uv_buf[3][i] = puv2[1] - puv0[1];
+            }
+        }
+        GenFaceBlock(ptask, in_buf, (ptask->puv != 0) ? uv_buf : 0, base, cnt);
+    }
+}
+
+//  多线程计算全部三角形的平面法线或切线，以及每个角的角度
+static void RunFaceTask(SFaceTask* ptask, int thread_num)
+{
+    int k = 0;
+    for(k=0;k<6;k++)
+    {
+        if((ptask->puv != 0) || (k < 3)) ptask->dir_vec[k].resize(ptask->tri_cnt);
+    }
+    ptask->angle_vec.resize(ptask->tri_cnt * 3);
+    RunWorkPool((ptask->tri_cnt + NORMAL_JOB_SIZE - 1) / NORMAL_JOB_SIZE, thread_num, GenFaceJob, ptask);
+}
+
+//  按键值分组点，pkey_vec为每个点的键值，pstart_vec返回每组在plist_vec中的起点，组内按点的序号排列
+static void GroupCorners(const std::vector<unsigned int>& key_vec, size_t group_cnt, std::vector<size_t>* pstart_vec, std::vector<unsigned int>* plist_vec)
+{
+    pstart_vec->assign(group_cnt + 1, 0);
+    plist_vec->resize(key_vec.size());
+    size_t i = 0;
+    for(i=0;i<key_vec.size();i++)
+    {
+        pstart_vec->at(key_vec[i] + 1)++;
+    }
+    for(i=0;i<group_cnt;i++)
+    {
+        pstart_vec->at(i + 1) += pstart_vec->at(i);
+    }
+    std::vector<size_t> pos_vec(pstart_vec->begin(), pstart_vec->end() - 1);
+    for(i=0;i<key_vec.size();i++)
+    {
+        plist_vec->at(pos_vec[key_vec[i]]++) = (unsigned int)i;
+    }
+}
+
+//  定义按坐标排序的顶点
+typedef struct
+{
+    float x;
+    float y;
+    float z;
+    unsigned int index;
+}SWeldPos;
+
+//  按坐标排序，坐标相同时按顶点序号排序
+static inline bool WeldPosLess(const SWeldPos& a, const SWeldPos& b)
+{
+    if(a.x != b.x) return a.x < b.x;
+    if(a.y != b.y) return a.y < b.y;
+    if(a.z != b.z) return a.z < b.z;
+    return a.index < b.index;
+}
+
+//  坐标相同的顶点合并为一个位置，pweld_vec返回每个顶点所在位置中最小的顶点序号
+static void WeldPositions(const std::vector<float>& pos_vec, std::vector<unsigned int>* pweld_vec)
+{
+    size_t pos_cnt = pos_vec.size() / 3;
+    std::vector<SWeldPos> sort_vec(pos_cnt);
+    size_t i = 0;
+    for(i=0;i<pos_cnt;i++)
+    {
+        sort_vec[i].x = pos_vec[(i * 3) + 0];
+        sort_vec[i].y = pos_vec[(i * 3) + 1];
+        sort_vec[i].z = pos_vec[(i * 3) + 2];
+        sort_vec[i].index = (unsigned int)i;
+    }
+    std::sort(sort_vec.begin(), sort_vec.end(), WeldPosLess);
+
+    pweld_vec->resize(pos_cnt);
+    unsigned int first = 0;
+    for(i=0;i<pos_cnt;i++)
+    {
+        if((i == 0) || (sort_vec[i - 1].x != sort_vec[i].x) || (sort_vec[i - 1].y != sort_vec[i].y) || (sort_vec[i - 1].z != sort_vec[i].z))
+        {
+            first = sort_vec[i].index;
+        }
+        pweld_vec->at(sort_vec[i].index) = first;
+    }
+}
+
+//  定义按顶点位置平滑法线的任务
+typedef struct
+{
+    const SFaceTask* pface;
+    const size_t* pstart;
+    const unsigned int* plist;
+    size_t group_cnt;
+    float crease_cos;
+    std::vector<float> corner_vec[3];           //  每个点的法线
+    std::vector<unsigned int> local_vec;        //  每个点的法线在所在顶点中的序号
+    std::vector<unsigned int> uniq_vec;         //  每个顶点上不同的法线个数
+}SSmoothTask;
+
+//  平滑一组顶点位置上的法线
+//  每个点累加夹角不超过折痕角的相邻平面法线，按角度加权，自己所在的平面总是参与累加
+static void SmoothNormalJob(size_t job, void* puser)
+{
+    SSmoothTask* ptask = (SSmoothTask*)puser;
+    const SFaceTask* pface = ptask->pface;
+    const float* pfx = pface->dir_vec[0].data();
+    const float* pfy = pface->dir_vec[1].data();
+    const float* pfz = pface->dir_vec[2].data();
+    size_t begin = job * NORMAL_JOB_SIZE;
+    size_t end = begin + NORMAL_JOB_SIZE;
+    if(end > ptask->group_cnt) end = ptask->group_cnt;
+
+    size_t g = 0;
+    for(g=begin;g<end;g++)
+    {
+        size_t first = ptask->pstart[g];
+        size_t last = ptask->pstart[g + 1];
+        unsigned int uniq = 0;
+        size_t i = 0;
+        size_t j = 0;
+        for(i=first;i<last;i++)
+        {
+            unsigned int c = ptask->plist[i];
+            unsigned int f = c / 3;
+            float sx = 0.0f;
+            float sy = 0.0f;
+            float sz = 0.0f;
+            float ax = 0.0f;
+            float ay = 0.0f;
+            float az = 0.0f;
+            for(j=first;j<last;j++)
+            {
+                unsigned int d = ptask->plist[j];
+                unsigned int e = d / 3;
+                float w = pface->angle_vec[d];
+                ax += pfx[e] * w;
+                ay += pfy[e] * w;
+                az += pfz[e] * w;
+                float dot = (pfx[f] * pfx[e]) + (pfy[f] * pfy[e]) + (pfz[f] * pfz[e]);
+                if((e != f) && (dot < ptask->crease_cos)) continue;
+                sx += pfx[e] * w;
+                sy += pfy[e] * w;
+                sz += pfz[e] * w;
+            }
+
+            //  只有退化的平面时不考虑折痕角，全部退化时使用+z
+            float inv = GetInvLength((sx * sx) + (sy * sy) + (sz * sz));
+            if(inv == 0.0f)
+            {
+                sx = ax;
+                sy = ay;
+                sz = az;
+                inv = GetInvLength((sx * sx) + (sy * sy) + (sz * sz));
+            }
+            if(inv == 0.0f)
+            {
+                sz = 1.0f;
+                inv = 1.0f;
+            }
+            float nx = sx * inv;
+            float ny = sy * inv;
+            float nz = sz * inv;
+            ptask->corner_vec[0][c] = nx;
+            ptask->corner_vec[1][c] = ny;
+            ptask->corner_vec[2][c] = nz;
+
+            //  与同一位置上前面的点相同时共用
+            ptask->local_vec[c] = uniq;
+            for(j=first;j<i;j++)
+            {
+                unsigned int d = ptask->plist[j];
+                if((ptask->corner_vec[0][d] == nx) && (ptask->corner_vec[1][d] == ny) && (ptask->corner_vec[2][d] == nz))
+                {
+                    ptask->local_vec[c] = ptask->local_vec[d];
+                    break;
+                }
+            }
+            if(ptask->local_vec[c] == uniq) uniq++;
+        }
+        ptask->uniq_vec[g] = uniq;
+    }
+}
+
+//  按角度加权生成平滑法线
+void GenerateNormals(const std::vector<unsigned int>& index_vec, const std::vector<float>& pos_vec, double crease_deg, int thread_num, std::vector<float>* pnormal_vec, std::vector<unsigned int>* pcorner_vec)
+{
+    size_t corner_cnt = (index_vec.size() / 3) * 3;
+    size_t pos_cnt = pos_vec.size() / 3;
+    pnormal_vec->clear();
+    pcorner_vec->assign(corner_cnt, 0);
+    if(corner_cnt == 0) return;
+
+    //  平面法线和每个角的角度
+    SFaceTask face_task;
+    face_task.pindex = index_vec.data();
+    face_task.ppos = pos_vec.data();
+    face_task.puv = 0;
+    face_task.tri_cnt = corner_cnt / 3;
+    RunFaceTask(&face_task, thread_num);
+
+    //  按顶点位置分组，坐标相同的顶点为同一个位置
+    std::vector<unsigned int> weld_vec;
+    WeldPositions(pos_vec, &weld_vec);
+    std::vector<unsigned int> key_vec(corner_cnt);
+    size_t i = 0;
+    for(i=0;i<corner_cnt;i++)
+    {
+        key_vec[i] = weld_vec[index_vec[i]];
+    }
+    std::vector<size_t> start_vec;
+    std::vector<unsigned int> list_vec;
+    GroupCorners(key_vec, pos_cnt, &start_vec, &list_vec);
+
+    //  每个点的平滑法线
+    SSmoothTask smooth_task;
+    smooth_task.pface = &face_task;
+    smooth_task.pstart = start_vec.data();
+    smooth_task.plist = list_vec.data();
+    smooth_task.group_cnt = pos_cnt;
+    smooth_task.crease_cos = (float)cos(crease_deg * M_PI / 180.0);
+    int k = 0;
+    for(k=0;k<3;k++)
+    {
+        smooth_task.corner_vec[k].resize(corner_cnt);
+    }
+    smooth_task.local_vec.resize(corner_cnt);
+    smooth_task.uniq_vec.resize(pos_cnt);
+    RunWorkPool((pos_cnt + NORMAL_JOB_SIZE - 1) / NORMAL_JOB_SIZE, thread_num, SmoothNormalJob, &smooth_task);
+
+    //  按顶点位置的顺序分配法线的序号
+    std::vector<size_t> base_vec(pos_cnt + 1, 0);
+    for(i=0;i<pos_cnt;i++)
+    {
+        base_vec[i + 1] = base_vec[i] + smooth_task.uniq_vec[i];
+    }
+    pnormal_vec->resize(base_vec[pos_cnt] * 3);
+    for(i=0;i<corner_cnt;i++)
+    {
+        size_t id = base_vec[key_vec[i]] + smooth_task.local_vec[i];
+        pcorner_vec->at(i) = (unsigned int)id;
+        for(k=0;k<3;k++)
+        {
+            pnormal_vec->at((id * 3) + k) = smooth_task.corner_vec[k][i];
+        }
+    }
+}
+
+//  定义按焊接序号累加切线的任务
+typedef struct
+{
+    const SFaceTask* pface;
+    const unsigned int* pindex;
+    const float* pnormal;
+    const size_t* pstart;
+    const unsigned int* plist;
+    size_t group_cnt;
+    std::vector<float> sum_vec;                 //  每组累加的切线xyz和副切线xyz
+}STangentTask;
+
+//  累加一组焊接在一起的顶点的切线和副切线，投影到顶点法线的平面上，按角度加权
+static void SumTangentJob(size_t job, void* puser)
+{
+    STangentTask* ptask = (STangentTask*)puser;
+    const SFaceTask* pface = ptask->pface;
+    size_t begin = job * NORMAL_JOB_SIZE;
+    size_t end = begin + NORMAL_JOB_SIZE;
+    if(end > ptask->group_cnt) end = ptask->group_cnt;
+
+    size_t g = 0;
+    for(g=begin;g<end;g++)
+    {
+        float sum[6] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+        size_t i = 0;
+        int k = 0;
+        for(i=ptask->pstart[g];i<ptask->pstart[g + 1];i++)
+        {
+            unsigned int c = ptask->plist[i];
+            unsigned int f = c / 3;
+            const float* pn = ptask->pnormal + ((size_t)ptask->pindex[c] * 3);
+            float w = pface->angle_vec[c];
+            int j = 0;
+            for(j=0;j<2;j++)
+            {
+                float vx = pface->dir_vec[(j * 3) + 0][f];
+                float vy = pface->dir_vec[(j * 3) + 1][f];
+                float vz = pface->dir_vec[(j * 3) + 2][f];
+                float dot = (pn[0] * vx) + (pn[1] * vy) + (pn[2] * vz);
+                vx -= pn[0] * dot;
+                vy -= pn[1] * dot;
+                vz -= pn[2] * dot;
+                float inv = GetInvLength((vx * vx) + (vy * vy) + (vz * vz)) * w;
+                sum[(j * 3) + 0] += vx * inv;
+                sum[(j * 3) + 1] += vy * inv;
+                sum[(j * 3) + 2] += vz * inv;
+            }
+        }
+        for(k=0;k<6;k++)
+        {
+            ptask->sum_vec[(g * 6) + k] = sum[k];
+        }
+    }
+}
+
+//  计算每个顶点的切线空间
+void GenerateTangents(const std::vector<unsigned int>& index_vec, const std::vector<unsigned int>& weld_vec, const std::vector<float>& pos_vec, const std::vector<float>& uv_vec, const std::vector<float>& normal_vec, int thread_num, std::vector<float>* ptangent_vec)
+{
+    size_t corner_cnt = (index_vec.size() / 3) * 3;
+    size_t vertex_cnt = pos_vec.size() / 3;
+    ptangent_vec->assign(vertex_cnt * 4, 0.0f);
+
+    //  平面的切线、副切线和每个角的角度
+    SFaceTask face_task;
+    face_task.pindex = index_vec.data();
+    face_task.ppos = pos_vec.data();
+    face_task.puv = uv_vec.data();
+    face_task.tri_cnt = corner_cnt / 3;
+    RunFaceTask(&face_task, thread_num);
+
+    //  OBJ中的法线不一定是单位向量
+    std::vector<float> unit_vec(vertex_cnt * 3);
+    size_t i = 0;
+    for(i=0;i<vertex_cnt;i++)
+    {
+        const float* pn = &normal_vec[i * 3];
+        float inv = GetInvLength((pn[0] * pn[0]) + (pn[1] * pn[1]) + (pn[2] * pn[2]));
+        unit_vec[(i * 3) + 0] = pn[0] * inv;
+        unit_vec[(i * 3) + 1] = pn[1] * inv;
+        unit_vec[(i * 3) + 2] = pn[2] * inv;
+    }
+
+    //  按焊接序号分组
+    size_t group_cnt = weld_vec.empty() ? vertex_cnt : 0;
+    std::vector<unsigned int> key_vec(corner_cnt);
+    for(i=0;i<weld_vec.size();i++)
+    {
+        if(weld_vec[i] >= group_cnt) group_cnt = (size_t)weld_vec[i] + 1;
+    }
+    for(i=0;i<corner_cnt;i++)
+    {
+        key_vec[i] = weld_vec.empty() ? index_vec[i] : weld_vec[index_vec[i]];
+    }
+    std::vector<size_t> start_vec;
+    std::vector<unsigned int> list_vec;
+    GroupCorners(key_vec, group_cnt, &start_vec, &list_vec);
+
+    STangentTask tangent_task;
+    tangent_task.pface = &face_task;
+    tangent_task.pindex = index_vec.data();
+    tangent_task.pnormal = unit_vec.data();
+    tangent_task.pstart = start_vec.data();
+    tangent_task.plist = list_vec.data();
+    tangent_task.group_cnt = group_cnt;
+    tangent_task.sum_vec.resize(group_cnt * 6);
+    RunWorkPool((group_cnt + NORMAL_JOB_SIZE - 1) / NORMAL_JOB_SIZE, thread_num, SumTangentJob, &tangent_task);
+
+    //  每个顶点的切线再与自己的法线正交，w为副切线相对于cross(n,t)的方向
+    for(i=0;i<vertex_cnt;i++)
+    {
+        const float* pn = &unit_vec[i * 3];
+        const float* psum = &tangent_task.sum_vec[(weld_vec.empty() ? i : weld_vec[i]) * 6];
+        float tx = psum[0];
+        float ty = psum[1];
+        float tz = psum[2];
+        float dot = (pn[0] * tx) + (pn[1] * ty) + (pn[2] * tz);
+        tx -= pn[0] * dot;
+        ty -= pn[1] * dot;
+        tz -= pn[2] * dot;
+        float inv = GetInvLength((tx * tx) + (ty * ty) + (tz * tz));
+
+        //  没有有效的UV时取与法线垂直的任意方向
+        if(inv == 0.0f)
+        {
+            tx = (fabsf(pn[0]) < 0.9f) ? 1.0f : 0.0f;
+            ty = 1.0f - tx;
+            tz = 0.0f;
+            dot = (pn[0] * tx) + (pn[1] * ty);
+            tx -= pn[0] * dot;
+            ty -= pn[1] * dot;
+            tz -= pn[2] * dot;
+            inv = GetInvLength((tx * tx) + (ty * ty) + (tz * tz));
+            if(inv == 0.0f)
+            {
+                tx = 1.0f;
+                inv = 1.0f;
+            }
+        }
+        tx *= inv;
+        ty *= inv;
+        tz *= inv;
+
+        float cx = (pn[1] * tz) - (pn[2] * ty);
+        float cy = (pn[2] * tx) - (pn[0] * tz);
+        float cz = (pn[0] * ty) - (pn[1] * tx);
+        float side = (cx * psum[3]) + (cy * psum[4]) + (cz * psum[5]);
+        ptangent_vec->at((i * 4) + 0) = tx;
+        ptangent_vec->at((i * 4) + 1) = ty;
+        ptangent_vec->at((i * 4) + 2) = tz;
+        ptangent_vec->at((i * 4) + 3) = (side < 0.0f) ? -1.0f : 1.0f;
+    }
+}
+
+//---------------------------------------------------------------------------
+//  文件结束
@@ -0,0 +1,50 @@
+/****************************************************************************
+
+    程序名称：法线和切线空间的生成
+    程序设计：rainhenry
+    程序版本：REV 0.1
+    创建日期：20261017
+
+    说明：
+        OBJ文件中没有vn记录时，按角度加权生成平滑法线，相邻平面的法线夹角大于折痕角时作为硬边，
+        坐标相同的顶点作为同一个位置平滑，OBJ中在UV接缝处重复的顶点不会产生法线的接缝，
+        同一个位置上结果相同的法线只保存一份
+        法线贴图用的切线空间按MikkTSpace的方法计算：每个平面的切线和副切线投影到顶点法线的平面上，
+        按角度加权累加，w为副切线相对于cross(法线,切线)的方向(+1/-1)
+        MikkTSpace在镜像UV的接缝处会拆分顶点，这里顶点已经确定，同一个顶点的方向按加权累加的副切线决定
+        平面法线、切线和角度按三角形分块在多个线程中计算，每块的坐标先收集为分量连续的数组，
+        计算部分可以被编译器向量化；按顶点累加时每个顶点只由一个线程按固定顺序累加，结果与线程数无关
+
+    版本修订：
+        REV 0.1      rainhenry     20261017    创建文档
+
+****************************************************************************/
+//---------------------------------------------------------------------------
+//  防止重复包含
+#ifndef __normalgen_h__
+#define __normalgen_h__
+
+//---------------------------------------------------------------------------
+//  包含头文件
+#include <cstddef>
+#include <vector>
+
+//  默认的折痕角，单位度
+#define NORMAL_DEF_CREASE       60.0
+
+//  按角度加权生成平滑法线，相邻平面的法线夹角大于crease_deg时不平滑，crease_deg为180时全部平滑
+//  index_vec为每个点的顶点序号，每3个为一个三角形，pos_vec为每个顶点的xyz坐标
+//  pnormal_vec返回生成的法线xyz，pcorner_vec返回每个点使用的法线序号
+//  thread_num个线程计算，小于等于0时使用全部CPU核心
+void GenerateNormals(const std::vector<unsigned int>& index_vec, const std::vector<float>& pos_vec, double crease_deg, int thread_num, std::vector<float>* pnormal_vec, std::vector<unsigned int>* pcorner_vec);
+
+//  计算每个顶点的切线空间
+//  index_vec为三角形的顶点序号，pos_vec/uv_vec/normal_vec为每个顶点的xyz、uv、法线，法线不需要是单位向量
+//  weld_vec为每个顶点的焊接序号，焊接序号相同的顶点一起累加，为空时每个顶点单独累加
+//  ptangent_vec返回每个顶点的切线xyz和副切线的方向w，没有有效UV的顶点返回与法线垂直的任意方向
+void GenerateTangents(const std::vector<unsigned int>& index_vec, const std::vector<unsigned int>& weld_vec, const std::vector<float>& pos_vec, const std::vector<float>& uv_vec, const std::vector<float>& normal_vec, int thread_num, std::vector<float>* ptangent_vec);
+
+#endif
+
+//---------------------------------------------------------------------------
+//  文件结束
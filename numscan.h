@@ -0,0 +1,302 @@
+/****************************************************************************
+
+    程序名称：OBJ数值记录的专用解析
+    程序设计：rainhenry
+    程序版本：REV 0.1
+    创建日期：20261016
+
+    说明：
+        替代v/vt/vn/f行中的sscanf，直接在[p, pend)范围的字节上解析
+        不依赖locale，不需要以0结尾的字符串
+        解析结果与sscanf的"%f"和"%d"逐位一致：
+            1、常见的十进制小数在快速路径中用一次正确舍入的double运算得到，
+               仅当double结果恰好落在两个float的中点上(可能产生二次舍入)时放弃快速路径
+            2、inf/nan/十六进制浮点、超过19位有效数字等少见的写法，
+               复制到0结尾的缓冲区后交给sscanf处理
+        连续的数字串在小端机器上每次按8个字节并行判断和转换(SWAR)
+
+    版本修订：
+        REV 0.1      rainhenry     20261016    创建文档
+
+****************************************************************************/
+//---------------------------------------------------------------------------
+//  防止重复包含
+#ifndef __numscan_h__
+#define __numscan_h__
+
+//---------------------------------------------------------------------------
+//  包含头文件
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <cfloat>
+#include <string>
+
+//  小端机器上允许8字节并行处理数字串
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define NUMSCAN_SWAR       1
+#else
+#define NUMSCAN_SWAR       0
+#endif
+
+//  判断是否为sscanf认可的空白字符
+static inline int ScanIsSpace(char ch)
+{
+    return (ch == ' ') || (ch == '\t') || (ch == '\n') || (ch == '\v') || (ch == '\f') || (ch == '\r');
+}
+
+//  判断是否为数字
+static inline int ScanIsDigit(char ch)
+{
+    return (unsigned char)(ch - '0') < 10;
+}
+
+//  跳过空白字符，返回第一个非空白字符的位置
+static inline const char* ScanSkipSpace(const char* p, const char* pend)
+{
+    while((p < pend) && ScanIsSpace(*p)) p++;
+    return p;
+}
+
+#if NUMSCAN_SWAR
+//  判断8个字节是否全部为数字
+static inline int ScanIs8Digits(uint64_t val)
+{
+    return (((val & 0xF0F0F0F0F0F0F0F0ULL) |
+             (((val + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) ==
+            0x3333333333333333ULL);
+}
+
+//  将8个数字字符转换为整数
+static inline uint32_t ScanParse8Digits(uint64_t val)
+{
+    const uint64_t mask = 0x000000FF000000FFULL;
+    const uint64_t mul1 = 0x000F424000000064ULL;    //  100 + (1000000 << 32)
+    const uint64_t mul2 = 0x0000271000000001ULL;    //  1 + (10000 << 32)
+    val -= 0x3030303030303030ULL;
+    val = (val * 10) + (val >> 8);
+    val = (((val & mask) * mul1) + (((val >> 16) & mask) * mul2)) >> 32;
+    return (uint32_t)val;
+}
+#endif
+
+//  累加一段连续的数字到尾数
+//  最多累加到19位，超出时*poverflow置1，仍然会跳过所有数字
+//  返回数字串结束的位置，*pcnt返回数字的个数
+static inline const char* ScanDigits(const char* p, const char* pend, uint64_t* pmant, int* pdigits, int* pcnt, int* poverflow)
+{
+    const char* pstart = p;
+
+    #if NUMSCAN_SWAR
+    //  8个数字一组并行转换
+    while(((pend - p) >= 8) && (*pdigits <= (19 - 8)))
+    {
+        uint64_t val;
+        memcpy(&val, p, 8);
+        if(!ScanIs8Digits(val)) break;
+        *pmant = (*pmant * 100000000ULL) + ScanParse8Digits(val);
+        *pdigits += 8;
+        p += 8;
+    }
+    #endif
+
+    //  剩余的数字逐个转换
+    while((p < pend) && ScanIsDigit(*p))
+    {
+        if(*pdigits < 19)
+        {
+            *pmant = (*pmant * 10) + (uint64_t)(*p - '0');
+            (*pdigits)++;
+        }
+        else
+        {
+            *poverflow = 1;
+        }
+        p++;
+    }
+
+    *pcnt = (int)(p - pstart);
+    return p;
+}
+
+//  慢速路径：复制到0结尾的缓冲区后使用sscanf解析一个浮点数
+//  失败返回0，成功返回解析结束的位置
+static inline const char* ScanFloatSlow(const char* p, const char* pend, float* pout)
+{
+    std::string tmp_str(p, pend - p);
+    int used = 0;
+    float tmp_f = 0.0f;
+    if(sscanf(tmp_str.c_str(), "%f%n", &tmp_f, &used) != 1) return 0;
+    *pout = tmp_f;
+    return p + used;
+}
+
+//  解析一个浮点数，等价于sscanf的"%f"，会先跳过空白
+//  失败返回0，此时*pout不被修改，成功返回解析结束的位置
+static inline const char* ScanFloat(const char* p, const char* pend, float* pout)
+{
+    //  10的0~22次幂，都可以被double精确表示
+    static const double pow10_tab[23] =
+    {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    p = ScanSkipSpace(p, pend);
+    const char* pstart = p;
+
+    //  符号
+    int neg = 0;
+    if((p < pend) && ((*p == '-') || (*p == '+')))
+    {
+        neg = (*p == '-');
+        p++;
+    }
+
+    //  整数部分和小数部分
+    uint64_t mant = 0;
+    int digits = 0;
+    int overflow = 0;
+    int int_cnt = 0;
+    int frac_cnt = 0;
+    p = ScanDigits(p, pend, &mant, &digits, &int_cnt, &overflow);
+    int int_digits = digits;
+    if((p < pend) && (*p == '.'))
+    {
+        p++;
+        p = ScanDigits(p, pend, &mant, &digits, &frac_cnt, &overflow);
+    }
+
+    //  没有任何数字(inf、nan、单独的符号或小数点等)
+    if((int_cnt + frac_cnt) == 0) return ScanFloatSlow(pstart, pend, pout);
+
+    //  指数部分
+    int exp10 = 0;
+    if((p < pend) && ((*p == 'e') || (*p == 'E')))
+    {
+        p++;
+        int exp_neg = 0;
+        if((p < pend) && ((*p == '-') || (*p == '+')))
+        {
+            exp_neg = (*p == '-');
+            p++;
+        }
+        if((p >= pend) || !ScanIsDigit(*p)) return ScanFloatSlow(pstart, pend, pout);
+        while((p < pend) && ScanIsDigit(*p))
+        {
+            if(exp10 < 10000) exp10 = (exp10 * 10) + (*p - '0');
+            p++;
+        }
+        if(exp_neg) exp10 = -exp10;
+    }
+
+    //  数字后面紧跟可能属于数值写法的字符(如0x1p3)，交给sscanf
+    if((p < pend) && (((*p >= 'a') && (*p <= 'z')) || ((*p >= 'A') && (*p <= 'Z')) || (*p == '.')))
+    {
+        return ScanFloatSlow(pstart, pend, pout);
+    }
+
+    //  有效数字超过19位
+    if(overflow) return ScanFloatSlow(pstart, pend, pout);
+
+    //  小数部分计入指数
+    exp10 -= (digits - int_digits);
+
+    //  尾数为0
+    if(mant == 0)
+    {
+        *pout = neg ? -0.0f : 0.0f;
+        return p;
+    }
+
+    //  尾数和10的幂都能被double精确表示时，一次运算得到正确舍入的double
+    if((mant > (1ULL << 53)) || (exp10 < -22) || (exp10 > 22)) return ScanFloatSlow(pstart, pend, pout);
+    double val = (double)mant;
+    if(exp10 < 0) val /= pow10_tab[-exp10];
+    else          val *= pow10_tab[exp10];
+
+    //  超出float的正规数范围，交给sscanf处理溢出和非正规数
+    if((val < (double)FLT_MIN) || (val > (double)FLT_MAX)) return ScanFloatSlow(pstart, pend, pout);
+
+    //  double结果恰好是两个float的中点时，二次舍入可能出错
+    uint64_t bits;
+    memcpy(&bits, &val, sizeof(bits));
+    if((bits & 0x1FFFFFFFULL) == 0x10000000ULL) return ScanFloatSlow(pstart, pend, pout);
+
+    *pout = neg ? -(float)val : (float)val;
+    return p;
+}
+
+//  解析一个整数，等价于sscanf的"%d"，会先跳过空白
+//  失败返回0，此时*pout不被修改，成功返回解析结束的位置
+static inline const char* ScanInt(const char* p, const char* pend, int* pout)
+{
+    p = ScanSkipSpace(p, pend);
+
+    //  符号
+    int neg = 0;
+    if((p < pend) && ((*p == '-') || (*p == '+')))
+    {
+        neg = (*p == '-');
+        p++;
+    }
+
+    //  至少需要一个数字
+    if((p >= pend) || !ScanIsDigit(*p)) return 0;
+
+    //  转换数字，与sscanf一样超出范围时截断
+    int64_t val = 0;
+    while((p < pend) && ScanIsDigit(*p))
+    {
+        if(val < 0x100000000LL) val = (val * 10) + (*p - '0');
+        p++;
+    }
+
+    *pout = (int)(neg ? -val : val);
+    return p;
+}
+
+//  按"%f %f %f"的方式依次解析cnt个浮点数
+//  与sscanf一样遇到第一个失败即停止，返回成功解析的个数
+static inline int ScanFloats(const char* p, const char* pend, float* pout, int cnt)
+{
+    int i = 0;
+    for(i=0;i<cnt;i++)
+    {
+        p = ScanFloat(p, pend, &pout[i]);
+        if(p == 0) break;
+    }
+    return i;
+}
+
+//  按"%d/%d/%d %d/%d/%d %d/%d/%d"的方式解析平面的索引
+//  group_cnt为一组中用'/'分隔的整数个数，共group_num组
+//  与sscanf一样遇到第一个失败即停止，返回成功解析的个数
+static inline int ScanFaceInts(const char* p, const char* pend, int* pout, int group_cnt, int group_num)
+{
+    int re = 0;
+    int g = 0;
+    int k = 0;
+    for(g=0;g<group_num;g++)
+    {
+        for(k=0;k<group_cnt;k++)
+        {
+            //  组内的分隔符必须紧跟在前一个整数后面
+            if(k > 0)
+            {
+                if((p >= pend) || (*p != '/')) return re;
+                p++;
+            }
+
+            p = ScanInt(p, pend, &pout[re]);
+            if(p == 0) return re;
+            re++;
+        }
+    }
+    return re;
+}
+
+#endif
+
+//---------------------------------------------------------------------------
+//  文件结束
@@ -0,0 +1,146 @@
+/****************************************************************************
+
+    程序名称：解码和生成的速度测试
+    程序设计：rainhenry
+    程序版本：REV 0.1
+    创建日期：20261017
+
+    说明：
+        直接调用libobjtool，分别测量解码和生成C代码的时间，生成的C代码只写入内存，不受磁盘速度影响
+        每次运行输出一行JSON，可以追加到文件中长期跟踪，内存峰值为整个进程的ru_maxrss，
+        所以每种配置单独运行一次
+        make bench用objgen生成各种形状和平面格式的网格，依次测试每个生成等级
+
+        用法：objbench [--threads N] [--indexed] [--vcache] 生成等级 OBJ文件
+
+        输出：
+            {"file":"grid_300_v.obj","level":1,"threads":1,"indexed":0,"vcache":0,
+             "mb":6.007,"tris":180000,"parse_ms":36.944,"parse_mb_s":162.6,"parse_tris_s":4872176,
+             "emit_ms":209.502,"emit_mb":21.199,"emit_mb_s":101.2,"emit_tris_s":859182,"peak_rss_mb":38.2}
+
+    版本修订：
+        REV 0.1      rainhenry     20261017    创建文档
+        REV 0.2      rainhenry     20261017    内存峰值改用ObjStatsGetPeakRSS
+
+****************************************************************************/
+//---------------------------------------------------------------------------
+//  包含头文件
+#include "objtool.h"
+#include "mapfile.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <string>
+
+//  计算速度，时间为0时返回0
+static double GetRate(double val, double sec)
+{
+    return (sec > 0.0) ? (val / sec) : 0.0;
+}
+
+//---------------------------------------------------------------------------
+//  主函数
+//  用法：objbench [选项] 生成等级 OBJ文件
+int main(int argc, char** argv)
+{
+    SObjOption option;
+    ObjToolDefaultOption(&option);
+    option.verbose = 0;
+
+    //  分离选项参数和位置参数
+    const char* level_arg = 0;
+    const char* obj_arg = 0;
+    int i = 0;
+    for(i=1;i<argc;i++)
+    {
+        if((strcmp(argv[i], "--threads") == 0) && ((i + 1) < argc))
+        {
+            i++;
+            option.thread_num = atoi(argv[i]);
+            if(option.thread_num <= 0) option.thread_num = 1;
+        }
+        else if(strcmp(argv[i], "--indexed") == 0)
+        {
+            option.index_mode = 1;
+        }
+        else if(strcmp(argv[i], "--vcache") == 0)
+        {
+            option.index_mode = 1;
+            option.vcache_opt = 1;
+        }
+        else if((level_arg == 0) && (strncmp(argv[i], "--", 2) != 0))
+        {
+            level_arg = argv[i];
+        }
+        else if((obj_arg == 0) && (strncmp(argv[i], "--", 2) != 0))
+        {
+            obj_arg = argv[i];
+        }
+        else
+        {
+            printf("Unknown Option:%s\r\n", argv[i]);
+            return -1;
+        }
+    }
+    if(obj_arg == 0)
+    {
+        printf("usage: objbench [--threads N] [--indexed] [--vcache] level file.obj\r\n");
+        return -1;
+    }
+
+    SObjContext obj_ctx;
+    obj_ctx.gen_level = atoi(level_arg);
+    if((obj_ctx.gen_level != 1) && (obj_ctx.gen_level != 2) && (obj_ctx.gen_level != 3))
+    {
+        printf("Not Support Generate Level!!\r\n");
+        return -3;
+    }
+
+    //  读取文件的时间不计入解码
+    SMapFile obj_map;
+    if(MapFileOpen(obj_arg, &obj_map, option.use_mmap) != 0)
+    {
+        printf("File Open Error!!\r\n");
+        return -2;
+    }
+
+    //  解码
+    std::chrono::steady_clock::time_point t_parse = std::chrono::steady_clock::now();
+    ObjToolParseMemory(&obj_ctx, &option, obj_map.pdata, obj_map.size, 0);
+    std::chrono::steady_clock::time_point t_emit = std::chrono::steady_clock::now();
+    size_t obj_size = obj_map.size;
+    MapFileClose(&obj_map);
+
+    //  生成到内存
+    SObjOutput output;
+    int re = ObjToolGenData(&obj_ctx, &option, ObjToolGetName(obj_arg), &output);
+    std::chrono::steady_clock::time_point t_end = std::chrono::steady_clock::now();
+    if(re != 0)
+    {
+        printf("Gen C Code Error!!\r\n");
+        return -3;
+    }
+
+    double parse_sec = std::chrono::duration<double>(t_emit - t_parse).count();
+    double emit_sec = std::chrono::duration<double>(t_end - t_emit).count();
+    double mb = (double)obj_size / (1024.0 * 1024.0);
+    double emit_mb = (double)output.c_str.size() / (1024.0 * 1024.0);
+    double tris = (double)PlaneListSize(obj_ctx.PlaneList);
+
+    //  文件名不含路径
+    const char* pname = strrchr(obj_arg, '/');
+    pname = (pname == 0) ? obj_arg : (pname + 1);
+
+    printf("{\"file\":\"%s\",\"level\":%u,\"threads\":%d,\"indexed\":%d,\"vcache\":%d,"
+           "\"mb\":%.3f,\"tris\":%.0f,\"parse_ms\":%.3f,\"parse_mb_s\":%.1f,\"parse_tris_s\":%.0f,"
+           "\"emit_ms\":%.3f,\"emit_mb\":%.3f,\"emit_mb_s\":%.1f,\"emit_tris_s\":%.0f,\"peak_rss_mb\":%.1f}\n",
+           pname, obj_ctx.gen_level, option.thread_num, option.index_mode, option.vcache_opt,
+           mb, tris, parse_sec * 1000.0, GetRate(mb, parse_sec), GetRate(tris, parse_sec),
+           emit_sec * 1000.0, emit_mb, GetRate(emit_mb, emit_sec), GetRate(tris, emit_sec), ObjStatsGetPeakRSS()
+          );
+    return 0;
+}
+
+//---------------------------------------------------------------------------
+//  文件结束
@@ -0,0 +1,180 @@
+/****************************************************************************
+
+    程序名称：OBJ解码后的内存数据结构
+    程序设计：rainhenry
+    程序版本：REV 0.4
+    创建日期：20261016
+
+    说明：
+        从main.cpp中独立出来，供网格处理等模块共同使用
+
+    版本修订：
+        REV 0.1      rainhenry     20261016    创建文档
+        REV 0.2      rainhenry     20261016    原来的全局数据改为每个转换任务一份的SObjContext
+        REV 0.3      rainhenry     20261017    平面数据改为紧凑保存的SPlaneList，只保存生成等级用到的索引
+        REV 0.4      rainhenry     20261017    记录o/g/usemtl对应的平面范围
+
+****************************************************************************/
+//---------------------------------------------------------------------------
+//  防止重复包含
+#ifndef __objdata_h__
+#define __objdata_h__
+
+//---------------------------------------------------------------------------
+//  包含头文件
+#include <cstddef>
+#include <string>
+#include <vector>
+
+//  定义存放顶点数据的结构体
+typedef struct
+{
+    float x;
+    float y;
+    float z;
+}SVertex;
+
+//  定义存放UV坐标的数据的结构体
+typedef struct
+{
+    float u;
+    float v;
+}SUV;
+
+//  定义法线数据结构体
+typedef struct
+{
+    float x;
+    float y;
+    float z;
+}SVertexNormal;
+
+//  定义平面描述数据结构体
+//  为小于0的时候表示信息索引不可用，大于等于0的时候为有效索引
+typedef struct
+{
+    int point_index1;
+    int uv_index1;
+    int vn_index1;
+
+    int point_index2;
+    int uv_index2;
+    int vn_index2;
+
+    int point_index3;
+    int uv_index3;
+    int vn_index3;
+}SPlaneInfo;
+
+//  定义紧凑保存的平面数据
+//  每个点只保存用到的属性索引，依次为 顶点[、UV][、法线]，每个平面3个点
+//  生成等级为1时每个平面只有3个int，SPlaneInfo固定为9个
+//  不保存的属性读出时为-1，与索引无效的处理相同
+typedef struct
+{
+    int attr_cnt;                   //  每个点保存的索引个数，1~3
+    int attr_pos[3];                //  顶点、UV、法线的索引在一个点中的位置，不保存为-1
+    std::vector<int> index_vec;     //  全部平面的索引，每个平面attr_cnt*3个
+}SPlaneList;
+
+//  清空平面数据并设置保存的属性，顶点索引总是保存
+static inline void PlaneListInit(SPlaneList* plist, int has_uv, int has_vn)
+{
+    plist->attr_cnt = 1;
+    plist->attr_pos[0] = 0;
+    plist->attr_pos[1] = has_uv ? plist->attr_cnt++ : -1;
+    plist->attr_pos[2] = has_vn ? plist->attr_cnt++ : -1;
+    std::vector<int>().swap(plist->index_vec);
+}
+
+//  按生成等级设置保存的属性，2=保存UV  3=保存UV和法线
+static inline void PlaneListInitLevel(SPlaneList* plist, unsigned int gen_level)
+{
+    PlaneListInit(plist, gen_level >= 2, gen_level >= 3);
+}
+
+//  预先分配plane_cnt个平面的空间
+static inline void PlaneListReserve(SPlaneList* plist, size_t plane_cnt)
+{
+    plist->index_vec.reserve(plane_cnt * 3 * plist->attr_cnt);
+}
+
+//  平面个数
+static inline size_t PlaneListSize(const SPlaneList& list)
+{
+    if(list.index_vec.empty()) return 0;
+    return list.index_vec.size() / (3 * list.attr_cnt);
+}
+
+//  追加一个平面，不保存的属性忽略
+static inline void PlaneListPush(SPlaneList* plist, const SPlaneInfo& info)
+{
+    const int tmp_i[9] = {info.point_index1, info.uv_index1, info.vn_index1,
+                          info.point_index2, info.uv_index2, info.vn_index2,
+                          info.point_index3, info.uv_index3, info.vn_index3};
+    int k = 0;
+    for(k=0;k<9;k++)
+    {
+        if(plist->attr_pos[k % 3] >= 0) plist->index_vec.push_back(tmp_i[k]);
+    }
+}
+
+//  取出全部平面中第corner个点的索引，corner = 平面序号*3 + 点序号
+static inline void PlaneListGetCorner(const SPlaneList& list, size_t corner, int* ppoint, int* puv, int* pvn)
+{
+    const int* p = list.index_vec.data() + (corner * list.attr_cnt);
+    *ppoint = p[0];
+    *puv = (list.attr_pos[1] >= 0) ? p[list.attr_pos[1]] : -1;
+    *pvn = (list.attr_pos[2] >= 0) ? p[list.attr_pos[2]] : -1;
+}
+
+//  取出一个平面
+static inline void PlaneListGet(const SPlaneList& list, size_t plane, SPlaneInfo* pinfo)
+{
+    PlaneListGetCorner(list, (plane * 3) + 0, &pinfo->point_index1, &pinfo->uv_index1, &pinfo->vn_index1);
+    PlaneListGetCorner(list, (plane * 3) + 1, &pinfo->point_index2, &pinfo->uv_index2, &pinfo->vn_index2);
+    PlaneListGetCorner(list, (plane * 3) + 2, &pinfo->point_index3, &pinfo->uv_index3, &pinfo->vn_index3);
+}
+
+//  得到一个平面中的索引位置，slot = 点序号*3 + 属性序号(0=顶点 1=UV 2=法线)，不保存的属性返回0
+static inline int* PlaneListSlot(SPlaneList* plist, size_t plane, int slot)
+{
+    int pos = plist->attr_pos[slot % 3];
+    if(pos < 0) return 0;
+    return plist->index_vec.data() + ((((plane * 3) + (slot / 3)) * plist->attr_cnt) + pos);
+}
+
+//  o/g/usemtl记录的种类
+#define FACE_GROUP_OBJECT       0       //  o记录，同时清除g的名字
+#define FACE_GROUP_GROUP        1       //  g记录
+#define FACE_GROUP_MATERIAL     2       //  usemtl记录
+
+//  定义一条o/g/usemtl记录，从first_plane开始的平面属于该部件或材质，直到下一条同种记录
+typedef struct
+{
+    size_t first_plane;                         //  记录出现时已经解码的平面个数
+    int kind;                                   //  FACE_GROUP_XXX
+    std::string name;                           //  名字
+}SFaceGroup;
+
+//  定义一个OBJ文件转换任务的数据，批量转换时每个任务一份，互不影响
+typedef struct
+{
+    std::vector<SVertex> VertexVec;             //  顶点数据
+    std::vector<SUV> UVVec;                     //  UV坐标数据
+    std::vector<SVertexNormal> VertexNormalVec; //  法线数据
+    SPlaneList PlaneList;                       //  平面描述数据
+    std::string InternalName;                   //  OBJ内部对象名字
+    std::vector<SFaceGroup> FaceGroupVec;       //  o/g/usemtl记录，按出现的顺序
+
+    //  生成数据的个数
+    //  1=仅仅生成 顶点信息
+    //  2=生成顶点信息 + UV坐标信息
+    //  3=生成顶点信息 + UV坐标信息 + 法线信息
+    unsigned int gen_level;
+}SObjContext;
+
+#endif
+
+//---------------------------------------------------------------------------
+//  文件结束
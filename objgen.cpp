@@ -0,0 +1,322 @@
+/****************************************************************************
+
+    程序名称：生成测试用的OBJ文件
+    程序设计：rainhenry
+    程序版本：REV 0.1
+    创建日期：20261017
+
+    说明：
+        按程序生成任意大小的网格，用于测试解码和生成的速度，以及发现性能退化
+        形状：
+            grid    N*N个方格的起伏地面，2*N*N个三角形，相邻的三角形共享顶点
+            sphere  N条纬线、2N条经线的球面，4*N*N个三角形
+            soup    N个随机的三角形，互不共享顶点，索引输出时去重不能减少顶点
+        平面格式，对应DecodingOBJLines支持的3种斜杠个数：
+            v       f 1 2 3
+            vt      f 1/1 2/2 3/3
+            vtn     f 1/1/1 2/2/2 3/3/3
+            rel     f -3/-3/-3 -2/-2/-2 -1/-1/-1，负数的相对索引，平面紧跟在用到的记录后面
+        输出按块写入，内存占用与网格大小无关，可以生成上亿个三角形的文件
+        同样的参数和随机种子总是生成完全相同的文件
+
+        用法：objgen 形状 大小 格式 输出文件 [随机种子]
+
+    版本修订：
+        REV 0.1      rainhenry     20261017    创建文档
+
+****************************************************************************/
+//---------------------------------------------------------------------------
+//  包含头文件
+#include "cwriter.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <string>
+
+//  圆周率
+#define GEN_PI              3.14159265358979323846
+
+//  平面格式
+#define GEN_FMT_V           0
+#define GEN_FMT_VT          1
+#define GEN_FMT_VTN         2
+#define GEN_FMT_REL         3
+
+//  定义一个生成的点
+typedef struct
+{
+    float pos[3];
+    float uv[2];
+    float normal[3];
+}SGenDot;
+
+//  定义生成的参数
+typedef struct
+{
+    SCWriter* pw;           //  输出
+    int fmt;                //  平面格式GEN_FMT_XXX
+    uint64_t seed;          //  随机数状态
+    unsigned long long v_cnt;       //  已经写出的v记录个数
+    unsigned long long f_cnt;       //  已经写出的f记录个数
+}SGenInfo;
+
+//  得到一个64位随机数，xorshift64*
+static uint64_t GenRandom(SGenInfo* pinfo)
+{
+    pinfo->seed ^= pinfo->seed >> 12;
+    pinfo->seed ^= pinfo->seed << 25;
+    pinfo->seed ^= pinfo->seed >> 27;
+    return pinfo->seed * 0x2545F4914F6CDD1DULL;
+}
+
+//  得到[lo, hi)之间的随机浮点数
+static float GenRandomFloat(SGenInfo* pinfo, float lo, float hi)
+{
+    double val = (double)(GenRandom(pinfo) >> 11) / 9007199254740992.0;
+    return (float)(lo + ((hi - lo) * val));
+}
+
+//  写出一行的多个浮点数
+//  v 1.000000 2.000000 3.000000
+static void GenPutFloats(SGenInfo* pinfo, const char* phead, const float* pval, int cnt)
+{
+    CWriterPutStr(pinfo->pw, phead);
+    int i = 0;
+    for(i=0;i<cnt;i++)
+    {
+        CWriterPut(pinfo->pw, " ", 1);
+        CWriterPutFloat(pinfo->pw, pval[i]);
+    }
+    CWriterPut(pinfo->pw, "\n", 1);
+}
+
+//  写出一个点的v/vt/vn记录，格式不需要的属性不写出
+static void GenPutDot(SGenInfo* pinfo, const SGenDot& dot)
+{
+    GenPutFloats(pinfo, "v", dot.pos, 3);
+    if((pinfo->fmt == GEN_FMT_VT) || (pinfo->fmt == GEN_FMT_VTN) || (pinfo->fmt == GEN_FMT_REL)) GenPutFloats(pinfo, "vt", dot.uv, 2);
+    if((pinfo->fmt == GEN_FMT_VTN) || (pinfo->fmt == GEN_FMT_REL))  GenPutFloats(pinfo, "vn", dot.normal, 3);
+    pinfo->v_cnt++;
+}
+
+//  写出一个三角形，索引为0基序的点序号，每个点的v/vt/vn序号相同
+static void GenPutFace(SGenInfo* pinfo, unsigned long long a, unsigned long long b, unsigned long long c)
+{
+    unsigned long long idx[3] = {a, b, c};
+    CWriterPut(pinfo->pw, "f", 1);
+    int k = 0;
+    for(k=0;k<3;k++)
+    {
+        CWriterPut(pinfo->pw, " ", 1);
+
+        //  相对索引，-1为到目前为止的最后一个记录
+        if(pinfo->fmt == GEN_FMT_REL)
+        {
+            long long rel = (long long)idx[k] - (long long)pinfo->v_cnt;
+            CWriterPutInt(pinfo->pw, rel);
+            CWriterPut(pinfo->pw, "/", 1);
+            CWriterPutInt(pinfo->pw, rel);
+            CWriterPut(pinfo->pw, "/", 1);
+            CWriterPutInt(pinfo->pw, rel);
+            continue;
+        }
+
+        unsigned long long val = idx[k] + 1;
+        CWriterPutUInt(pinfo->pw, val);
+        if((pinfo->fmt == GEN_FMT_VT) || (pinfo->fmt == GEN_FMT_VTN))
+        {
+            CWriterPut(pinfo->pw, "/", 1);
+            CWriterPutUInt(pinfo->pw, val);
+        }
+        if(pinfo->fmt == GEN_FMT_VTN)
+        {
+            CWriterPut(pinfo->pw, "/", 1);
+            CWriterPutUInt(pinfo->pw, val);
+        }
+    }
+    CWriterPut(pinfo->pw, "\n", 1);
+    pinfo->f_cnt++;
+}
+
+//  起伏地面上一点的数据，高度为两个方向正弦波的乘积
+static SGenDot GenGridDot(unsigned long long n, unsigned long long x, unsigned long long y)
+{
+    SGenDot dot;
+    double fx = (double)x / (double)n;
+    double fy = (double)y / (double)n;
+    double k = 4.0 * GEN_PI;
+    double h = 0.05 * sin(k * fx) * sin(k * fy);
+    double dx = 0.05 * k * cos(k * fx) * sin(k * fy);
+    double dy = 0.05 * k * sin(k * fx) * cos(k * fy);
+    double len = sqrt((dx * dx) + (dy * dy) + 1.0);
+    dot.pos[0] = (float)(fx - 0.5);
+    dot.pos[1] = (float)h;
+    dot.pos[2] = (float)(fy - 0.5);
+    dot.uv[0] = (float)fx;
+    dot.uv[1] = (float)fy;
+    dot.normal[0] = (float)(-dx / len);
+    dot.normal[1] = (float)(1.0 / len);
+    dot.normal[2] = (float)(-dy / len);
+    return dot;
+}
+
+//  生成起伏地面，相对索引时每行的点紧跟在用到它的平面前面
+static void GenGrid(SGenInfo* pinfo, unsigned long long n)
+{
+    unsigned long long x = 0;
+    unsigned long long y = 0;
+    for(x=0;x<=n;x++)
+    {
+        GenPutDot(pinfo, GenGridDot(n, x, 0));
+    }
+    for(y=1;y<=n;y++)
+    {
+        for(x=0;x<=n;x++)
+        {
+            GenPutDot(pinfo, GenGridDot(n, x, y));
+        }
+
+        //  上一行与这一行之间的方格
+        unsigned long long row0 = (y - 1) * (n + 1);
+        unsigned long long row1 = y * (n + 1);
+        for(x=0;x<n;x++)
+        {
+            GenPutFace(pinfo, row0 + x, row1 + x, row0 + x + 1);
+            GenPutFace(pinfo, row0 + x + 1, row1 + x, row1 + x + 1);
+        }
+    }
+}
+
+//  生成球面，两极的点也按经线重复，保证UV连续
+static void GenSphere(SGenInfo* pinfo, unsigned long long n)
+{
+    unsigned long long seg = n * 2;
+    unsigned long long lat = 0;
+    unsigned long long lon = 0;
+    for(lat=0;lat<=n;lat++)
+    {
+        double theta = GEN_PI * (double)lat / (double)n;
+        for(lon=0;lon<=seg;lon++)
+        {
+            double phi = 2.0 * GEN_PI * (double)lon / (double)seg;
+            SGenDot dot;
+            dot.normal[0] = (float)(sin(theta) * cos(phi));
+            dot.normal[1] = (float)cos(theta);
+            dot.normal[2] = (float)(sin(theta) * sin(phi));
+            dot.pos[0] = dot.normal[0];
+            dot.pos[1] = dot.normal[1];
+            dot.pos[2] = dot.normal[2];
+            dot.uv[0] = (float)((double)lon / (double)seg);
+            dot.uv[1] = (float)((double)lat / (double)n);
+            GenPutDot(pinfo, dot);
+        }
+        if(lat == 0) continue;
+
+        //  上一条纬线与这一条纬线之间的四边形
+        unsigned long long row0 = (lat - 1) * (seg + 1);
+        unsigned long long row1 = lat * (seg + 1);
+        for(lon=0;lon<seg;lon++)
+        {
+            GenPutFace(pinfo, row0 + lon, row0 + lon + 1, row1 + lon);
+            GenPutFace(pinfo, row0 + lon + 1, row1 + lon + 1, row1 + lon);
+        }
+    }
+}
+
+//  生成随机三角形，每个三角形有自己的3个点
+static void GenSoup(SGenInfo* pinfo, unsigned long long n)
+{
+    unsigned long long i = 0;
+    int k = 0;
+    for(i=0;i<n;i++)
+    {
+        for(k=0;k<3;k++)
+        {
+            SGenDot dot;
+            dot.pos[0] = GenRandomFloat(pinfo, -100.0f, 100.0f);
+            dot.pos[1] = GenRandomFloat(pinfo, -100.0f, 100.0f);
+            dot.pos[2] = GenRandomFloat(pinfo, -100.0f, 100.0f);
+            dot.uv[0] = GenRandomFloat(pinfo, 0.0f, 1.0f);
+            dot.uv[1] = GenRandomFloat(pinfo, 0.0f, 1.0f);
+
+            //  随机方向的单位向量
+            float z = GenRandomFloat(pinfo, -1.0f, 1.0f);
+            float phi = GenRandomFloat(pinfo, 0.0f, (float)(2.0 * GEN_PI));
+            float r = sqrtf(1.0f - (z * z));
+            dot.normal[0] = r * cosf(phi);
+            dot.normal[1] = r * sinf(phi);
+            dot.normal[2] = z;
+            GenPutDot(pinfo, dot);
+        }
+        GenPutFace(pinfo, (i * 3) + 0, (i * 3) + 1, (i * 3) + 2);
+    }
+}
+
+//---------------------------------------------------------------------------
+//  主函数
+//  用法：objgen 形状 大小 格式 输出文件 [随机种子]
+int main(int argc, char** argv)
+{
+    if((argc != 5) && (argc != 6))
+    {
+        printf("usage: objgen grid|sphere|soup N v|vt|vtn|rel out.obj [seed]\r\n");
+        return -1;
+    }
+
+    //  形状和大小
+    const char* pshape = argv[1];
+    unsigned long long n = strtoull(argv[2], 0, 10);
+    if((n == 0) || ((strcmp(pshape, "grid") != 0) && (strcmp(pshape, "sphere") != 0) && (strcmp(pshape, "soup") != 0)))
+    {
+        printf("Not Support Shape:%s %s\r\n", argv[1], argv[2]);
+        return -1;
+    }
+
+    //  平面格式
+    SGenInfo info;
+    if(strcmp(argv[3], "v") == 0)           info.fmt = GEN_FMT_V;
+    else if(strcmp(argv[3], "vt") == 0)     info.fmt = GEN_FMT_VT;
+    else if(strcmp(argv[3], "vtn") == 0)    info.fmt = GEN_FMT_VTN;
+    else if(strcmp(argv[3], "rel") == 0)    info.fmt = GEN_FMT_REL;
+    else
+    {
+        printf("Not Support Face Format:%s\r\n", argv[3]);
+        return -1;
+    }
+    info.seed = (argc == 6) ? strtoull(argv[5], 0, 10) : 1;
+    if(info.seed == 0) info.seed = 1;
+    info.v_cnt = 0;
+    info.f_cnt = 0;
+
+    //  与Blender导出的文件相同，6位小数
+    SCWriter writer;
+    if(CWriterOpen(&writer, argv[4], FLOAT_FMT_FIXED, FLOAT_DEFAULT_PRECISION) != 0)
+    {
+        printf("File Open Error:%s\r\n", argv[4]);
+        return -2;
+    }
+    info.pw = &writer;
+
+    //  文件头
+    std::string head_str = "# objgen ";
+    head_str += std::string(argv[1]) + " " + argv[2] + " " + argv[3] + "\n";
+    head_str += "o " + std::string(argv[1]) + "\n";
+    CWriterPutStr(&writer, head_str);
+
+    if(strcmp(pshape, "grid") == 0)         GenGrid(&info, n);
+    else if(strcmp(pshape, "sphere") == 0)  GenSphere(&info, n);
+    else                                    GenSoup(&info, n);
+
+    if(CWriterClose(&writer) != 0)
+    {
+        printf("File Write Error:%s\r\n", argv[4]);
+        return -2;
+    }
+    printf("%s: %llu v, %llu f, %llu bytes\r\n", argv[4], info.v_cnt, info.f_cnt, writer.total);
+    return 0;
+}
+
+//---------------------------------------------------------------------------
+//  文件结束
@@ -0,0 +1,195 @@
+/****************************************************************************
+
+    程序名称：转换过程的统计
+    程序设计：rainhenry
+    程序版本：REV 0.1
+    创建日期：20261017
+
+    版本修订：
+        REV 0.1      rainhenry     20261017    创建文档
+
+****************************************************************************/
+//---------------------------------------------------------------------------
+//  包含头文件
+#include "objstats.h"
+#include <cstdio>
+#include <sys/resource.h>
+
+//  每种记录的名字
+static const char* const stat_kind_name[STAT_KIND_NUM] = {"v", "vt", "vn", "f", "other"};
+
+//  清空统计
+void ObjStatsReset(SObjStats* pstats)
+{
+    pstats->file.clear();
+    pstats->gen_level = 0;
+    pstats->up_to_date = 0;
+    pstats->open_ms = 0.0;
+    pstats->prescan_ms = 0.0;
+    pstats->parse_ms = 0.0;
+    pstats->merge_ms = 0.0;
+    pstats->validate_ms = 0.0;
+    pstats->emit_ms = 0.0;
+    pstats->write_ms = 0.0;
+    pstats->total_ms = 0.0;
+    int i = 0;
+    for(i=0;i<STAT_KIND_NUM;i++)
+    {
+        pstats->kind_ms[i] = 0.0;
+        pstats->kind_cnt[i] = 0;
+        pstats->kind_bytes[i] = 0;
+    }
+    pstats->input_bytes = 0;
+    pstats->face_cnt = 0;
+    pstats->unsupported_face_cnt = 0;
+    pstats->invalid_face_cnt = 0;
+    pstats->missing_uv_cnt = 0;
+    pstats->missing_vn_cnt = 0;
+    pstats->unique_vertex_cnt = 0;
+    pstats->dup_vertex_cnt = 0;
+    pstats->emit_bytes = 0;
+    pstats->bytes_written = 0;
+    pstats->peak_rss_mb = 0.0;
+}
+
+//  当前时间，用于计算各阶段的时间
+std::chrono::steady_clock::time_point ObjStatsNow(void)
+{
+    return std::chrono::steady_clock::now();
+}
+
+//  从t_start到现在的时间，单位ms
+double ObjStatsElapsedMs(std::chrono::steady_clock::time_point t_start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t_start).count();
+}
+
+//  得到进程内存使用的峰值，单位MB
+double ObjStatsGetPeakRSS(void)
+{
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) != 0) return 0.0;
+    return (double)usage.ru_maxrss / 1024.0;
+}
+
+//  表格一行中显示的列
+#define STAT_ROW_MS             0       //  只有时间
+#define STAT_ROW_BYTES          1       //  时间和字节数
+#define STAT_ROW_LINES          2       //  时间、行数和字节数
+
+//  追加一行表格
+//      v              12.345 ms          1234 lines          56789 bytes
+static void StatsPutRow(std::string* pstr, const char* pname, double ms, int cols, unsigned long long cnt, unsigned long long bytes)
+{
+    char tmp_str[256];
+    snprintf(tmp_str, sizeof(tmp_str), "  %-12s %12.3f ms", pname, ms);
+    *pstr += tmp_str;
+    if(cols == STAT_ROW_LINES)
+    {
+        snprintf(tmp_str, sizeof(tmp_str), " %13llu lines %14llu bytes", cnt, bytes);
+        *pstr += tmp_str;
+    }
+    else if(cols == STAT_ROW_BYTES)
+    {
+        snprintf(tmp_str, sizeof(tmp_str), " %19s %14llu bytes", "", bytes);
+        *pstr += tmp_str;
+    }
+    *pstr += "\r\n";
+}
+
+//  格式化为表格，每行以\r\n结束
+std::string ObjStatsGetTable(const SObjStats* pstats)
+{
+    std::string re_str;
+    char tmp_str[256];
+    snprintf(tmp_str, sizeof(tmp_str), "Stats:%s  Level = %u%s\r\n", pstats->file.c_str(), pstats->gen_level, pstats->up_to_date ? "  Up To Date" : "");
+    re_str += tmp_str;
+
+    StatsPutRow(&re_str, "open", pstats->open_ms, STAT_ROW_BYTES, 0, pstats->input_bytes);
+    if(pstats->prescan_ms > 0.0) StatsPutRow(&re_str, "prescan", pstats->prescan_ms, STAT_ROW_MS, 0, 0);
+    StatsPutRow(&re_str, "parse", pstats->parse_ms, STAT_ROW_MS, 0, 0);
+    int i = 0;
+    for(i=0;i<STAT_KIND_NUM;i++)
+    {
+        std::string name_str = std::string("  ") + stat_kind_name[i];
+        StatsPutRow(&re_str, name_str.c_str(), pstats->kind_ms[i], STAT_ROW_LINES, pstats->kind_cnt[i], pstats->kind_bytes[i]);
+    }
+    if(pstats->merge_ms > 0.0) StatsPutRow(&re_str, "merge", pstats->merge_ms, STAT_ROW_MS, 0, 0);
+    StatsPutRow(&re_str, "validate", pstats->validate_ms, STAT_ROW_MS, 0, 0);
+    StatsPutRow(&re_str, "emit", pstats->emit_ms, STAT_ROW_BYTES, 0, pstats->emit_bytes);
+    StatsPutRow(&re_str, "write", pstats->write_ms, STAT_ROW_BYTES, 0, pstats->bytes_written);
+    StatsPutRow(&re_str, "total", pstats->total_ms, STAT_ROW_MS, 0, 0);
+
+    snprintf(tmp_str, sizeof(tmp_str), "  faces %llu, unsupported %llu, invalid %llu, missing uv %llu, missing normal %llu\r\n",
+             pstats->face_cnt, pstats->unsupported_face_cnt, pstats->invalid_face_cnt, pstats->missing_uv_cnt, pstats->missing_vn_cnt);
+    re_str += tmp_str;
+    snprintf(tmp_str, sizeof(tmp_str), "  vertices unique %llu, duplicated %llu, peak RSS %.1f MB\r\n",
+             pstats->unique_vertex_cnt, pstats->dup_vertex_cnt, pstats->peak_rss_mb);
+    re_str += tmp_str;
+    return re_str;
+}
+
+//  JSON字符串的转义
+static std::string StatsJsonEscape(const std::string& in_str)
+{
+    std::string re_str;
+    size_t i = 0;
+    for(i=0;i<in_str.size();i++)
+    {
+        unsigned char ch = (unsigned char)in_str.at(i);
+        if((ch == '"') || (ch == '\\'))
+        {
+            re_str += '\\';
+            re_str += (char)ch;
+        }
+        else if(ch < 0x20)
+        {
+            char tmp_str[8];
+            snprintf(tmp_str, sizeof(tmp_str), "\\u%04x", ch);
+            re_str += tmp_str;
+        }
+        else
+        {
+            re_str += (char)ch;
+        }
+    }
+    return re_str;
+}
+
+//  格式化为一行JSON，不含换行
+std::string ObjStatsGetJson(const SObjStats* pstats)
+{
+    std::string re_str;
+    char tmp_str[512];
+    re_str += "{\"file\":\"" + StatsJsonEscape(pstats->file) + "\"";
+    snprintf(tmp_str, sizeof(tmp_str),
+             ",\"level\":%u,\"up_to_date\":%d,\"open_ms\":%.3f,\"prescan_ms\":%.3f,\"parse_ms\":%.3f,\"merge_ms\":%.3f,"
+             "\"validate_ms\":%.3f,\"emit_ms\":%.3f,\"write_ms\":%.3f,\"total_ms\":%.3f",
+             pstats->gen_level, pstats->up_to_date, pstats->open_ms, pstats->prescan_ms, pstats->parse_ms, pstats->merge_ms,
+             pstats->validate_ms, pstats->emit_ms, pstats->write_ms, pstats->total_ms);
+    re_str += tmp_str;
+
+    //  "records":{"v":{"ms":1.0,"lines":8,"bytes":200},...}
+    re_str += ",\"records\":{";
+    int i = 0;
+    for(i=0;i<STAT_KIND_NUM;i++)
+    {
+        snprintf(tmp_str, sizeof(tmp_str), "%s\"%s\":{\"ms\":%.3f,\"lines\":%llu,\"bytes\":%llu}",
+                 (i > 0) ? "," : "", stat_kind_name[i], pstats->kind_ms[i], pstats->kind_cnt[i], pstats->kind_bytes[i]);
+        re_str += tmp_str;
+    }
+    re_str += "}";
+
+    snprintf(tmp_str, sizeof(tmp_str),
+             ",\"input_bytes\":%llu,\"faces\":%llu,\"unsupported_faces\":%llu,\"invalid_faces\":%llu,"
+             "\"missing_uv\":%llu,\"missing_normal\":%llu,\"unique_vertices\":%llu,\"dup_vertices\":%llu,"
+             "\"emit_bytes\":%llu,\"bytes_written\":%llu,\"peak_rss_mb\":%.1f}",
+             pstats->input_bytes, pstats->face_cnt, pstats->unsupported_face_cnt, pstats->invalid_face_cnt,
+             pstats->missing_uv_cnt, pstats->missing_vn_cnt, pstats->unique_vertex_cnt, pstats->dup_vertex_cnt,
+             pstats->emit_bytes, pstats->bytes_written, pstats->peak_rss_mb);
+    re_str += tmp_str;
+    return re_str;
+}
+
+//---------------------------------------------------------------------------
+//  文件结束
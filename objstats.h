@@ -0,0 +1,95 @@
+/****************************************************************************
+
+    程序名称：转换过程的统计
+    程序设计：rainhenry
+    程序版本：REV 0.1
+    创建日期：20261017
+
+    说明：
+        SObjOption.pstats不为0时，解码和生成的过程中记录每个阶段的时间和各种计数，为0时不统计
+        解码时间按记录的种类分开统计，只在相邻两行的种类不同时读取一次时钟，
+        连续的同种记录只计数，统计本身几乎不影响解码速度
+        多线程解码时每种记录的时间为各线程的时间之和，可能大于解码的总时间
+        流式生成时平面的写出在解析f记录的同时进行，写出时间计入f记录的解码时间
+        结果可以格式化为表格或者一行JSON，用于按资源汇总转换的开销
+
+    版本修订：
+        REV 0.1      rainhenry     20261017    创建文档
+
+****************************************************************************/
+//---------------------------------------------------------------------------
+//  防止重复包含
+#ifndef __objstats_h__
+#define __objstats_h__
+
+//---------------------------------------------------------------------------
+//  包含头文件
+#include <chrono>
+#include <string>
+
+//  记录的种类
+#define STAT_KIND_V             0       //  v
+#define STAT_KIND_VT            1       //  vt
+#define STAT_KIND_VN            2       //  vn
+#define STAT_KIND_F             3       //  f
+#define STAT_KIND_OTHER         4       //  注释、o、g、usemtl、s、空行等
+#define STAT_KIND_NUM           5
+
+//  定义一个OBJ文件转换过程的统计，时间单位ms
+typedef struct
+{
+    std::string file;                           //  输入文件
+    unsigned int gen_level;                     //  生成等级
+    int up_to_date;                             //  增量生成时输出为最新，跳过了解码和生成
+
+    //  各阶段的时间
+    double open_ms;                             //  打开和映射输入文件
+    double prescan_ms;                          //  预扫描记录个数，流式生成时为单独的一遍读取，多线程时为各线程之和
+    double parse_ms;                            //  解码，流式生成时不含预扫描，从内存解码时含各分块的预扫描
+    double merge_ms;                            //  多线程解码时合并各分块
+    double validate_ms;                         //  检查索引和统计重复的顶点
+    double emit_ms;                             //  生成数据，不含写文件
+    double write_ms;                            //  写文件、替换增量生成的临时文件、写头文件
+    double total_ms;                            //  从打开文件到全部完成
+
+    //  每种记录的解码时间、行数、字节数
+    double kind_ms[STAT_KIND_NUM];
+    unsigned long long kind_cnt[STAT_KIND_NUM];
+    unsigned long long kind_bytes[STAT_KIND_NUM];
+
+    //  计数
+    unsigned long long input_bytes;             //  输入文件的字节数
+    unsigned long long face_cnt;                //  解码得到的平面
+    unsigned long long unsupported_face_cnt;    //  格式不支持被忽略的f记录
+    unsigned long long invalid_face_cnt;        //  顶点索引无效的平面，存在时生成失败
+    unsigned long long missing_uv_cnt;          //  有UV数据时，UV索引缺失或无效的点
+    unsigned long long missing_vn_cnt;          //  有法线数据时，法线索引缺失或无效的点
+    unsigned long long unique_vertex_cnt;       //  (v,vt,vn)去重后的顶点
+    unsigned long long dup_vertex_cnt;          //  与前面的点重复的点
+    unsigned long long emit_bytes;              //  生成的数据字节数
+    unsigned long long bytes_written;           //  写入文件的字节数，含头文件
+    double peak_rss_mb;                         //  进程内存使用的峰值，单位MB
+}SObjStats;
+
+//  清空统计
+void ObjStatsReset(SObjStats* pstats);
+
+//  当前时间，用于计算各阶段的时间
+std::chrono::steady_clock::time_point ObjStatsNow(void);
+
+//  从t_start到现在的时间，单位ms
+double ObjStatsElapsedMs(std::chrono::steady_clock::time_point t_start);
+
+//  得到进程内存使用的峰值，单位MB
+double ObjStatsGetPeakRSS(void);
+
+//  格式化为表格，每行以\r\n结束
+std::string ObjStatsGetTable(const SObjStats* pstats);
+
+//  格式化为一行JSON，不含换行
+std::string ObjStatsGetJson(const SObjStats* pstats);
+
+#endif
+
+//---------------------------------------------------------------------------
+//  文件结束
@@ -0,0 +1,3260 @@
+/****************************************************************************
+
+    程序名称：OBJ文件解码和生成的库接口(libobjtool)
+    程序设计：rainhenry
+    程序版本：REV 1.0
+    创建日期：20261017
+
+    版本修订：
+        REV 0.1      rainhenry     20261017    创建文档，解码和生成的功能从main.cpp中独立出来
+        REV 0.2      rainhenry     20261017    增加预扫描、按块读取的解码和流式生成，乱序的平面写入临时文件
+        REV 0.3      rainhenry     20261017    增加各阶段的时间和计数的统计
+        REV 0.4      rainhenry     20261017    增加meshlet的输出
+        REV 0.5      rainhenry     20261017    解码o/g/usemtl记录，按材质和部件排序输出绘制批次
+        REV 0.6      rainhenry     20261017    增加SAH包围盒层次(BVH)的输出
+        REV 0.7      rainhenry     20261017    增加QEM简化的多级细节(LOD)输出
+        REV 0.8      rainhenry     20261017    没有法线时多线程生成平滑法线，增加切线空间的输出
+        REV 0.9      rainhenry     20261017    在顶点缓存的顺序上按遮挡关系重新排列三角形，报告估计的过度绘制
+        REV 1.0      rainhenry     20261017    增加C++17头文件的输出，顶点结构体、constexpr的数据、数量和包围盒
+
+****************************************************************************/
+//---------------------------------------------------------------------------
+//  包含头文件
+#include "objtool.h"
+#include "mapfile.h"
+#include "numscan.h"
+#include "hashcache.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <thread>
+#include <algorithm>
+#include <vector>
+#include <map>
+#include <sys/stat.h>
+
+//  解码调试开关
+#define DEBUG_DECODE       0
+
+//  设置选项的默认值，默认的输出与3dobjtool不带选项时相同
+void ObjToolDefaultOption(SObjOption* popt)
+{
+    popt->use_mmap = 1;
+    popt->thread_num = 1;
+    popt->verbose = 1;
+    popt->float_fmt = FLOAT_FMT_FIXED;
+    popt->float_precision = -1;
+    popt->index_mode = 0;
+    popt->vcache_opt = 0;
+    popt->vfetch_opt = 0;
+    popt->pos_fmt = ATTR_FMT_AUTO;
+    popt->uv_fmt = ATTR_FMT_AUTO;
+    popt->normal_fmt = ATTR_FMT_AUTO;
+    popt->max_error = -1.0;
+    popt->layout_vec.clear();
+    popt->strip_mode = -1;
+    popt->meshlet_vertex = 0;
+    popt->meshlet_tri = 0;
+    popt->draw_batch = 0;
+    popt->bvh_leaf = 0;
+    popt->lod_vec.clear();
+    popt->lod_target = LOD_TARGET_RATIO;
+    popt->normal_crease = -1.0;
+    popt->tangent = 0;
+    popt->overdraw_threshold = -1.0;
+    popt->out_mode = OUT_MODE_C;
+    popt->elf_arch = ELF_ARCH_HOST;
+    popt->keep_unchanged = 0;
+    popt->pstats = 0;
+}
+
+//  得到[pbegin, pend)范围的字符中有多少个指定的符号
+static int GetStringCountChar(const char* pbegin, const char* pend, char ch)
+{
+    int re = 0;
+    const char* p = pbegin;
+    for(p=pbegin;p<pend;p++)
+    {
+        if(*p == ch)
+        {
+            re++;
+        }
+    }
+    return re;
+}
+
+//  从一个字符串中删除回车和换行
+static std::string DeleteNR(std::string in_str)
+{
+    int len = in_str.size();
+    int i=0;
+    for(i=0;i<len;i++)
+    {
+        if((in_str.at(i) == '\r') || (in_str.at(i) == '\n'))
+        {
+            in_str.erase(in_str.begin() + i);
+            i--;
+            len--;
+        }
+    }
+    return in_str;
+}
+
+//  定义分块解码的结果
+//  每个分块独立解码到自己的容器中，最后按照各分块的记录数前缀和合并
+typedef struct
+{
+    std::vector<SVertex> vertex_vec;            //  分块内的顶点数据
+    std::vector<SUV> uv_vec;                    //  分块内的UV数据
+    std::vector<SVertexNormal> vn_vec;          //  分块内的法线数据
+    SPlaneList plane_list;                      //  分块内的平面数据
+
+    //  相对索引(负数)在分块内只能确定相对分块起点的位置
+    //  此处登记需要在合并时加上前面分块记录数的位置，值为 平面序号*9 + 索引序号
+    std::vector<size_t> fixup_vec;
+
+    //  有回调时，引用了后面记录的平面，在全部解析完成后回调
+    //  按顺序回调时，从第一个这样的平面开始全部写入临时文件pspill，临时文件创建失败时放在defer_vec中
+    std::vector<SPlaneInfo> defer_vec;
+    int spill;                                  //  是否已经开始延后回调
+    FILE* pspill;                               //  延后回调的平面的临时文件
+
+    int v_cnt;                                  //  分块内v记录的个数
+    int vt_cnt;                                 //  分块内vt记录的个数，与是否保存无关
+    int vn_cnt;                                 //  分块内vn记录的个数，与是否保存无关
+    int line_cnt;                               //  分块内f记录的个数
+    int unsupported_cnt;                        //  分块内格式不支持被忽略的f记录的个数
+
+    int has_name;                               //  分块内是否出现过o记录
+    std::string name;                           //  分块内最后一个o记录的名字
+    std::vector<SFaceGroup> group_vec;          //  分块内的o/g/usemtl记录，first_plane为分块内的平面序号
+
+    //  统计每种记录的时间，同种记录连续出现时只在开始和结束时读取时钟
+    int stat_on;                                //  是否统计
+    int run_kind;                               //  当前连续出现的记录种类，小于0表示没有
+    std::chrono::steady_clock::time_point run_start;    //  当前种类开始的时间
+    double kind_ms[STAT_KIND_NUM];
+    unsigned long long kind_cnt[STAT_KIND_NUM];
+    unsigned long long kind_bytes[STAT_KIND_NUM];
+    double prescan_ms;                          //  分块的预扫描时间
+}SObjChunk;
+
+//  登记一条o/g/usemtl记录，pname为名字的开始，去掉前后的空白
+static void AddFaceGroup(SObjChunk* pchunk, int kind, const char* pname, const char* peol)
+{
+    while((pname < peol) && ((*pname == ' ') || (*pname == '\t'))) pname++;
+    while((peol > pname) && ((peol[-1] == ' ') || (peol[-1] == '\t') || (peol[-1] == '\r'))) peol--;
+    SFaceGroup tmp_group;
+    tmp_group.first_plane = PlaneListSize(pchunk->plane_list);
+    tmp_group.kind = kind;
+    tmp_group.name = DeleteNR(std::string(pname, peol - pname));
+    pchunk->group_vec.push_back(tmp_group);
+}
+
+//  回调延后的平面时每次从临时文件读取的个数
+#define SPILL_READ_PLANE   4096
+
+//  多线程解码时每个分块的最小字节数，太小的文件不值得拆分
+#define DECODE_MIN_CHUNK   (1024*1024)
+
+//  按序号获取平面描述中的索引，slot = 点序号*3 + 属性序号(0=顶点 1=UV 2=法线)
+static int* GetPlaneIndexSlot(SPlaneInfo* pinfo, int slot)
+{
+    switch(slot)
+    {
+        case 0:  return &pinfo->point_index1;
+        case 1:  return &pinfo->uv_index1;
+        case 2:  return &pinfo->vn_index1;
+        case 3:  return &pinfo->point_index2;
+        case 4:  return &pinfo->uv_index2;
+        case 5:  return &pinfo->vn_index2;
+        case 6:  return &pinfo->point_index3;
+        case 7:  return &pinfo->uv_index3;
+        default: return &pinfo->vn_index3;
+    }
+}
+
+//  按平面的索引取出三角形的数据并回调，索引无效的属性为0
+static void DeliverTriangle(const SObjVisitor* pvisitor, const std::vector<SVertex>& vertex_vec, const std::vector<SUV>& uv_vec, const std::vector<SVertexNormal>& vn_vec, const SPlaneInfo& info)
+{
+    SObjTriangle tri;
+    tri.valid = 1;
+    tri.has_uv = 1;
+    tri.has_normal = 1;
+    tri.valid_mask = 0;
+    tri.info = info;
+
+    SPlaneInfo tmp_info = info;
+    int k = 0;
+    for(k=0;k<3;k++)
+    {
+        int point_index = *GetPlaneIndexSlot(&tmp_info, (k * 3) + 0);
+        int uv_index = *GetPlaneIndexSlot(&tmp_info, (k * 3) + 1);
+        int vn_index = *GetPlaneIndexSlot(&tmp_info, (k * 3) + 2);
+
+        SVertex tmp_v = {0.0f, 0.0f, 0.0f};
+        SUV tmp_uv = {0.0f, 0.0f};
+        SVertexNormal tmp_vn = {0.0f, 0.0f, 0.0f};
+        if((point_index >= 0) && ((size_t)point_index < vertex_vec.size())) tmp_v = vertex_vec[point_index];
+        else                                                                 tri.valid = 0;
+        if((uv_index >= 0) && ((size_t)uv_index < uv_vec.size())) tmp_uv = uv_vec[uv_index];
+        else                                                       tri.has_uv = 0;
+        if((vn_index >= 0) && ((size_t)vn_index < vn_vec.size())) tmp_vn = vn_vec[vn_index];
+        else                                                       tri.has_normal = 0;
+        if((point_index >= 0) && ((size_t)point_index < vertex_vec.size())) tri.valid_mask |= 1 << ((k * 3) + 0);
+        if((uv_index >= 0) && ((size_t)uv_index < uv_vec.size()))          tri.valid_mask |= 1 << ((k * 3) + 1);
+        if((vn_index >= 0) && ((size_t)vn_index < vn_vec.size()))          tri.valid_mask |= 1 << ((k * 3) + 2);
+        tri.pos[k] = tmp_v;
+        tri.uv[k] = tmp_uv;
+        tri.normal[k] = tmp_vn;
+    }
+    pvisitor->pfunc(&tri, pvisitor->puser);
+}
+
+//  判断平面是否引用了后面才出现的记录
+static int IsPlaneForward(SObjChunk* pchunk, SPlaneInfo* pinfo)
+{
+    int slot = 0;
+    for(slot=0;slot<9;slot++)
+    {
+        int attr = slot % 3;
+        int local_cnt = (attr == 0) ? pchunk->v_cnt : ((attr == 1) ? pchunk->vt_cnt : pchunk->vn_cnt);
+        if(*GetPlaneIndexSlot(pinfo, slot) >= local_cnt) return 1;
+    }
+    return 0;
+}
+
+//  延后回调一个平面，写入临时文件，临时文件不可用时放在内存中
+static void SpillPlane(SObjChunk* pchunk, const SPlaneInfo& info)
+{
+    if((pchunk->pspill != 0) && (fwrite(&info, sizeof(info), 1, pchunk->pspill) == 1)) return;
+    pchunk->defer_vec.push_back(info);
+}
+
+//  全部解析完成后，按顺序回调延后的平面
+static void FinishVisitor(const SObjVisitor* pvisitor, SObjChunk* pchunk, const SObjContext* pctx)
+{
+    //  临时文件中的平面
+    if(pchunk->pspill != 0)
+    {
+        std::vector<SPlaneInfo> tmp_vec(SPILL_READ_PLANE);
+        rewind(pchunk->pspill);
+        for(;;)
+        {
+            size_t cnt = fread(tmp_vec.data(), sizeof(SPlaneInfo), tmp_vec.size(), pchunk->pspill);
+            size_t i = 0;
+            for(i=0;i<cnt;i++)
+            {
+                DeliverTriangle(pvisitor, pctx->VertexVec, pctx->UVVec, pctx->VertexNormalVec, tmp_vec[i]);
+            }
+            if(cnt < tmp_vec.size()) break;
+        }
+        fclose(pchunk->pspill);
+        pchunk->pspill = 0;
+    }
+
+    //  内存中的平面
+    size_t i = 0;
+    for(i=0;i<pchunk->defer_vec.size();i++)
+    {
+        DeliverTriangle(pvisitor, pctx->VertexVec, pctx->UVVec, pctx->VertexNormalVec, pchunk->defer_vec.at(i));
+    }
+    std::vector<SPlaneInfo>().swap(pchunk->defer_vec);
+}
+
+//  清空分块的计数，开始解码，平面数据只保存生成等级用到的索引
+static void ResetOBJChunk(SObjChunk* pchunk, unsigned int gen_level, int stat_on)
+{
+    PlaneListInitLevel(&pchunk->plane_list, gen_level);
+    pchunk->v_cnt = 0;
+    pchunk->vt_cnt = 0;
+    pchunk->vn_cnt = 0;
+    pchunk->line_cnt = 0;
+    pchunk->unsupported_cnt = 0;
+    pchunk->has_name = 0;
+    pchunk->group_vec.clear();
+    pchunk->spill = 0;
+    pchunk->pspill = 0;
+
+    pchunk->stat_on = stat_on;
+    pchunk->run_kind = -1;
+    int i = 0;
+    for(i=0;i<STAT_KIND_NUM;i++)
+    {
+        pchunk->kind_ms[i] = 0.0;
+        pchunk->kind_cnt[i] = 0;
+        pchunk->kind_bytes[i] = 0;
+    }
+    pchunk->prescan_ms = 0.0;
+}
+
+//  由行首的3个字符得到记录的种类
+static int GetRecordKind(char ch0, char ch1, char ch2)
+{
+    if((ch0 == 'v') && (ch1 == ' '))                 return STAT_KIND_V;
+    if((ch0 == 'v') && (ch1 == 't') && (ch2 == ' ')) return STAT_KIND_VT;
+    if((ch0 == 'v') && (ch1 == 'n') && (ch2 == ' ')) return STAT_KIND_VN;
+    if((ch0 == 'f') && (ch1 == ' '))                 return STAT_KIND_F;
+    return STAT_KIND_OTHER;
+}
+
+//  统计一行，种类变化时把前一种记录连续出现的时间累加到该种类
+static void StatOBJLine(SObjChunk* pchunk, int kind, size_t bytes)
+{
+    if(kind != pchunk->run_kind)
+    {
+        std::chrono::steady_clock::time_point t_now = ObjStatsNow();
+        if(pchunk->run_kind >= 0) pchunk->kind_ms[pchunk->run_kind] += std::chrono::duration<double, std::milli>(t_now - pchunk->run_start).count();
+        pchunk->run_kind = kind;
+        pchunk->run_start = t_now;
+    }
+    pchunk->kind_cnt[kind]++;
+    pchunk->kind_bytes[kind] += bytes;
+}
+
+//  结束当前种类的统计
+static void StatOBJRunEnd(SObjChunk* pchunk)
+{
+    if(pchunk->run_kind < 0) return;
+    pchunk->kind_ms[pchunk->run_kind] += ObjStatsElapsedMs(pchunk->run_start);
+    pchunk->run_kind = -1;
+}
+
+//  把分块的统计累加到pstats
+static void AddChunkStats(SObjStats* pstats, const SObjChunk* pchunk)
+{
+    int i = 0;
+    for(i=0;i<STAT_KIND_NUM;i++)
+    {
+        pstats->kind_ms[i] += pchunk->kind_ms[i];
+        pstats->kind_cnt[i] += pchunk->kind_cnt[i];
+        pstats->kind_bytes[i] += pchunk->kind_bytes[i];
+        pstats->input_bytes += pchunk->kind_bytes[i];
+    }
+    pstats->prescan_ms += pchunk->prescan_ms;
+    pstats->face_cnt += pchunk->line_cnt - pchunk->unsupported_cnt;
+    pstats->unsupported_face_cnt += pchunk->unsupported_cnt;
+}
+
+//  按预扫描得到的记录个数预先分配分块的容器，避免解码过程中反复扩容复制
+//  不保存的数据不分配，store_face为0时不分配平面数据
+static void ReserveOBJChunk(SObjChunk* pchunk, const SObjCount* pcount, unsigned int gen_level, int store_face)
+{
+    pchunk->vertex_vec.reserve(pcount->v_cnt);
+    if(gen_level >= 2) pchunk->uv_vec.reserve(pcount->vt_cnt);
+    if(gen_level >= 3) pchunk->vn_vec.reserve(pcount->vn_cnt);
+    if(store_face)     PlaneListReserve(&pchunk->plane_list, pcount->f_cnt);
+}
+
+//  从内存中的一段OBJ文件数据继续解码到分块数据，gen_level为生成等级
+//  [pbegin, pend)必须从行首开始，在行尾结束，可以多次调用，记录的计数连续累加
+//  直接在映射的文件字节上逐行处理，行长度没有限制，数值由numscan.h解析
+//  pvisitor不为0时每个平面都回调，只能用于单个分块
+static void DecodingOBJLines(const char* pbegin, const char* pend, unsigned int gen_level, const SObjVisitor* pvisitor, SObjChunk* pchunk)
+{
+    //  检测指针
+    if((pchunk == 0) || (pbegin == 0))  return;
+
+    //  循环处理每一行
+    const char* pline = pbegin;
+    while(pline < pend)
+    {
+        //  查找行尾，最后一行可以没有换行符
+        const char* peol = (const char*)memchr(pline, '\n', pend - pline);
+        const char* pnext = 0;
+        if(peol == 0)
+        {
+            peol = pend;
+            pnext = pend;
+        }
+        else
+        {
+            pnext = peol + 1;
+        }
+        size_t line_len = peol - pline;
+
+        //  行首的3个字符，超出行尾的部分视为0
+        char ch0 = (line_len > 0) ? pline[0] : 0;
+        char ch1 = (line_len > 1) ? pline[1] : 0;
+        char ch2 = (line_len > 2) ? pline[2] : 0;
+
+        //  参数部分的起始位置
+        const char* parg1 = pline + ((line_len > 1) ? 1 : line_len);
+        const char* parg2 = pline + ((line_len > 2) ? 2 : line_len);
+        const char* parg3 = pline + ((line_len > 3) ? 3 : line_len);
+
+        //  是否为usemtl记录
+        int is_usemtl = (ch0 == 'u') && (line_len > 6) && (memcmp(pline, "usemtl", 6) == 0) && ((pline[6] == ' ') || (pline[6] == '\t'));
+
+        //  统计每种记录的时间、行数、字节数
+        if(pchunk->stat_on) StatOBJLine(pchunk, GetRecordKind(ch0, ch1, ch2), pnext - pline);
+
+        //  处理下一行前移动行指针
+        pline = pnext;
+
+        //  当为内部名字
+        if((ch0 == 'o') && (ch1 == ' '))
+        {
+            //  获取内部名字
+            std::string tmp_str(parg2, peol - parg2);
+
+            //  删除字符串内的回车或换行
+            pchunk->name = DeleteNR(tmp_str);
+            pchunk->has_name = 1;
+            AddFaceGroup(pchunk, FACE_GROUP_OBJECT, parg2, peol);
+
+            #if DEBUG_DECODE
+            printf("Internal Name:%s\r\n", pchunk->name.c_str());
+            #endif
+        }
+        //  当为组名，可以没有名字
+        else if((ch0 == 'g') && ((ch1 == ' ') || (ch1 == '\t') || (ch1 == '\r') || (line_len == 1)))
+        {
+            AddFaceGroup(pchunk, FACE_GROUP_GROUP, parg1, peol);
+        }
+        //  当为材质
+        else if(is_usemtl)
+        {
+            AddFaceGroup(pchunk, FACE_GROUP_MATERIAL, parg1 + 6, peol);
+        }
+        //  当为顶点数据
+        else if((ch0 == 'v') && (ch1 == ' '))
+        {
+            //  定义临时顶点数据
+            SVertex tmp_v;
+            tmp_v.x = 0.0f;
+            tmp_v.y = 0.0f;
+            tmp_v.z = 0.0f;
+
+            //  获取数据
+            float tmp_f[3] = {tmp_v.x, tmp_v.y, tmp_v.z};
+            ScanFloats(parg2, peol, tmp_f, 3);
+            tmp_v.x = tmp_f[0];
+            tmp_v.y = tmp_f[1];
+            tmp_v.z = tmp_f[2];
+
+            //  保存数据
+            pchunk->vertex_vec.insert(pchunk->vertex_vec.end(), tmp_v);
+            pchunk->v_cnt++;
+
+            #if DEBUG_DECODE
+            printf("v:%f %f %f\r\n", tmp_v.x, tmp_v.y, tmp_v.z);
+            #endif
+        }
+        //  当为UV数据
+        else if((ch0 == 'v') && (ch1 == 't') && (ch2 == ' '))
+        {
+            //  无论是否保存都需要计数，相对索引依赖记录的个数
+            pchunk->vt_cnt++;
+            if(gen_level < 2) continue;
+
+            //  定义临时UV数据
+            SUV tmp_t;
+            tmp_t.u = 0.0f;
+            tmp_t.v = 0.0f;
+
+            //  获取数据
+            float tmp_f[2] = {tmp_t.u, tmp_t.v};
+            ScanFloats(parg3, peol, tmp_f, 2);
+            tmp_t.u = tmp_f[0];
+            tmp_t.v = tmp_f[1];
+
+            //  格式处理
+            //tmp_t.u = 1.0f - tmp_t.u;
+            tmp_t.v = 1.0f - tmp_t.v;
+
+            //  保存数据
+            pchunk->uv_vec.insert(pchunk->uv_vec.end(), tmp_t);
+
+            #if DEBUG_DECODE
+            printf("vt:%f %f\r\n", tmp_t.u, tmp_t.v);
+            #endif
+        }
+        //  当为法线数据
+        else if((ch0 == 'v') && (ch1 == 'n') && (ch2 == ' '))
+        {
+            //  无论是否保存都需要计数，相对索引依赖记录的个数
+            pchunk->vn_cnt++;
+            if(gen_level < 3) continue;
+
+            //  定义临时法线数据
+            SVertexNormal tmp_vn;
+            tmp_vn.x = 0.0f;
+            tmp_vn.y = 0.0f;
+            tmp_vn.z = 0.0f;
+
+            //  获取数据
+            float tmp_f[3] = {tmp_vn.x, tmp_vn.y, tmp_vn.z};
+            ScanFloats(parg3, peol, tmp_f, 3);
+            tmp_vn.x = tmp_f[0];
+            tmp_vn.y = tmp_f[1];
+            tmp_vn.z = tmp_f[2];
+
+            //  保存数据
+            pchunk->vn_vec.insert(pchunk->vn_vec.end(), tmp_vn);
+
+            #if DEBUG_DECODE
+            printf("vn:%f %f %f\r\n", tmp_vn.x, tmp_vn.y, tmp_vn.z);
+            #endif
+        }
+        //  当为平面数据
+        else if((ch0 == 'f') && (ch1 == ' '))
+        {
+            pchunk->line_cnt++;
+ 
+            //  获取当前字符串中含有多少个/符号
+            int ch_cnt = GetStringCountChar(parg2, peol, '/');
+
+            //  根据数量不同，判断OBJ的格式
+            //  0个=仅仅含有顶点数据  3个=顶点数据和UV数据  6个=顶点数据、UV数据和法线数据
+            //  其他为不支持的格式 忽略
+            if((ch_cnt != (0*3)) && (ch_cnt != (1*3)) && (ch_cnt != (2*3)))
+            {
+                pchunk->unsupported_cnt++;
+                continue;
+            }
+            int group_cnt = (ch_cnt / 3) + 1;
+
+            //  定义临时平面数据，格式中不存在的属性为-1
+            SPlaneInfo tmp_p;
+            tmp_p.point_index1 = -1;
+            tmp_p.uv_index1 = -1;
+            tmp_p.vn_index1 = -1;
+            tmp_p.point_index2 = -1;
+            tmp_p.uv_index2 = -1;
+            tmp_p.vn_index2 = -1;
+            tmp_p.point_index3 = -1;
+            tmp_p.uv_index3 = -1;
+            tmp_p.vn_index3 = -1;
+
+            //  获取数据
+            int tmp_i[9];
+            int parsed = ScanFaceInts(parg2, peol, tmp_i, group_cnt, 3);
+
+            //  计算成0基序的格式
+            //  格式中存在但没能解析的属性为-2，与原来-1再减1的结果一致
+            int k = 0;
+            for(k=0;k<(group_cnt*3);k++)
+            {
+                int attr = k % group_cnt;
+                int slot = ((k / group_cnt) * 3) + attr;
+                int val = -2;
+                if(k < parsed)
+                {
+                    val = tmp_i[k];
+
+                    //  正数为1基序的绝对索引
+                    if(val >= 0)
+                    {
+                        val--;
+                    }
+                    //  负数为相对索引，-1表示到目前为止的最后一个记录
+                    else
+                    {
+                        int local_cnt = (attr == 0) ? pchunk->v_cnt : ((attr == 1) ? pchunk->vt_cnt : pchunk->vn_cnt);
+                        val += local_cnt;
+                        if(((pvisitor == 0) || pvisitor->store_face) && (pchunk->plane_list.attr_pos[attr] >= 0))
+                        {
+                            pchunk->fixup_vec.insert(pchunk->fixup_vec.end(), (PlaneListSize(pchunk->plane_list) * 9) + slot);
+                        }
+                    }
+                }
+                *GetPlaneIndexSlot(&tmp_p, slot) = val;
+            }
+
+            //  回调，引用了后面记录的平面等全部解析完成后再回调
+            //  按顺序回调时，这样的平面和后面的全部平面都延后回调
+            if(pvisitor != 0)
+            {
+                if(pvisitor->keep_order)
+                {
+                    if(!pchunk->spill && IsPlaneForward(pchunk, &tmp_p))
+                    {
+                        pchunk->spill = 1;
+                        pchunk->pspill = tmpfile();
+                    }
+                    if(pchunk->spill) SpillPlane(pchunk, tmp_p);
+                    else              DeliverTriangle(pvisitor, pchunk->vertex_vec, pchunk->uv_vec, pchunk->vn_vec, tmp_p);
+                }
+                else if(IsPlaneForward(pchunk, &tmp_p))
+                {
+                    pchunk->defer_vec.push_back(tmp_p);
+                }
+                else
+                {
+                    DeliverTriangle(pvisitor, pchunk->vertex_vec, pchunk->uv_vec, pchunk->vn_vec, tmp_p);
+                }
+                if(!pvisitor->store_face) continue;
+            }
+
+            //  保存数据
+            PlaneListPush(&pchunk->plane_list, tmp_p);
+
+            #if DEBUG_DECODE
+            printf("f:%d/%d/%d %d/%d/%d %d/%d/%d\r\n", 
+                   tmp_p.point_index1, 
+                   tmp_p.uv_index1,
+                   tmp_p.vn_index1,
+                   tmp_p.point_index2, 
+                   tmp_p.uv_index2,
+                   tmp_p.vn_index2,
+                   tmp_p.point_index3,
+                   tmp_p.uv_index3,
+                   tmp_p.vn_index3
+                  );
+            #endif
+        }
+    }
+
+    //  下一段数据可能在读取文件之后，不计入当前种类的时间
+    if(pchunk->stat_on) StatOBJRunEnd(pchunk);
+}
+
+//  从内存中的一段OBJ文件数据解码到分块数据，gen_level为生成等级
+//  先预扫描分块内的记录个数，按准确的个数一次分配容器
+static void DecodingOBJChunk(const char* pbegin, const char* pend, unsigned int gen_level, const SObjVisitor* pvisitor, SObjChunk* pchunk, int stat_on)
+{
+    ResetOBJChunk(pchunk, gen_level, stat_on);
+    SObjCount count = {0, 0, 0, 0, 0};
+    std::chrono::steady_clock::time_point t_prescan = ObjStatsNow();
+    ObjToolPrescan(pbegin, pend, &count);
+    if(stat_on) pchunk->prescan_ms = ObjStatsElapsedMs(t_prescan);
+    ReserveOBJChunk(pchunk, &count, gen_level, (pvisitor == 0) || pvisitor->store_face);
+    DecodingOBJLines(pbegin, pend, gen_level, pvisitor, pchunk);
+}
+
+//  将分块的数据复制到任务容器的指定位置，并修正相对索引
+//  base为前面分块的v/vt/vn记录数，off为前面分块保存的v/vt/vn/平面数据个数
+static void MergeOBJChunk(SObjContext* pctx, SObjChunk* pchunk, const int* base, const size_t* off)
+{
+    std::copy(pchunk->vertex_vec.begin(), pchunk->vertex_vec.end(), pctx->VertexVec.begin() + off[0]);
+    std::copy(pchunk->uv_vec.begin(), pchunk->uv_vec.end(), pctx->UVVec.begin() + off[1]);
+    std::copy(pchunk->vn_vec.begin(), pchunk->vn_vec.end(), pctx->VertexNormalVec.begin() + off[2]);
+    std::copy(pchunk->plane_list.index_vec.begin(), pchunk->plane_list.index_vec.end(), pctx->PlaneList.index_vec.begin() + (off[3] * 3 * pctx->PlaneList.attr_cnt));
+
+    //  相对索引加上前面分块的记录数，成为全局索引
+    size_t i = 0;
+    for(i=0;i<pchunk->fixup_vec.size();i++)
+    {
+        size_t pos = pchunk->fixup_vec.at(i);
+        int slot = (int)(pos % 9);
+        *PlaneListSlot(&pctx->PlaneList, off[3] + (pos / 9), slot) += base[slot % 3];
+    }
+
+    //  释放分块占用的内存
+    std::vector<SVertex>().swap(pchunk->vertex_vec);
+    std::vector<SUV>().swap(pchunk->uv_vec);
+    std::vector<SVertexNormal>().swap(pchunk->vn_vec);
+    std::vector<int>().swap(pchunk->plane_list.index_vec);
+    std::vector<size_t>().swap(pchunk->fixup_vec);
+}
+
+//  从内存中的OBJ文件数据解码到任务的内存数据
+//  thread_num大于1时，按行边界拆分为多个分块在多个线程中解码，结果与单线程完全一致
+void ObjToolParseMemory(SObjContext* pctx, const SObjOption* popt, const char* pdata, size_t size, const SObjVisitor* pvisitor)
+{
+    //  检测指针
+    if((pdata == 0) && (size != 0))  return;
+
+    //  小文件减少线程数，保证每个分块有足够的数据，有回调时单线程解码
+    int chunk_num = popt->thread_num;
+    if(pvisitor != 0) chunk_num = 1;
+    if((size_t)chunk_num > ((size / DECODE_MIN_CHUNK) + 1)) chunk_num = (int)((size / DECODE_MIN_CHUNK) + 1);
+    if(chunk_num < 1) chunk_num = 1;
+
+    //  按行边界确定每个分块的起始位置
+    std::vector<const char*> bound_vec(chunk_num + 1);
+    bound_vec.at(0) = pdata;
+    bound_vec.at(chunk_num) = pdata + size;
+    int i = 0;
+    for(i=1;i<chunk_num;i++)
+    {
+        const char* p = pdata + ((size / chunk_num) * i);
+        if(p < bound_vec.at(i - 1)) p = bound_vec.at(i - 1);
+
+        //  移动到下一行的行首
+        const char* peol = (const char*)memchr(p, '\n', (pdata + size) - p);
+        bound_vec.at(i) = (peol == 0) ? (pdata + size) : (peol + 1);
+    }
+
+    //  解码每个分块，第一个分块在当前线程中解码
+    SObjStats* pstats = popt->pstats;
+    std::chrono::steady_clock::time_point t_parse = ObjStatsNow();
+    std::vector<SObjChunk> chunk_vec(chunk_num);
+    std::vector<std::thread> thread_vec;
+    for(i=1;i<chunk_num;i++)
+    {
+        thread_vec.push_back(std::thread(DecodingOBJChunk, bound_vec.at(i), bound_vec.at(i + 1), pctx->gen_level, (const SObjVisitor*)0, &chunk_vec.at(i), pstats != 0));
+    }
+    DecodingOBJChunk(bound_vec.at(0), bound_vec.at(1), pctx->gen_level, pvisitor, &chunk_vec.at(0), pstats != 0);
+    for(i=0;i<(int)thread_vec.size();i++)
+    {
+        thread_vec.at(i).join();
+    }
+    thread_vec.clear();
+    if(pstats != 0) pstats->parse_ms += ObjStatsElapsedMs(t_parse);
+    std::chrono::steady_clock::time_point t_merge = ObjStatsNow();
+
+    //  统计平面个数和内部名字，名字以最后出现的为准
+    int line_cnt = 0;
+    size_t group_cnt = 0;
+    for(i=0;i<chunk_num;i++)
+    {
+        line_cnt += chunk_vec.at(i).line_cnt;
+        if(chunk_vec.at(i).has_name) pctx->InternalName = chunk_vec.at(i).name;
+        group_cnt += chunk_vec.at(i).group_vec.size();
+        if(pstats != 0) AddChunkStats(pstats, &chunk_vec.at(i));
+    }
+
+    //  只有一个分块时，直接交换到任务容器
+    if(chunk_num == 1)
+    {
+        pctx->VertexVec.swap(chunk_vec.at(0).vertex_vec);
+        pctx->UVVec.swap(chunk_vec.at(0).uv_vec);
+        pctx->VertexNormalVec.swap(chunk_vec.at(0).vn_vec);
+        PlaneListInitLevel(&pctx->PlaneList, pctx->gen_level);
+        pctx->PlaneList.index_vec.swap(chunk_vec.at(0).plane_list.index_vec);
+        pctx->FaceGroupVec.swap(chunk_vec.at(0).group_vec);
+    }
+    //  多个分块时，按各分块的个数计算前缀和，确定每个分块的全局索引起点和复制位置
+    else
+    {
+        std::vector<int> base_vec((chunk_num + 1) * 3, 0);
+        std::vector<size_t> off_vec((chunk_num + 1) * 4, 0);
+        for(i=0;i<chunk_num;i++)
+        {
+            SObjChunk* pchunk = &chunk_vec.at(i);
+            base_vec.at(((i + 1) * 3) + 0) = base_vec.at((i * 3) + 0) + pchunk->v_cnt;
+            base_vec.at(((i + 1) * 3) + 1) = base_vec.at((i * 3) + 1) + pchunk->vt_cnt;
+            base_vec.at(((i + 1) * 3) + 2) = base_vec.at((i * 3) + 2) + pchunk->vn_cnt;
+            off_vec.at(((i + 1) * 4) + 0) = off_vec.at((i * 4) + 0) + pchunk->vertex_vec.size();
+            off_vec.at(((i + 1) * 4) + 1) = off_vec.at((i * 4) + 1) + pchunk->uv_vec.size();
+            off_vec.at(((i + 1) * 4) + 2) = off_vec.at((i * 4) + 2) + pchunk->vn_vec.size();
+            off_vec.at(((i + 1) * 4) + 3) = off_vec.at((i * 4) + 3) + PlaneListSize(pchunk->plane_list);
+        }
+
+        //  一次分配到最终大小
+        pctx->VertexVec.resize(off_vec.at((chunk_num * 4) + 0));
+        pctx->UVVec.resize(off_vec.at((chunk_num * 4) + 1));
+        pctx->VertexNormalVec.resize(off_vec.at((chunk_num * 4) + 2));
+        PlaneListInitLevel(&pctx->PlaneList, pctx->gen_level);
+        pctx->PlaneList.index_vec.resize(off_vec.at((chunk_num * 4) + 3) * 3 * pctx->PlaneList.attr_cnt);
+
+        //  o/g/usemtl记录的平面序号加上前面分块的平面个数
+        pctx->FaceGroupVec.clear();
+        pctx->FaceGroupVec.reserve(group_cnt);
+        for(i=0;i<chunk_num;i++)
+        {
+            std::vector<SFaceGroup>& group_vec = chunk_vec.at(i).group_vec;
+            size_t j = 0;
+            for(j=0;j<group_vec.size();j++)
+            {
+                group_vec[j].first_plane += off_vec.at((i * 4) + 3);
+                pctx->FaceGroupVec.push_back(group_vec[j]);
+            }
+        }
+
+        //  各分块互不重叠，并行复制
+        for(i=1;i<chunk_num;i++)
+        {
+            thread_vec.push_back(std::thread(MergeOBJChunk, pctx, &chunk_vec.at(i), &base_vec.at(i * 3), &off_vec.at(i * 4)));
+        }
+        MergeOBJChunk(pctx, &chunk_vec.at(0), &base_vec.at(0), &off_vec.at(0));
+        for(i=0;i<(int)thread_vec.size();i++)
+        {
+            thread_vec.at(i).join();
+        }
+        if(pstats != 0) pstats->merge_ms += ObjStatsElapsedMs(t_merge);
+    }
+
+    //  回调延后的平面，计入解码时间
+    t_parse = ObjStatsNow();
+    if(pvisitor != 0) FinishVisitor(pvisitor, &chunk_vec.at(0), pctx);
+    if((pvisitor != 0) && (pstats != 0)) pstats->parse_ms += ObjStatsElapsedMs(t_parse);
+
+    if(popt->verbose) printf("line_cnt = %d\r\n", line_cnt);
+}
+
+//  读取并解码OBJ文件，成功返回0，文件打开失败返回-1
+int ObjToolParseFile(SObjContext* pctx, const SObjOption* popt, const char* filename, const SObjVisitor* pvisitor)
+{
+    SMapFile obj_map;
+    std::chrono::steady_clock::time_point t_open = ObjStatsNow();
+    if(MapFileOpen(filename, &obj_map, popt->use_mmap) != 0) return -1;
+    if(popt->pstats != 0) popt->pstats->open_ms += ObjStatsElapsedMs(t_open);
+    ObjToolParseMemory(pctx, popt, obj_map.pdata, obj_map.size, pvisitor);
+    MapFileClose(&obj_map);
+    return 0;
+}
+
+//  统计一段OBJ文件数据中各种记录的个数，结果累加到pcount中，[pbegin, pend)必须从行首开始
+//  判断方法与DecodingOBJLines相同，只有斜杠个数为0、3、6的f记录会被解码
+void ObjToolPrescan(const char* pbegin, const char* pend, SObjCount* pcount)
+{
+    const char* pline = pbegin;
+    while(pline < pend)
+    {
+        const char* peol = (const char*)memchr(pline, '\n', pend - pline);
+        if(peol == 0) peol = pend;
+        size_t line_len = peol - pline;
+        char ch0 = (line_len > 0) ? pline[0] : 0;
+        char ch1 = (line_len > 1) ? pline[1] : 0;
+        char ch2 = (line_len > 2) ? pline[2] : 0;
+
+        if(ch0 == 'v')
+        {
+            if(ch1 == ' ')                         pcount->v_cnt++;
+            else if((ch1 == 't') && (ch2 == ' '))  pcount->vt_cnt++;
+            else if((ch1 == 'n') && (ch2 == ' '))  pcount->vn_cnt++;
+        }
+        else if((ch0 == 'f') && (ch1 == ' '))
+        {
+            pcount->line_cnt++;
+            int ch_cnt = GetStringCountChar(pline + 2, peol, '/');
+            if((ch_cnt == 0) || (ch_cnt == 3) || (ch_cnt == 6)) pcount->f_cnt++;
+        }
+        pline = peol + 1;
+    }
+}
+
+//  按块读取整个文件统计记录个数，完成后回到文件开头，成功返回0，读取失败返回-2
+static int PrescanReader(SLineReader* preader, SObjCount* pcount)
+{
+    const char* pbegin = 0;
+    const char* pend = 0;
+    int re = 0;
+    while((re = LineReaderNext(preader, &pbegin, &pend)) == 1)
+    {
+        ObjToolPrescan(pbegin, pend, pcount);
+    }
+    if((re < 0) || (LineReaderRewind(preader) != 0)) return -2;
+    return 0;
+}
+
+//  从preader按块读取并解码，单线程，成功返回0，读取失败返回-2
+//  pcount为预扫描得到的记录个数，用于预先分配容器，为0时不预先分配
+static int ParseReader(SObjContext* pctx, const SObjOption* popt, SLineReader* preader, const SObjVisitor* pvisitor, const SObjCount* pcount)
+{
+    SObjStats* pstats = popt->pstats;
+    std::chrono::steady_clock::time_point t_parse = ObjStatsNow();
+    SObjChunk chunk;
+    ResetOBJChunk(&chunk, pctx->gen_level, pstats != 0);
+    if(pcount != 0) ReserveOBJChunk(&chunk, pcount, pctx->gen_level, (pvisitor == 0) || pvisitor->store_face);
+
+    const char* pbegin = 0;
+    const char* pend = 0;
+    int re = 0;
+    while((re = LineReaderNext(preader, &pbegin, &pend)) == 1)
+    {
+        DecodingOBJLines(pbegin, pend, pctx->gen_level, pvisitor, &chunk);
+    }
+
+    if(chunk.has_name) pctx->InternalName = chunk.name;
+    pctx->FaceGroupVec.swap(chunk.group_vec);
+    pctx->VertexVec.swap(chunk.vertex_vec);
+    pctx->UVVec.swap(chunk.uv_vec);
+    pctx->VertexNormalVec.swap(chunk.vn_vec);
+    PlaneListInitLevel(&pctx->PlaneList, pctx->gen_level);
+    pctx->PlaneList.index_vec.swap(chunk.plane_list.index_vec);
+
+    //  回调延后的平面
+    if(re < 0)
+    {
+        if(chunk.pspill != 0) fclose(chunk.pspill);
+        return -2;
+    }
+    if(pvisitor != 0) FinishVisitor(pvisitor, &chunk, pctx);
+    if(pstats != 0)
+    {
+        AddChunkStats(pstats, &chunk);
+        pstats->parse_ms += ObjStatsElapsedMs(t_parse);
+    }
+
+    if(popt->verbose) printf("line_cnt = %d\r\n", chunk.line_cnt);
+    return 0;
+}
+
+//  按块读取并解码OBJ文件，成功返回0，文件打开失败返回-1，读取失败返回-2
+int ObjToolParseStream(SObjContext* pctx, const SObjOption* popt, const char* filename, const SObjVisitor* pvisitor)
+{
+    SLineReader reader;
+    if(LineReaderOpen(filename, &reader) != 0) return -1;
+
+    //  普通文件先预扫描，管道等只能读一遍的输入直接解码
+    SObjCount count = {0, 0, 0, 0, 0};
+    int re = 0;
+    std::chrono::steady_clock::time_point t_prescan = ObjStatsNow();
+    if(reader.is_regular) re = PrescanReader(&reader, &count);
+    if(popt->pstats != 0) popt->pstats->prescan_ms += ObjStatsElapsedMs(t_prescan);
+    if(re == 0) re = ParseReader(pctx, popt, &reader, pvisitor, reader.is_regular ? &count : 0);
+    LineReaderClose(&reader);
+    return re;
+}
+
+//  从路径中获取文件名，含扩展名
+static std::string GetFileNameExFromPath(std::string in_str)
+{
+    //  定义返回字符串
+    std::string re_str;
+
+    //  遍历每个字符
+    int len = in_str.size();
+    int i = 0;
+    for(i=0;i<len;i++)
+    {
+        //  当不为路径分割符号，插入输出字符串
+        if((in_str.at(len-1-i) != '\\')&&(in_str.at(len-1-i) != '/'))
+        {
+            re_str.insert(re_str.begin(), in_str.at(len-1-i));
+        }
+        //  当为路径分割，直接跳出
+        else
+        {
+            break;
+        }
+    }
+
+    //  返回字符串
+    return re_str;
+}
+
+//  从文件名中删除文件中的扩展名，输入必须仅仅是带扩展名的文件名，不能是带路径的
+static std::string GetFileNameNoExFormFileName(std::string in_str)
+{
+    //  定义返回字符串
+    std::string re_str;
+
+    //  完全赋值给返回
+    re_str = in_str;
+
+    //  统计其中含有多少点
+    int dot_cnt = 0;
+    int len = in_str.size();
+    int i = 0;
+    for(i=0;i<len;i++)
+    {
+        //  当为点的时候
+        if(in_str.at(len-1-i) == '.')
+        {
+            dot_cnt++;
+        }
+    }
+
+    //  只要里面含有点
+    if(dot_cnt >= 1)
+    {
+        //  遍历每个字符，从后面网前执行删除
+        for(i=0;i<len;i++)
+        {
+            //  当为点
+            if(re_str.at(len-1-i) == '.')
+            {
+                //  删除
+                re_str.erase(re_str.end()-1);
+                break;
+            }
+            //  不为点
+            else
+            {
+                re_str.erase(re_str.end()-1);
+            }
+        }
+    }
+
+    //  返回字符串
+    return re_str;
+}
+
+//  从完整路径或文件名中提取纯文件名部分，不含扩展名
+static std::string GetOnlyFileNameNoEx(std::string in_str)
+{
+    return GetFileNameNoExFormFileName(GetFileNameExFromPath(in_str));
+}
+
+//  写入一个点的数据，puv和pvn为0时不写入对应的数据
+static void GenCCodeDotData(SCWriter* pw, const SVertex* pv, const SUV* puv, const SVertexNormal* pvn)
+{
+    //  写入顶点数据
+    //  "    %f, %f, %f,    "
+    CWriterPut(pw, "    ", 4);
+    CWriterPutFloat(pw, pv->x);
+    CWriterPut(pw, ", ", 2);
+    CWriterPutFloat(pw, pv->y);
+    CWriterPut(pw, ", ", 2);
+    CWriterPutFloat(pw, pv->z);
+    CWriterPut(pw, ",    ", 5);
+
+    //  写入UV数据
+    //  "%f, %f,    "
+    if(puv != 0)
+    {
+        CWriterPutFloat(pw, puv->u);
+        CWriterPut(pw, ", ", 2);
+        CWriterPutFloat(pw, puv->v);
+        CWriterPut(pw, ",    ", 5);
+    }
+
+    //  写入法线数据
+    //  "%f, %f, %f,    "
+    if(pvn != 0)
+    {
+        CWriterPutFloat(pw, pvn->x);
+        CWriterPut(pw, ", ", 2);
+        CWriterPutFloat(pw, pvn->y);
+        CWriterPut(pw, ", ", 2);
+        CWriterPutFloat(pw, pvn->z);
+        CWriterPut(pw, ",    ", 5);
+    }
+
+    //  完成一个点的写入
+    CWriterPut(pw, "\r\n", 2);
+}
+
+//  写入一个点的数据，顶点索引无效时返回-2，成功返回0
+//  UV和法线索引无效时不写入对应的数据
+static int GenCCodeDot(SObjContext* pctx, SCWriter* pw, int point_index, int uv_index, int vn_index)
+{
+    int total_vex = pctx->VertexVec.size();         //  获取可用顶点数量
+    int total_uv = pctx->UVVec.size();              //  获取可用UV数量
+    int total_vn = pctx->VertexNormalVec.size();    //  获取可用法线数量
+
+    //  检查平面序号
+    if((point_index >= total_vex) || (point_index < 0)) return -2;
+
+    //  检查是否含有UV数据和法线数据
+    const SUV* puv = 0;
+    const SVertexNormal* pvn = 0;
+    if((uv_index < total_uv) && (uv_index >= 0)) puv = &pctx->UVVec.at(uv_index);
+    if((vn_index < total_vn) && (vn_index >= 0)) pvn = &pctx->VertexNormalVec.at(vn_index);
+
+    GenCCodeDotData(pw, &pctx->VertexVec.at(point_index), puv, pvn);
+    return 0;
+}
+
+//  得到一个点的float个数，has_uv、has_vn为是否存在UV和法线数据
+static unsigned int GetDotFloatCount(int has_uv, int has_vn)
+{
+    unsigned int dot_float = 0;           //  一个点有多少个float组成
+    dot_float = 3;                        //  最少的时候，1个点有3个坐标xyz组成
+    if(has_uv) dot_float += 2;            //  当存在UV贴图信息时，还需要两个float表示uv坐标
+    if(has_vn) dot_float += 3;            //  当存在法线信息时，存在法线向量
+    return dot_float;
+}
+
+//  得到顶点数据数组的名字，不含数组大小
+//  cube_3d_vtn_data
+static std::string GetVertexArrayName(int has_uv, int has_vn, std::string name)
+{
+    std::string re_str = name;
+    re_str += "_3d_v";
+    if(has_uv) re_str += "t";
+    if(has_vn) re_str += "n";
+    re_str += "_data";
+    return re_str;
+}
+
+//  将字符串转换为大写，用于生成宏定义的名字
+static std::string GetUpperString(std::string in_str)
+{
+    size_t i = 0;
+    for(i=0;i<in_str.size();i++)
+    {
+        if((in_str.at(i) >= 'a') && (in_str.at(i) <= 'z')) in_str.at(i) = in_str.at(i) - 'a' + 'A';
+    }
+    return in_str;
+}
+
+//  生成宏定义
+//  #define CUBE_3D_VERTEX_CNT  24
+static std::string GetDefineString(std::string name, unsigned long long val)
+{
+    std::string re_str = "#define ";
+    re_str += name;
+    re_str += "    ";
+    re_str += std::to_string(val);
+    return re_str;
+}
+
+//  定义一个绘制批次，排序后的平面序号在[first_plane, first_plane + plane_cnt)范围内
+typedef struct
+{
+    size_t first_plane;                         //  第一个平面
+    size_t plane_cnt;                           //  平面个数
+    int material;                               //  材质在材质名字表中的序号
+    std::string part;                           //  部件的名字
+    unsigned int min_vertex;                    //  用到的最小顶点序号，用于glDrawRangeElements
+    unsigned int max_vertex;                    //  用到的最大顶点序号
+}SDrawBatch;
+
+//  定义排序前一段连续的平面，属于同一个批次
+typedef struct
+{
+    size_t first_plane;
+    size_t plane_cnt;
+    int batch;
+}SFaceRun;
+
+//  得到部件的名字，o和g都有时为"o/g"
+static std::string GetPartName(const std::string& object_str, const std::string& group_str)
+{
+    if(group_str.empty()) return object_str;
+    if(object_str.empty()) return group_str;
+    return object_str + "/" + group_str;
+}
+
+//  按材质和部件对平面排序，得到绘制批次
+//  同一材质的批次连续，减少切换材质的次数，材质之间、同一材质的部件之间按首次出现的顺序，
+//  批次内保持原来的顺序，没有usemtl的平面材质名字为空
+//  排序后FaceGroupVec改写为每个批次一条o记录和一条usemtl记录，再次排序的结果不变
+static void SortDrawBatch(SObjContext* pctx, std::vector<SDrawBatch>* pbatch_vec, std::vector<std::string>* pmtl_vec)
+{
+    size_t total_plane = PlaneListSize(pctx->PlaneList);
+    std::map<std::string, int> mtl_map;
+    std::map<std::string, int> part_map;
+    std::map<std::pair<int, int>, int> key_map;         //  (材质序号, 部件序号) -> 批次
+    std::vector<std::string> part_vec;
+    std::vector<std::pair<int, int>> key_vec;
+    std::vector<SFaceRun> run_vec;
+    pbatch_vec->clear();
+    pmtl_vec->clear();
+
+    //  按记录把平面分为连续的段，每段的材质和部件不变
+    std::string object_str;
+    std::string group_str;
+    std::string mtl_str;
+    size_t g = 0;
+    size_t first = 0;
+    while(first < total_plane)
+    {
+        while((g < pctx->FaceGroupVec.size()) && (pctx->FaceGroupVec[g].first_plane <= first))
+        {
+            const SFaceGroup& tmp_group = pctx->FaceGroupVec[g];
+            if(tmp_group.kind == FACE_GROUP_OBJECT)
+            {
+                object_str = tmp_group.name;
+                group_str.clear();
+            }
+            else if(tmp_group.kind == FACE_GROUP_GROUP)
+            {
+                group_str = tmp_group.name;
+            }
+            else
+            {
+                mtl_str = tmp_group.name;
+            }
+            g++;
+        }
+        size_t last = total_plane;
+        if((g < pctx->FaceGroupVec.size()) && (pctx->FaceGroupVec[g].first_plane < last)) last = pctx->FaceGroupVec[g].first_plane;
+
+        //  材质和部件按首次出现的顺序编号
+        std::string part_str = GetPartName(object_str, group_str);
+        if(mtl_map.find(mtl_str) == mtl_map.end())
+        {
+            mtl_map[mtl_str] = (int)pmtl_vec->size();
+            pmtl_vec->push_back(mtl_str);
+        }
+        if(part_map.find(part_str) == part_map.end())
+        {
+            part_map[part_str] = (int)part_vec.size();
+            part_vec.push_back(part_str);
+        }
+        std::pair<int, int> key(mtl_map[mtl_str], part_map[part_str]);
+        if(key_map.find(key) == key_map.end())
+        {
+            key_map[key] = (int)key_vec.size();
+            key_vec.push_back(key);
+        }
+
+        SFaceRun tmp_run = {first, last - first, key_map[key]};
+        run_vec.push_back(tmp_run);
+        first = last;
+    }
+
+    //  批次按(材质序号, 部件序号)排序，key_map本身就是有序的
+    std::vector<int> order_vec(key_vec.size());
+    std::map<std::pair<int, int>, int>::const_iterator it;
+    int batch = 0;
+    for(it=key_map.begin();it!=key_map.end();++it)
+    {
+        order_vec[it->second] = batch;
+        SDrawBatch tmp_batch;
+        tmp_batch.first_plane = 0;
+        tmp_batch.plane_cnt = 0;
+        tmp_batch.material = it->first.first;
+        tmp_batch.part = part_vec[it->first.second];
+        tmp_batch.min_vertex = 0;
+        tmp_batch.max_vertex = 0;
+        pbatch_vec->push_back(tmp_batch);
+        batch++;
+    }
+
+    //  每个批次的平面个数和起点
+    size_t i = 0;
+    for(i=0;i<run_vec.size();i++)
+    {
+        run_vec[i].batch = order_vec[run_vec[i].batch];
+        pbatch_vec->at(run_vec[i].batch).plane_cnt += run_vec[i].plane_cnt;
+    }
+    for(i=1;i<pbatch_vec->size();i++)
+    {
+        pbatch_vec->at(i).first_plane = pbatch_vec->at(i - 1).first_plane + pbatch_vec->at(i - 1).plane_cnt;
+    }
+
+    //  按批次复制平面数据
+    size_t plane_int = 3 * pctx->PlaneList.attr_cnt;
+    std::vector<size_t> pos_vec(pbatch_vec->size());
+    for(i=0;i<pbatch_vec->size();i++) pos_vec[i] = pbatch_vec->at(i).first_plane;
+    std::vector<int> index_vec(pctx->PlaneList.index_vec.size());
+    for(i=0;i<run_vec.size();i++)
+    {
+        const SFaceRun& tmp_run = run_vec[i];
+        std::copy(pctx->PlaneList.index_vec.begin() + (tmp_run.first_plane * plane_int),
+                  pctx->PlaneList.index_vec.begin() + ((tmp_run.first_plane + tmp_run.plane_cnt) * plane_int),
+                  index_vec.begin() + (pos_vec[tmp_run.batch] * plane_int));
+        pos_vec[tmp_run.batch] += tmp_run.plane_cnt;
+    }
+    pctx->PlaneList.index_vec.swap(index_vec);
+
+    //  记录改为排序后的批次
+    pctx->FaceGroupVec.clear();
+    for(i=0;i<pbatch_vec->size();i++)
+    {
+        const SDrawBatch& tmp_batch = pbatch_vec->at(i);
+        SFaceGroup tmp_group;
+        tmp_group.first_plane = tmp_batch.first_plane;
+        tmp_group.kind = FACE_GROUP_OBJECT;
+        tmp_group.name = tmp_batch.part;
+        pctx->FaceGroupVec.push_back(tmp_group);
+        tmp_group.kind = FACE_GROUP_MATERIAL;
+        tmp_group.name = pmtl_vec->at(tmp_batch.material);
+        pctx->FaceGroupVec.push_back(tmp_group);
+    }
+}
+
+//  得到C字符串常量，转义引号、反斜杠和控制字符
+static std::string GetCStringLiteral(const std::string& in_str)
+{
+    std::string re_str = "\"";
+    size_t i = 0;
+    for(i=0;i<in_str.size();i++)
+    {
+        unsigned char ch = (unsigned char)in_str[i];
+        if((ch == '"') || (ch == '\\'))
+        {
+            re_str += '\\';
+            re_str += (char)ch;
+        }
+        else if(ch < 0x20)
+        {
+            char tmp_str[8];
+            snprintf(tmp_str, sizeof(tmp_str), "\\%03o", ch);
+            re_str += tmp_str;
+        }
+        else
+        {
+            re_str += (char)ch;
+        }
+    }
+    re_str += "\"";
+    return re_str;
+}
+
+//  生成绘制批次表，每行一个批次
+//  const unsigned int cube_3d_batch[5*N] = { 起点, 个数, 最小顶点序号, 最大顶点序号, 材质序号, ... };
+//  索引输出时起点和个数的单位为索引，用于glDrawRangeElements，否则为顶点，用于glDrawArrays
+//  材质和部件的名字生成为头文件中的字符串列表，可以直接用于数组的初始化
+//  #define CUBE_3D_MATERIAL_NAMES    "wood", "metal"
+//  #define CUBE_3D_BATCH_NAMES    "Body", "Wheel"
+static void GenCCodeBatch(SCWriter* pw, std::string name, const std::vector<SDrawBatch>& batch_vec, const std::vector<std::string>& mtl_vec, std::vector<std::string>* pdecl_vec, std::vector<std::string>* pdef_vec)
+{
+    std::string upper_str = GetUpperString(name);
+    std::string tmp_str;
+    size_t i = 0;
+    pdef_vec->push_back(GetDefineString(upper_str + "_3D_BATCH_CNT", batch_vec.size()));
+    pdef_vec->push_back(GetDefineString(upper_str + "_3D_MATERIAL_CNT", mtl_vec.size()));
+    tmp_str = "#define " + upper_str + "_3D_MATERIAL_NAMES    ";
+    for(i=0;i<mtl_vec.size();i++)
+    {
+        if(i > 0) tmp_str += ", ";
+        tmp_str += GetCStringLiteral(mtl_vec[i]);
+    }
+    pdef_vec->push_back(tmp_str);
+    tmp_str = "#define " + upper_str + "_3D_BATCH_NAMES    ";
+    for(i=0;i<batch_vec.size();i++)
+    {
+        if(i > 0) tmp_str += ", ";
+        tmp_str += GetCStringLiteral(batch_vec[i].part);
+    }
+    pdef_vec->push_back(tmp_str);
+
+    std::string decl_str = "const unsigned int " + name + "_3d_batch[" + std::to_string((unsigned long long)batch_vec.size() * 5) + "]";
+    pdecl_vec->push_back(decl_str);
+    CWriterPutStr(pw, decl_str);
+    CWriterPutStr(pw, " =\r\n{\r\n");
+    CWriterBeginArray(pw, name + "_3d_batch", sizeof(unsigned int), batch_vec.size() * 5);
+    for(i=0;i<batch_vec.size();i++)
+    {
+        const SDrawBatch& tmp_batch = batch_vec[i];
+        CWriterPut(pw, "    ", 4);
+        CWriterPutUInt(pw, tmp_batch.first_plane * 3);
+        CWriterPut(pw, ", ", 2);
+        CWriterPutUInt(pw, tmp_batch.plane_cnt * 3);
+        CWriterPut(pw, ", ", 2);
+        CWriterPutUInt(pw, tmp_batch.min_vertex);
+        CWriterPut(pw, ", ", 2);
+        CWriterPutUInt(pw, tmp_batch.max_vertex);
+        CWriterPut(pw, ", ", 2);
+        CWriterPutUInt(pw, tmp_batch.material);
+        CWriterPut(pw, ",\r\n", 3);
+    }
+    CWriterEndArray(pw);
+    CWriterPutStr(pw, "};\r\n");
+}
+
+//  生成按三角形展开的顶点数据，每个平面的3个点依次写入
+//  数组的声明加入pdecl_vec，成功返回0
+static int GenCCodeFlat(SObjContext* pctx, SCWriter* pw, std::string name, std::vector<std::string>* pdecl_vec)
+{
+    //  计算数据总量，单位float个
+    unsigned long long float_cnt = (unsigned long long)GetDotFloatCount(!pctx->UVVec.empty(), !pctx->VertexNormalVec.empty()) * PlaneListSize(pctx->PlaneList) * 3;  //  每个平面有3个点确定
+
+    //  数组声明
+    //  const float cube_3d_vtn_data[324852354]
+    std::string decl_str = "const float ";
+    decl_str += GetVertexArrayName(!pctx->UVVec.empty(), !pctx->VertexNormalVec.empty(), name);
+    decl_str += "[";
+    decl_str += std::to_string(float_cnt);
+    decl_str += "]";
+    pdecl_vec->push_back(decl_str);
+
+    //  生成数据头部
+    //  const float cube_3d_vtn_data[324852354] = 
+    //  {
+    CWriterPutStr(pw, decl_str);
+    CWriterPutStr(pw, " =\r\n{\r\n");
+    CWriterBeginArray(pw, GetVertexArrayName(!pctx->UVVec.empty(), !pctx->VertexNormalVec.empty(), name), sizeof(float), float_cnt);
+
+    //  开始写入数据
+    size_t plane_cnt=0;
+    size_t total_plane = PlaneListSize(pctx->PlaneList); //  获取可用平面数量
+    for(plane_cnt=0;plane_cnt<total_plane;plane_cnt++)   //  遍历每个平面
+    {
+        //  依次写入3个点的数据
+        int k = 0;
+        for(k=0;k<3;k++)
+        {
+            int point_index = 0;
+            int uv_index = 0;
+            int vn_index = 0;
+            PlaneListGetCorner(pctx->PlaneList, (plane_cnt * 3) + k, &point_index, &uv_index, &vn_index);
+            if(GenCCodeDot(pctx, pw, point_index, uv_index, vn_index) != 0) return -2;
+        }
+
+        //  完成一个面的写入
+        CWriterPut(pw, "\r\n", 2);
+    }
+
+    //  结束
+    //  };
+    CWriterEndArray(pw);
+    CWriterPutStr(pw, "};\r\n");
+    return 0;
+}
+
+//  写入一个去重后的顶点，不存在的UV和法线写入0，保证每个顶点的长度一致
+static void GenCCodeVertex(SObjContext* pctx, SCWriter* pw, const SVertexKey& key)
+{
+    //  写入顶点数据
+    //  "    %f, %f, %f,    "
+    SVertex tmp_v = pctx->VertexVec.at(key.point_index);
+    CWriterPut(pw, "    ", 4);
+    CWriterPutFloat(pw, tmp_v.x);
+    CWriterPut(pw, ", ", 2);
+    CWriterPutFloat(pw, tmp_v.y);
+    CWriterPut(pw, ", ", 2);
+    CWriterPutFloat(pw, tmp_v.z);
+    CWriterPut(pw, ",    ", 5);
+
+    //  写入UV数据
+    //  "%f, %f,    "
+    if(pctx->UVVec.size() > 0)
+    {
+        SUV tmp_uv = {0.0f, 0.0f};
+        if(key.uv_index >= 0) tmp_uv = pctx->UVVec.at(key.uv_index);
+        CWriterPutFloat(pw, tmp_uv.u);
+        CWriterPut(pw, ", ", 2);
+        CWriterPutFloat(pw, tmp_uv.v);
+        CWriterPut(pw, ",    ", 5);
+    }
+
+    //  写入法线数据
+    //  "%f, %f, %f,    "
+    if(pctx->VertexNormalVec.size() > 0)
+    {
+        SVertexNormal tmp_vn = {0.0f, 0.0f, 0.0f};
+        if(key.vn_index >= 0) tmp_vn = pctx->VertexNormalVec.at(key.vn_index);
+        CWriterPutFloat(pw, tmp_vn.x);
+        CWriterPut(pw, ", ", 2);
+        CWriterPutFloat(pw, tmp_vn.y);
+        CWriterPut(pw, ", ", 2);
+        CWriterPutFloat(pw, tmp_vn.z);
+        CWriterPut(pw, ",    ", 5);
+    }
+
+    //  完成一个点的写入
+    CWriterPut(pw, "\r\n", 2);
+}
+
+//  得到索引数组的C类型
+static const char* GetIndexTypeString(int index_size)
+{
+    if(index_size == 1) return "unsigned char";
+    if(index_size == 2) return "unsigned short";
+    return "unsigned int";
+}
+
+//  收集网格顶点的属性数据，kind为ATTR_KIND_XXX，不存在的UV和法线为0
+static void GetMeshAttrData(SObjContext* pctx, const SIndexedMesh& mesh, int kind, std::vector<float>* pdata_vec)
+{
+    size_t i = 0;
+    pdata_vec->clear();
+    for(i=0;i<mesh.vertex_vec.size();i++)
+    {
+        const SVertexKey& key = mesh.vertex_vec[i];
+        if(kind == ATTR_KIND_POS)
+        {
+            SVertex tmp_v = pctx->VertexVec.at(key.point_index);
+            pdata_vec->push_back(tmp_v.x);
+            pdata_vec->push_back(tmp_v.y);
+            pdata_vec->push_back(tmp_v.z);
+        }
+        else if(kind == ATTR_KIND_UV)
+        {
+            SUV tmp_uv = {0.0f, 0.0f};
+            if(key.uv_index >= 0) tmp_uv = pctx->UVVec.at(key.uv_index);
+            pdata_vec->push_back(tmp_uv.u);
+            pdata_vec->push_back(tmp_uv.v);
+        }
+        else
+        {
+            SVertexNormal tmp_vn = {0.0f, 0.0f, 0.0f};
+            if(key.vn_index >= 0) tmp_vn = pctx->VertexNormalVec.at(key.vn_index);
+            pdata_vec->push_back(tmp_vn.x);
+            pdata_vec->push_back(tmp_vn.y);
+            pdata_vec->push_back(tmp_vn.z);
+        }
+    }
+}
+
+//  生成一个属性的数据数组array_name，按照fmt编码，每行一个顶点
+//  需要反量化参数时同时生成offset和scale数组
+static void GenCCodeAttr(SCWriter* pw, std::string name, const char* pattr_name, int kind, int fmt, const std::vector<float>& data_vec, std::string array_name, std::vector<std::string>* pdecl_vec, std::vector<std::string>* pdef_vec)
+{
+    int comp = GetAttrKindComp(kind);
+    size_t vertex_cnt = data_vec.size() / comp;
+    int out_comp = ((fmt == ATTR_FMT_OCT8) || (fmt == ATTR_FMT_OCT16)) ? 2 : comp;
+    std::string upper_str = GetUpperString(name + "_3d_" + pattr_name);
+    std::string decl_str;
+    std::string tmp_str;
+    int k = 0;
+
+    //  OpenGL ES中的数据格式
+    //  #define CUBE_3D_POS_GL_TYPE    0x1402
+    char num_str[32];
+    snprintf(num_str, sizeof(num_str), "0x%04X", GetAttrFormatGLType(fmt));
+    pdef_vec->push_back("#define " + upper_str + "_GL_TYPE    " + num_str);
+    pdef_vec->push_back(GetDefineString(upper_str + "_COMP", out_comp));
+    pdef_vec->push_back(GetDefineString(upper_str + "_NORMALIZED", ((fmt == ATTR_FMT_F32) || (fmt == ATTR_FMT_F16)) ? 0 : 1));
+    if(out_comp != comp) pdef_vec->push_back(GetDefineString(upper_str + "_OCT", 1));
+
+    //  反量化参数，固定小数位会损失精度，改用精确的最短格式
+    //  const float cube_3d_pos_offset[3] = {...};
+    SQuantRange range;
+    GetQuantRange(data_vec.data(), vertex_cnt, comp, fmt, &range);
+    if((fmt == ATTR_FMT_SNORM16) || (fmt == ATTR_FMT_UNORM16))
+    {
+        int j = 0;
+        for(j=0;j<2;j++)
+        {
+            tmp_str = name + "_3d_" + pattr_name + ((j == 0) ? "_offset" : "_scale");
+            decl_str = "const float " + tmp_str + "[" + std::to_string(comp) + "]";
+            pdecl_vec->push_back(decl_str);
+            CWriterPutStr(pw, decl_str);
+            CWriterPutStr(pw, " = { ");
+            CWriterBeginArray(pw, tmp_str, sizeof(float), comp);
+            for(k=0;k<comp;k++)
+            {
+                CWriterPutFloatFmt(pw, (j == 0) ? range.offset[k] : range.scale[k], (pw->float_fmt == FLOAT_FMT_FIXED) ? FLOAT_FMT_SHORT : pw->float_fmt, -1);
+                CWriterPutStr(pw, (k < (comp - 1)) ? ", " : " ");
+            }
+            CWriterEndArray(pw);
+            CWriterPutStr(pw, "};\r\n");
+        }
+    }
+
+    //  数据数组
+    //  const short cube_3d_pos_data[72] =
+    //  {
+    decl_str = "const ";
+    decl_str += GetAttrFormatCType(fmt);
+    decl_str += " " + array_name + "[";
+    decl_str += std::to_string((unsigned long long)vertex_cnt * out_comp);
+    decl_str += "]";
+    pdecl_vec->push_back(decl_str);
+    CWriterPutStr(pw, decl_str);
+    CWriterPutStr(pw, " =\r\n{\r\n");
+    CWriterBeginArray(pw, array_name, GetAttrFormatSize(kind, fmt) / out_comp, vertex_cnt * out_comp);
+
+    size_t i = 0;
+    for(i=0;i<vertex_cnt;i++)
+    {
+        const float* pin = &data_vec[i * comp];
+        CWriterPut(pw, "    ", 4);
+        if(fmt == ATTR_FMT_F32)
+        {
+            for(k=0;k<comp;k++)
+            {
+                CWriterPutFloat(pw, pin[k]);
+                CWriterPut(pw, ", ", 2);
+            }
+        }
+        else
+        {
+            int code[3];
+            EncodeAttr(pin, comp, fmt, &range, code);
+            for(k=0;k<out_comp;k++)
+            {
+                CWriterPutInt(pw, code[k]);
+                CWriterPut(pw, ", ", 2);
+            }
+        }
+        CWriterPut(pw, "\r\n", 2);
+    }
+    CWriterEndArray(pw);
+    CWriterPutStr(pw, "};\r\n");
+}
+
+//  由布局中的字母得到属性的种类，p=顶点坐标 t=UV n=法线 x=切线，不支持时返回-1
+static int GetLayoutAttrKind(char ch)
+{
+    if(ch == 'p') return ATTR_KIND_POS;
+    if(ch == 't') return ATTR_KIND_UV;
+    if(ch == 'n') return ATTR_KIND_NORMAL;
+    if(ch == 'x') return ATTR_KIND_TANGENT;
+    return -1;
+}
+
+//  解析属性的分组布局，如"p | tn"，每组生成一个数组，每个字母最多出现一次
+//  成功返回0，格式错误返回-1
+int ObjToolParseLayout(const char* pstr, std::vector<std::string>* playout_vec)
+{
+    std::string group_str;
+    int used[4] = {0, 0, 0, 0};
+    playout_vec->clear();
+    for(;;pstr++)
+    {
+        //  一组结束
+        if((*pstr == '|') || (*pstr == 0))
+        {
+            if(group_str.empty()) return -1;
+            playout_vec->push_back(group_str);
+            group_str = "";
+            if(*pstr == 0) break;
+            continue;
+        }
+        if(*pstr == ' ') continue;
+
+        int kind = GetLayoutAttrKind(*pstr);
+        if((kind < 0) || used[kind]) return -1;
+        used[kind] = 1;
+        group_str.push_back(*pstr);
+    }
+    return 0;
+}
+
+//  生成一组交错排列的32位浮点属性数据array_name，每行一个顶点，tangent_vec为每个顶点的切线空间
+static void GenCCodeStream(SObjContext* pctx, SCWriter* pw, const SIndexedMesh& mesh, const std::vector<float>& tangent_vec, const std::vector<int>& kind_vec, std::string array_name, std::vector<std::string>* pdecl_vec)
+{
+    std::vector<float> data_vec[4];
+    size_t vertex_cnt = mesh.vertex_vec.size();
+    size_t float_cnt = 0;
+    size_t i = 0;
+    size_t j = 0;
+    for(j=0;j<kind_vec.size();j++)
+    {
+        if(kind_vec[j] == ATTR_KIND_TANGENT) data_vec[j] = tangent_vec;
+        else                                 GetMeshAttrData(pctx, mesh, kind_vec[j], &data_vec[j]);
+        float_cnt += GetAttrKindComp(kind_vec[j]);
+    }
+
+    //  const float cube_3d_tn_data[120] =
+    //  {
+    std::string decl_str = "const float " + array_name + "[" + std::to_string((unsigned long long)vertex_cnt * float_cnt) + "]";
+    pdecl_vec->push_back(decl_str);
+    CWriterPutStr(pw, decl_str);
+    CWriterPutStr(pw, " =\r\n{\r\n");
+    CWriterBeginArray(pw, array_name, sizeof(float), vertex_cnt * float_cnt);
+
+    //  "    %f, %f,    %f, %f, %f,    "
+    for(i=0;i<vertex_cnt;i++)
+    {
+        CWriterPut(pw, "    ", 4);
+        for(j=0;j<kind_vec.size();j++)
+        {
+            int comp = GetAttrKindComp(kind_vec[j]);
+            int k = 0;
+            for(k=0;k<comp;k++)
+            {
+                CWriterPutFloat(pw, data_vec[j][i * comp + k]);
+                if(k < (comp - 1)) CWriterPut(pw, ", ", 2);
+                else               CWriterPut(pw, ",    ", 5);
+            }
+        }
+        CWriterPut(pw, "\r\n", 2);
+    }
+    CWriterEndArray(pw);
+    CWriterPutStr(pw, "};\r\n");
+}
+
+//  判断是否需要按属性分别编码
+static int IsAttrEncoded(const SObjOption* popt)
+{
+    if(popt->max_error >= 0.0) return 1;
+    return ((popt->pos_fmt != ATTR_FMT_AUTO) && (popt->pos_fmt != ATTR_FMT_F32)) ||
+           ((popt->uv_fmt != ATTR_FMT_AUTO) && (popt->uv_fmt != ATTR_FMT_F32)) ||
+           ((popt->normal_fmt != ATTR_FMT_AUTO) && (popt->normal_fmt != ATTR_FMT_F32));
+}
+
+//  每个批次分别做顶点缓存优化，三角形不会移出所在的批次
+//  批次内的顶点重新编号为0,1,2,...，优化的时间和内存只与批次的大小有关
+static void OptimizeBatchVertexCache(std::vector<unsigned int>* pindex_vec, const std::vector<SDrawBatch>& batch_vec)
+{
+    std::vector<int> local_vec;
+    std::vector<unsigned int> global_vec;
+    std::vector<unsigned int> sub_vec;
+    size_t b = 0;
+    size_t i = 0;
+    for(b=0;b<batch_vec.size();b++)
+    {
+        size_t first = batch_vec[b].first_plane * 3;
+        size_t cnt = batch_vec[b].plane_cnt * 3;
+        global_vec.clear();
+        sub_vec.resize(cnt);
+        for(i=0;i<cnt;i++)
+        {
+            unsigned int v = (*pindex_vec)[first + i];
+            if(v >= local_vec.size()) local_vec.resize(v + 1, -1);
+            if(local_vec[v] < 0)
+            {
+                local_vec[v] = (int)global_vec.size();
+                global_vec.push_back(v);
+            }
+            sub_vec[i] = (unsigned int)local_vec[v];
+        }
+        OptimizeVertexCache(&sub_vec, global_vec.size());
+        for(i=0;i<cnt;i++)
+        {
+            (*pindex_vec)[first + i] = global_vec[sub_vec[i]];
+        }
+        for(i=0;i<global_vec.size();i++)
+        {
+            local_vec[global_vec[i]] = -1;
+        }
+    }
+}
+
+//  每个批次分别按遮挡关系重新排列三角形，批次之间的顺序不变
+//  *pcluster_cnt返回全部批次的簇的个数
+static void OptimizeBatchOverdraw(std::vector<unsigned int>* pindex_vec, const std::vector<SDrawBatch>& batch_vec, const std::vector<float>& pos_vec, double threshold, size_t* pcluster_cnt)
+{
+    std::vector<unsigned int> sub_vec;
+    size_t b = 0;
+    *pcluster_cnt = 0;
+    for(b=0;b<batch_vec.size();b++)
+    {
+        size_t first = batch_vec[b].first_plane * 3;
+        size_t cnt = batch_vec[b].plane_cnt * 3;
+        size_t cluster_cnt = 0;
+        sub_vec.assign(pindex_vec->begin() + first, pindex_vec->begin() + first + cnt);
+        OptimizeOverdraw(&sub_vec, pos_vec, threshold, &cluster_cnt);
+        std::copy(sub_vec.begin(), sub_vec.end(), pindex_vec->begin() + first);
+        *pcluster_cnt += cluster_cnt;
+    }
+}
+
+//  由最终的索引得到每个批次用到的最小和最大顶点序号
+static void GetBatchVertexRange(const std::vector<unsigned int>& index_vec, std::vector<SDrawBatch>* pbatch_vec)
+{
+    size_t b = 0;
+    size_t i = 0;
+    for(b=0;b<pbatch_vec->size();b++)
+    {
+        SDrawBatch* pbatch = &pbatch_vec->at(b);
+        size_t first = pbatch->first_plane * 3;
+        size_t cnt = pbatch->plane_cnt * 3;
+        pbatch->min_vertex = 0;
+        pbatch->max_vertex = 0;
+        for(i=0;i<cnt;i++)
+        {
+            unsigned int v = index_vec[first + i];
+            if((i == 0) || (v < pbatch->min_vertex)) pbatch->min_vertex = v;
+            if((i == 0) || (v > pbatch->max_vertex)) pbatch->max_vertex = v;
+        }
+    }
+}
+
+//  生成meshlet的数组，mesh为最终输出的三角形列表
+//  const unsigned int cube_3d_meshlet[4*N] = { 顶点起点, 顶点数, 三角形起点, 三角形数, ... };
+//  const float cube_3d_meshlet_bounds[8*N] = { 球心xyz, 半径, 法线锥的轴xyz, cutoff, ... };
+//  const unsigned short cube_3d_meshlet_vertex[...] = { 块内顶点对应的全局顶点序号 };
+//  const unsigned char cube_3d_meshlet_tri[...] = { 每个三角形3个块内的顶点序号 };
+static void GenCCodeMeshlet(SObjContext* pctx, const SObjOption* popt, SCWriter* pw, std::string name, const SIndexedMesh& mesh, std::vector<std::string>* pdecl_vec, std::vector<std::string>* pdef_vec)
+{
+    std::vector<float> pos_vec;
+    GetMeshAttrData(pctx, mesh, ATTR_KIND_POS, &pos_vec);
+    std::vector<SMeshlet> meshlet_vec;
+    std::vector<unsigned int> vertex_vec;
+    std::vector<unsigned char> tri_vec;
+    BuildMeshlets(mesh.index_vec, pos_vec, popt->meshlet_vertex, popt->meshlet_tri, &meshlet_vec, &vertex_vec, &tri_vec);
+
+    size_t meshlet_cnt = meshlet_vec.size();
+    int vertex_size = GetIndexSize(mesh.vertex_vec.size());
+    size_t i = 0;
+    if(popt->verbose)
+    {
+        size_t cull_cnt = 0;
+        for(i=0;i<meshlet_cnt;i++)
+        {
+            if(meshlet_vec[i].cone_cutoff < 1.0f) cull_cnt++;
+        }
+        printf("Meshlet(%d,%d) %d Meshlet, Avg %.1f Vertex %.1f Triangle/Meshlet, Cone Cullable %.1f%%\r\n",
+               popt->meshlet_vertex,
+               popt->meshlet_tri,
+               (int)meshlet_cnt,
+               (meshlet_cnt > 0) ? ((double)vertex_vec.size() / meshlet_cnt) : 0.0,
+               (meshlet_cnt > 0) ? ((double)(tri_vec.size() / 3) / meshlet_cnt) : 0.0,
+               (meshlet_cnt > 0) ? (100.0 * cull_cnt / meshlet_cnt) : 0.0
+              );
+    }
+
+    //  数量的宏定义
+    std::string upper_str = GetUpperString(name);
+    pdef_vec->push_back(GetDefineString(upper_str + "_3D_MESHLET_CNT", meshlet_cnt));
+    pdef_vec->push_back(GetDefineString(upper_str + "_3D_MESHLET_MAX_VERTEX", popt->meshlet_vertex));
+    pdef_vec->push_back(GetDefineString(upper_str + "_3D_MESHLET_MAX_TRI", popt->meshlet_tri));
+    pdef_vec->push_back(GetDefineString(upper_str + "_3D_MESHLET_VERTEX_CNT", vertex_vec.size()));
+    pdef_vec->push_back(GetDefineString(upper_str + "_3D_MESHLET_VERTEX_SIZE", vertex_size));
+    pdef_vec->push_back(GetDefineString(upper_str + "_3D_MESHLET_TRI_CNT", tri_vec.size() / 3));
+
+    //  描述表，每行一块
+    std::string decl_str = "const unsigned int " + name + "_3d_meshlet[" + std::to_string((unsigned long long)meshlet_cnt * 4) + "]";
+    pdecl_vec->push_back(decl_str);
+    CWriterPutStr(pw, decl_str);
+    CWriterPutStr(pw, " =\r\n{\r\n");
+    CWriterBeginArray(pw, name + "_3d_meshlet", sizeof(unsigned int), meshlet_cnt * 4);
+    for(i=0;i<meshlet_cnt;i++)
+    {
+        const SMeshlet& tmp_m = meshlet_vec[i];
+        CWriterPut(pw, "    ", 4);
+        CWriterPutUInt(pw, tmp_m.vertex_offset);
+        CWriterPut(pw, ", ", 2);
+        CWriterPutUInt(pw, tmp_m.vertex_cnt);
+        CWriterPut(pw, ", ", 2);
+        CWriterPutUInt(pw, tmp_m.tri_offset);
+        CWriterPut(pw, ", ", 2);
+        CWriterPutUInt(pw, tmp_m.tri_cnt);
+        CWriterPut(pw, ",\r\n", 3);
+    }
+    CWriterEndArray(pw);
+    CWriterPutStr(pw, "};\r\n");
+
+    //  包围球和法线锥，每行一块
+    decl_str = "const float " + name + "_3d_meshlet_bounds[" + std::to_string((unsigned long long)meshlet_cnt * 8) + "]";
+    pdecl_vec->push_back(decl_str);
+    CWriterPutStr(pw, decl_str);
+    CWriterPutStr(pw, " =\r\n{\r\n");
+    CWriterBeginArray(pw, name + "_3d_meshlet_bounds", sizeof(float), meshlet_cnt * 8);
+    for(i=0;i<meshlet_cnt;i++)
+    {
+        const SMeshlet& tmp_m = meshlet_vec[i];
+        float bound[8] = {tmp_m.center[0], tmp_m.center[1], tmp_m.center[2], tmp_m.radius,
+                          tmp_m.cone_axis[0], tmp_m.cone_axis[1], tmp_m.cone_axis[2], tmp_m.cone_cutoff};
+        int k = 0;
+        CWriterPut(pw, "    ", 4);
+        for(k=0;k<8;k++)
+        {
+            CWriterPutFloat(pw, bound[k]);
+            CWriterPut(pw, ", ", 2);
+        }
+        CWriterPut(pw, "\r\n", 2);
+    }
+    CWriterEndArray(pw);
+    CWriterPutStr(pw, "};\r\n");
+
+    //  顶点重映射表，每行一块
+    decl_str = "const ";
+    decl_str += GetIndexTypeString(vertex_size);
+    decl_str += " " + name + "_3d_meshlet_vertex[" + std::to_string((unsigned long long)vertex_vec.size()) + "]";
+    pdecl_vec->push_back(decl_str);
+    CWriterPutStr(pw, decl_str);
+    CWriterPutStr(pw, " =\r\n{\r\n");
+    CWriterBeginArray(pw, name + "_3d_meshlet_vertex", vertex_size, vertex_vec.size());
+    for(i=0;i<meshlet_cnt;i++)
+    {
+        const SMeshlet& tmp_m = meshlet_vec[i];
+        size_t j = 0;
+        CWriterPut(pw, "    ", 4);
+        for(j=0;j<tmp_m.vertex_cnt;j++)
+        {
+            CWriterPutUInt(pw, vertex_vec[tmp_m.vertex_offset + j]);
+            CWriterPut(pw, ", ", 2);
+        }
+        CWriterPut(pw, "\r\n", 2);
+    }
+    CWriterEndArray(pw);
+    CWriterPutStr(pw, "};\r\n");
+
+    //  块内的三角形，每行一个三角形
+    decl_str = "const unsigned char " + name + "_3d_meshlet_tri[" + std::to_string((unsigned long long)tri_vec.size()) + "]";
+    pdecl_vec->push_back(decl_str);
+    CWriterPutStr(pw, decl_str);
+    CWriterPutStr(pw, " =\r\n{\r\n");
+    CWriterBeginArray(pw, name + "_3d_meshlet_tri", 1, tri_vec.size());
+    for(i=0;i<tri_vec.size();i+=3)
+    {
+        CWriterPut(pw, "    ", 4);
+        CWriterPutUInt(pw, tri_vec[i]);
+        CWriterPut(pw, ", ", 2);
+        CWriterPutUInt(pw, tri_vec[i + 1]);
+        CWriterPut(pw, ", ", 2);
+        CWriterPutUInt(pw, tri_vec[i + 2]);
+        CWriterPut(pw, ",\r\n", 3);
+    }
+    CWriterEndArray(pw);
+    CWriterPutStr(pw, "};\r\n");
+}
+
+//  生成宏定义，值为逗号分隔的浮点数，用最短的可还原格式
+//  #define CUBE_3D_AABB_MIN    -1, -1, -1
+static std::string GetFloatDefineString(std::string name, const float* pval, int cnt)
+{
+    std::string re_str = "#define ";
+    re_str += name;
+    re_str += "    ";
+    int i = 0;
+    for(i=0;i<cnt;i++)
+    {
+        char tmp_str[FLOAT_STR_SIZE];
+        int len = FormatFloat(tmp_str, pval[i], FLOAT_FMT_SHORT, -1);
+        if(i > 0) re_str += ", ";
+        re_str.append(tmp_str, len);
+    }
+    return re_str;
+}
+
+//  判断是否输出为文本的代码，C代码或者C++头文件时返回1
+static int IsTextOutput(const SObjOption* popt)
+{
+    return (popt->out_mode == OUT_MODE_C) || (popt->out_mode == OUT_MODE_CPP);
+}
+
+//  C代码中的顶点坐标按小数位数舍入后的最大误差，BVH的包围盒需要向外扩大这个距离
+static double GetTextRoundError(const SObjOption* popt)
+{
+    if(!IsTextOutput(popt)) return 0.0;
+    if((popt->float_fmt == FLOAT_FMT_HEX) || ((popt->float_fmt == FLOAT_FMT_SHORT) && (popt->float_precision < 0))) return 0.0;
+    int precision = (popt->float_precision < 0) ? FLOAT_DEFAULT_PRECISION : popt->float_precision;
+    if(precision > FLOAT_MAX_PRECISION) precision = FLOAT_MAX_PRECISION;
+    return 0.5 * pow(10.0, -precision);
+}
+
+//  生成三角形列表的BVH，三角形的序号为在索引数组中的位置，非索引输出模式下为在顶点数组中的位置，都要除以3
+//  顶点坐标写入时有舍入或者量化的误差，包围盒的每个面向外扩大pad，保证解码后的顶点仍在包围盒内
+//  包围盒用可还原的格式写入，不受小数位数的影响
+static void GenCCodeBvh(SObjContext* pctx, const SObjOption* popt, SCWriter* pw, std::string name, const SIndexedMesh& mesh, double pad, std::vector<std::string>* pdecl_vec, std::vector<std::string>* pdef_vec)
+{
+    std::vector<float> pos_vec;
+    GetMeshAttrData(pctx, mesh, ATTR_KIND_POS, &pos_vec);
+    std::vector<SBvhNode> node_vec;
+    std::vector<unsigned int> tri_vec;
+    BuildBvh(mesh.index_vec, pos_vec, popt->bvh_leaf, &node_vec, &tri_vec);
+
+    size_t node_cnt = node_vec.size();
+    size_t i = 0;
+    int k = 0;
+    if(pad > 0.0)
+    {
+        for(i=0;i<node_cnt;i++)
+        {
+            for(k=0;k<3;k++)
+            {
+                node_vec[i].bound_min[k] = nextafterf((float)(node_vec[i].bound_min[k] - pad), -INFINITY);
+                node_vec[i].bound_max[k] = nextafterf((float)(node_vec[i].bound_max[k] + pad), INFINITY);
+            }
+        }
+    }
+
+    if(popt->verbose)
+    {
+        size_t leaf_cnt = 0;
+        size_t max_depth = 0;
+        double sah_cost = 0.0;
+        AnalyzeBvh(node_vec, &leaf_cnt, &max_depth, &sah_cost);
+        printf("BVH(%d) %d Node, %d Leaf, Avg %.2f Triangle/Leaf, Max Depth %d, SAH Cost %.2f\r\n",
+               popt->bvh_leaf,
+               (int)node_cnt,
+               (int)leaf_cnt,
+               (leaf_cnt > 0) ? ((double)tri_vec.size() / leaf_cnt) : 0.0,
+               (int)max_depth,
+               sah_cost
+              );
+    }
+
+    //  数量的宏定义和整个网格的包围盒
+    std::string upper_str = GetUpperString(name);
+    int tri_size = GetIndexSize(tri_vec.size());
+    pdef_vec->push_back(GetDefineString(upper_str + "_3D_BVH_NODE_CNT", node_cnt));
+    pdef_vec->push_back(GetDefineString(upper_str + "_3D_BVH_LEAF_TRI", popt->bvh_leaf));
+    pdef_vec->push_back(GetDefineString(upper_str + "_3D_BVH_TRI_CNT", tri_vec.size()));
+    pdef_vec->push_back(GetDefineString(upper_str + "_3D_BVH_TRI_SIZE", tri_size));
+    if(node_cnt > 0)
+    {
+        pdef_vec->push_back(GetFloatDefineString(upper_str + "_3D_AABB_MIN", node_vec[0].bound_min, 3));
+        pdef_vec->push_back(GetFloatDefineString(upper_str + "_3D_AABB_MAX", node_vec[0].bound_max, 3));
+    }
+
+    //  节点的链接，每行一个节点，为(右子节点或者三角形的起点, 三角形个数)
+    std::string decl_str = "const unsigned int " + name + "_3d_bvh_node[" + std::to_string((unsigned long long)node_cnt * 2) + "]";
+    pdecl_vec->push_back(decl_str);
+    CWriterPutStr(pw, decl_str);
+    CWriterPutStr(pw, " =\r\n{\r\n");
+    CWriterBeginArray(pw, name + "_3d_bvh_node", sizeof(unsigned int), node_cnt * 2);
+    for(i=0;i<node_cnt;i++)
+    {
+        CWriterPut(pw, "    ", 4);
+        CWriterPutUInt(pw, node_vec[i].index);
+        CWriterPut(pw, ", ", 2);
+        CWriterPutUInt(pw, node_vec[i].tri_cnt);
+        CWriterPut(pw, ",\r\n", 3);
+    }
+    CWriterEndArray(pw);
+    CWriterPutStr(pw, "};\r\n");
+
+    //  节点的包围盒，每行一个节点，为(最小xyz, 最大xyz)
+    int box_fmt = (popt->float_fmt == FLOAT_FMT_HEX) ? FLOAT_FMT_HEX : FLOAT_FMT_SHORT;
+    decl_str = "const float " + name + "_3d_bvh_box[" + std::to_string((unsigned long long)node_cnt * 6) + "]";
+    pdecl_vec->push_back(decl_str);
+    CWriterPutStr(pw, decl_str);
+    CWriterPutStr(pw, " =\r\n{\r\n");
+    CWriterBeginArray(pw, name + "_3d_bvh_box", sizeof(float), node_cnt * 6);
+    for(i=0;i<node_cnt;i++)
+    {
+        CWriterPut(pw, "    ", 4);
+        for(k=0;k<3;k++)
+        {
+            CWriterPutFloatFmt(pw, node_vec[i].bound_min[k], box_fmt, -1);
+            CWriterPut(pw, ", ", 2);
+        }
+        for(k=0;k<3;k++)
+        {
+            CWriterPutFloatFmt(pw, node_vec[i].bound_max[k], box_fmt, -1);
+            CWriterPut(pw, ", ", 2);
+        }
+        CWriterPut(pw, "\r\n", 2);
+    }
+    CWriterEndArray(pw);
+    CWriterPutStr(pw, "};\r\n");
+
+    //  叶节点引用的三角形序号，每行一个叶节点
+    decl_str = "const ";
+    decl_str += GetIndexTypeString(tri_size);
+    decl_str += " " + name + "_3d_bvh_tri[" + std::to_string((unsigned long long)tri_vec.size()) + "]";
+    pdecl_vec->push_back(decl_str);
+    CWriterPutStr(pw, decl_str);
+    CWriterPutStr(pw, " =\r\n{\r\n");
+    CWriterBeginArray(pw, name + "_3d_bvh_tri", tri_size, tri_vec.size());
+    for(i=0;i<node_cnt;i++)
+    {
+        if(node_vec[i].tri_cnt == 0) continue;
+        unsigned int j = 0;
+        CWriterPut(pw, "    ", 4);
+        for(j=0;j<node_vec[i].tri_cnt;j++)
+        {
+            CWriterPutUInt(pw, tri_vec[node_vec[i].index + j]);
+            CWriterPut(pw, ", ", 2);
+        }
+        CWriterPut(pw, "\r\n", 2);
+    }
+    CWriterEndArray(pw);
+    CWriterPutStr(pw, "};\r\n");
+}
+
+//  切换距离按1080像素高、垂直视角60度的视图计算，误差在这个距离上为1个像素
+//  其他分辨率和视角按比例缩放
+#define LOD_VIEW_HEIGHT         1080.0
+#define LOD_VIEW_FOV            60.0
+
+//  生成简化后的多级细节，共用已经生成的顶点数据，每一级生成单独的索引数组
+//  切换表每行一级，为(误差, 切换距离)，第0级为原网格的xx_3d_index，距离超过切换距离时可以使用这一级
+static void GenCCodeLod(SObjContext* pctx, const SObjOption* popt, SCWriter* pw, std::string name, const SIndexedMesh& mesh, int index_size, std::vector<std::string>* pdecl_vec, std::vector<std::string>* pdef_vec)
+{
+    std::vector<float> pos_vec;
+    GetMeshAttrData(pctx, mesh, ATTR_KIND_POS, &pos_vec);
+    std::vector<std::vector<unsigned int> > lod_vec;
+    std::vector<double> error_vec;
+    SimplifyMesh(mesh.index_vec, pos_vec, popt->lod_target, popt->lod_vec, &lod_vec, &error_vec);
+
+    double dist_scale = LOD_VIEW_HEIGHT / (2.0 * tan(LOD_VIEW_FOV * M_PI / 360.0));
+    size_t tri_cnt = mesh.index_vec.size() / 3;
+    std::string upper_str = GetUpperString(name);
+    pdef_vec->push_back(GetDefineString(upper_str + "_3D_LOD_CNT", lod_vec.size() + 1));
+
+    size_t k = 0;
+    for(k=0;k<lod_vec.size();k++)
+    {
+        if(popt->vcache_opt) OptimizeVertexCache(&lod_vec[k], mesh.vertex_vec.size());
+        if(popt->verbose) printf("LOD%d %d -> %d Triangle (%.1f%%), Error %g, Switch Distance %g\r\n",
+                                 (int)(k + 1),
+                                 (int)tri_cnt,
+                                 (int)(lod_vec[k].size() / 3),
+                                 (tri_cnt > 0) ? (100.0 * (lod_vec[k].size() / 3) / tri_cnt) : 0.0,
+                                 error_vec[k],
+                                 error_vec[k] * dist_scale
+                                );
+
+        //  const unsigned short cube_3d_lod1_index[18] =
+        //  {
+        std::string array_name = name + "_3d_lod" + std::to_string((unsigned long long)(k + 1)) + "_index";
+        size_t index_cnt = lod_vec[k].size();
+        pdef_vec->push_back(GetDefineString(GetUpperString(array_name) + "_CNT", index_cnt));
+        std::string decl_str = "const ";
+        decl_str += GetIndexTypeString(index_size);
+        decl_str += " " + array_name + "[" + std::to_string((unsigned long long)index_cnt) + "]";
+        pdecl_vec->push_back(decl_str);
+        CWriterPutStr(pw, decl_str);
+        CWriterPutStr(pw, " =\r\n{\r\n");
+        CWriterBeginArray(pw, array_name, index_size, index_cnt);
+        size_t i = 0;
+        for(i=0;i<index_cnt;i+=3)
+        {
+            CWriterPut(pw, "    ", 4);
+            CWriterPutUInt(pw, lod_vec[k][i]);
+            CWriterPut(pw, ", ", 2);
+            CWriterPutUInt(pw, lod_vec[k][i + 1]);
+            CWriterPut(pw, ", ", 2);
+            CWriterPutUInt(pw, lod_vec[k][i + 2]);
+            CWriterPut(pw, ",\r\n", 3);
+        }
+        CWriterEndArray(pw);
+        CWriterPutStr(pw, "};\r\n");
+    }
+
+    //  切换表
+    std::string decl_str = "const float " + name + "_3d_lod_switch[" + std::to_string((unsigned long long)(lod_vec.size() + 1) * 2) + "]";
+    pdecl_vec->push_back(decl_str);
+    CWriterPutStr(pw, decl_str);
+    CWriterPutStr(pw, " =\r\n{\r\n");
+    CWriterBeginArray(pw, name + "_3d_lod_switch", sizeof(float), (lod_vec.size() + 1) * 2);
+    for(k=0;k<=lod_vec.size();k++)
+    {
+        double err = (k > 0) ? error_vec[k - 1] : 0.0;
+        CWriterPut(pw, "    ", 4);
+        CWriterPutFloat(pw, (float)err);
+        CWriterPut(pw, ", ", 2);
+        CWriterPutFloat(pw, (float)(err * dist_scale));
+        CWriterPut(pw, ",\r\n", 3);
+    }
+    CWriterEndArray(pw);
+    CWriterPutStr(pw, "};\r\n");
+}
+
+//  OBJ文件中没有法线时生成平滑法线，加入VertexNormalVec并设置每个点的法线索引
+//  只在生成等级为3时保存法线索引，存在无效的顶点索引时不生成，由后面的生成报告错误
+static void GenContextNormals(SObjContext* pctx, const SObjOption* popt)
+{
+    if((popt->normal_crease < 0.0) || (pctx->gen_level < 3) || !pctx->VertexNormalVec.empty()) return;
+
+    //  每个点的顶点序号
+    std::vector<unsigned int> index_vec(PlaneListSize(pctx->PlaneList) * 3);
+    size_t i = 0;
+    for(i=0;i<index_vec.size();i++)
+    {
+        int point_index = -1;
+        int uv_index = -1;
+        int vn_index = -1;
+        PlaneListGetCorner(pctx->PlaneList, i, &point_index, &uv_index, &vn_index);
+        if((point_index < 0) || (point_index >= (int)pctx->VertexVec.size())) return;
+        index_vec[i] = (unsigned int)point_index;
+    }
+    std::vector<float> pos_vec(pctx->VertexVec.size() * 3);
+    for(i=0;i<pctx->VertexVec.size();i++)
+    {
+        pos_vec[(i * 3) + 0] = pctx->VertexVec[i].x;
+        pos_vec[(i * 3) + 1] = pctx->VertexVec[i].y;
+        pos_vec[(i * 3) + 2] = pctx->VertexVec[i].z;
+    }
+
+    std::vector<float> normal_vec;
+    std::vector<unsigned int> corner_vec;
+    GenerateNormals(index_vec, pos_vec, popt->normal_crease, popt->thread_num, &normal_vec, &corner_vec);
+
+    pctx->VertexNormalVec.resize(normal_vec.size() / 3);
+    for(i=0;i<pctx->VertexNormalVec.size();i++)
+    {
+        pctx->VertexNormalVec[i].x = normal_vec[(i * 3) + 0];
+        pctx->VertexNormalVec[i].y = normal_vec[(i * 3) + 1];
+        pctx->VertexNormalVec[i].z = normal_vec[(i * 3) + 2];
+    }
+    for(i=0;i<corner_vec.size();i++)
+    {
+        *PlaneListSlot(&pctx->PlaneList, i / 3, ((i % 3) * 3) + 2) = (int)corner_vec[i];
+    }
+    if(popt->verbose) printf("Generate %d Normal, Crease %g\r\n", (int)pctx->VertexNormalVec.size(), popt->normal_crease);
+}
+
+//  计算网格每个顶点的切线空间，每个顶点4个float
+//  按三角形展开时(v,vt,vn)相同的点一起累加，与索引输出模式相同
+static void GetMeshTangentData(SObjContext* pctx, const SObjOption* popt, const SIndexedMesh& mesh, std::vector<float>* ptangent_vec)
+{
+    std::vector<float> pos_vec;
+    std::vector<float> uv_vec;
+    std::vector<float> normal_vec;
+    GetMeshAttrData(pctx, mesh, ATTR_KIND_POS, &pos_vec);
+    GetMeshAttrData(pctx, mesh, ATTR_KIND_UV, &uv_vec);
+    GetMeshAttrData(pctx, mesh, ATTR_KIND_NORMAL, &normal_vec);
+
+    //  按三角形展开时，索引化结果中每个点的顶点序号就是焊接序号
+    std::vector<unsigned int> weld_vec;
+    if(!popt->index_mode)
+    {
+        SIndexedMesh weld_mesh;
+        BuildIndexedMesh(pctx->PlaneList, pctx->VertexVec.size(), pctx->UVVec.size(), pctx->VertexNormalVec.size(), &weld_mesh);
+        weld_vec.swap(weld_mesh.index_vec);
+    }
+    GenerateTangents(mesh.index_vec, weld_vec, pos_vec, uv_vec, normal_vec, popt->thread_num, ptangent_vec);
+}
+
+//  生成C++的一个constexpr数值
+//  inline constexpr std::size_t vertex_cnt = 24;
+static void GenCppCodeConst(SCWriter* pw, const char* ptype, std::string name, std::string val_str)
+{
+    CWriterPutStr(pw, "inline constexpr " + std::string(ptype) + " " + name + " = " + val_str + ";\r\n");
+}
+
+//  生成C++的constexpr浮点数组，用可还原的格式写入
+//  inline constexpr std::array<float, 3> aabb_min = {{ -1, -1, -1 }};
+static void GenCppCodeFloatArray(SCWriter* pw, std::string name, const float* pval, int cnt)
+{
+    CWriterPutStr(pw, "inline constexpr std::array<float, " + std::to_string(cnt) + "> " + name + " = {{ ");
+    int k = 0;
+    for(k=0;k<cnt;k++)
+    {
+        CWriterPutFloatFmt(pw, pval[k], (pw->float_fmt == FLOAT_FMT_FIXED) ? FLOAT_FMT_SHORT : pw->float_fmt, -1);
+        CWriterPutStr(pw, (k < (cnt - 1)) ? ", " : " ");
+    }
+    CWriterPutStr(pw, "}};\r\n");
+}
+
+//  生成C++17的网格数据，全部放在name_3d命名空间中
+//  顶点结构体的成员按分量的字节数从大到小排列，没有隐含的填充，总字节数不是对齐的整数倍时在末尾显式填充
+//  顶点和索引数据为constexpr std::array，数量、包围盒、每种属性的编码和反量化参数都是constexpr常量
+//  包围盒的每个面向外扩大pad，保证解码后的顶点仍在包围盒内
+static void GenCppCodeMesh(SObjContext* pctx, const SObjOption* popt, SCWriter* pw, std::string name, const SIndexedMesh& mesh, const int* attr_fmt, const int* attr_exist, const std::vector<float>& tangent_vec, int index_size, double pad)
+{
+    const char* attr_name[4] = {"pos", "uv", "normal", "tangent"};
+    size_t vertex_cnt = mesh.vertex_vec.size();
+    size_t index_cnt = popt->index_mode ? mesh.index_vec.size() : 0;
+    size_t i = 0;
+    int k = 0;
+
+    //  每种属性的数据和编码参数
+    std::vector<float> data_vec[4];
+    SQuantRange range_vec[4];
+    int comp_vec[4];
+    int out_comp_vec[4];
+    int kind = 0;
+    for(kind=0;kind<4;kind++)
+    {
+        if(!attr_exist[kind]) continue;
+        if(kind == ATTR_KIND_TANGENT) data_vec[kind] = tangent_vec;
+        else                          GetMeshAttrData(pctx, mesh, kind, &data_vec[kind]);
+        comp_vec[kind] = GetAttrKindComp(kind);
+        out_comp_vec[kind] = ((attr_fmt[kind] == ATTR_FMT_OCT8) || (attr_fmt[kind] == ATTR_FMT_OCT16)) ? 2 : comp_vec[kind];
+        GetQuantRange(data_vec[kind].data(), vertex_cnt, comp_vec[kind], attr_fmt[kind], &range_vec[kind]);
+    }
+
+    //  成员按分量的字节数4/2/1排列，同样字节数的保持pos/uv/normal/tangent的顺序
+    std::vector<int> member_vec;
+    int elem_size = 0;
+    int vertex_size = 0;
+    int vertex_align = 1;
+    for(elem_size=4;elem_size>=1;elem_size/=2)
+    {
+        for(kind=0;kind<4;kind++)
+        {
+            if(!attr_exist[kind]) continue;
+            if((GetAttrFormatSize(kind, attr_fmt[kind]) / out_comp_vec[kind]) != elem_size) continue;
+            member_vec.push_back(kind);
+            vertex_size += GetAttrFormatSize(kind, attr_fmt[kind]);
+            if(elem_size > vertex_align) vertex_align = elem_size;
+        }
+    }
+    int pad_size = (vertex_align - (vertex_size % vertex_align)) % vertex_align;
+
+    //  namespace cube_3d
+    //  {
+    CWriterPutStr(pw, "namespace " + name + "_3d\r\n{\r\n");
+
+    //  顶点结构体
+    //  struct vertex
+    //  {
+    //      float pos[3];
+    //  };
+    CWriterPutStr(pw, "struct vertex\r\n{\r\n");
+    for(i=0;i<member_vec.size();i++)
+    {
+        kind = member_vec[i];
+        CWriterPutStr(pw, "    " + std::string(GetAttrFormatCType(attr_fmt[kind])) + " " + attr_name[kind] + "[" + std::to_string(out_comp_vec[kind]) + "];\r\n");
+    }
+    if(pad_size > 0) CWriterPutStr(pw, "    unsigned char pad[" + std::to_string(pad_size) + "];\r\n");
+    CWriterPutStr(pw, "};\r\n");
+
+    //  结构体的布局检查
+    //  static_assert(sizeof(vertex) == 32, "vertex size");
+    CWriterPutStr(pw, "static_assert(sizeof(vertex) == " + std::to_string(vertex_size + pad_size) + ", \"vertex size\");\r\n");
+    CWriterPutStr(pw, "static_assert(alignof(vertex) == " + std::to_string(vertex_align) + ", \"vertex alignment\");\r\n");
+    int offset = 0;
+    for(i=0;i<member_vec.size();i++)
+    {
+        kind = member_vec[i];
+        CWriterPutStr(pw, "static_assert(offsetof(vertex, " + std::string(attr_name[kind]) + ") == " + std::to_string(offset) + ", \"vertex " + attr_name[kind] + " offset\");\r\n");
+        offset += GetAttrFormatSize(kind, attr_fmt[kind]);
+    }
+
+    //  数量
+    GenCppCodeConst(pw, "std::size_t", "vertex_cnt", std::to_string((unsigned long long)vertex_cnt));
+    GenCppCodeConst(pw, "std::size_t", "index_cnt", std::to_string((unsigned long long)index_cnt));
+    GenCppCodeConst(pw, "std::size_t", "tri_cnt", std::to_string((unsigned long long)(popt->index_mode ? index_cnt : vertex_cnt) / 3));
+    GenCppCodeConst(pw, "std::size_t", "vertex_stride", "sizeof(vertex)");
+
+    //  包围盒
+    float box[6] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    const std::vector<float>& pos_vec = data_vec[ATTR_KIND_POS];
+    for(i=0;i<vertex_cnt;i++)
+    {
+        for(k=0;k<3;k++)
+        {
+            if((i == 0) || (pos_vec[i * 3 + k] < box[k]))     box[k] = pos_vec[i * 3 + k];
+            if((i == 0) || (pos_vec[i * 3 + k] > box[k + 3])) box[k + 3] = pos_vec[i * 3 + k];
+        }
+    }
+    if((pad > 0.0) && (vertex_cnt > 0))
+    {
+        for(k=0;k<3;k++)
+        {
+            box[k] = nextafterf((float)(box[k] - pad), -INFINITY);
+            box[k + 3] = nextafterf((float)(box[k + 3] + pad), INFINITY);
+        }
+    }
+    GenCppCodeFloatArray(pw, "aabb_min", &box[0], 3);
+    GenCppCodeFloatArray(pw, "aabb_max", &box[3], 3);
+
+    //  每种属性的OpenGL ES数据格式，需要反量化时给出offset和scale
+    //  inline constexpr unsigned int pos_gl_type = 0x1406;
+    for(i=0;i<member_vec.size();i++)
+    {
+        kind = member_vec[i];
+        int fmt = attr_fmt[kind];
+        std::string attr_str = attr_name[kind];
+        char num_str[32];
+        snprintf(num_str, sizeof(num_str), "0x%04X", GetAttrFormatGLType(fmt));
+        GenCppCodeConst(pw, "unsigned int", attr_str + "_gl_type", num_str);
+        GenCppCodeConst(pw, "int", attr_str + "_comp", std::to_string(out_comp_vec[kind]));
+        GenCppCodeConst(pw, "bool", attr_str + "_normalized", ((fmt == ATTR_FMT_F32) || (fmt == ATTR_FMT_F16)) ? "false" : "true");
+        GenCppCodeConst(pw, "bool", attr_str + "_oct", (out_comp_vec[kind] != comp_vec[kind]) ? "true" : "false");
+        if((fmt == ATTR_FMT_SNORM16) || (fmt == ATTR_FMT_UNORM16))
+        {
+            GenCppCodeFloatArray(pw, attr_str + "_offset", range_vec[kind].offset, comp_vec[kind]);
+            GenCppCodeFloatArray(pw, attr_str + "_scale", range_vec[kind].scale, comp_vec[kind]);
+        }
+    }
+
+    //  顶点数据，每行一个顶点
+    //  inline constexpr std::array<vertex, 24> vertex_data =
+    //  {{
+    //      { { 1.000000, 1.000000, -1.000000 }, { 0.625000, 0.500000 } },
+    //  }};
+    //  显式填充的字节写为0
+    CWriterPutStr(pw, "inline constexpr std::array<vertex, " + std::to_string((unsigned long long)vertex_cnt) + "> vertex_data =\r\n{{\r\n");
+    for(i=0;i<vertex_cnt;i++)
+    {
+        CWriterPut(pw, "    {", 5);
+        size_t m = 0;
+        for(m=0;m<member_vec.size();m++)
+        {
+            kind = member_vec[m];
+            const float* pin = &data_vec[kind][i * comp_vec[kind]];
+            int code[4];
+            if(attr_fmt[kind] != ATTR_FMT_F32) EncodeAttr(pin, comp_vec[kind], attr_fmt[kind], &range_vec[kind], code);
+            CWriterPut(pw, " { ", 3);
+            for(k=0;k<out_comp_vec[kind];k++)
+            {
+                if(attr_fmt[kind] == ATTR_FMT_F32) CWriterPutFloat(pw, pin[k]);
+                else                               CWriterPutInt(pw, code[k]);
+                if(k < (out_comp_vec[kind] - 1)) CWriterPut(pw, ", ", 2);
+            }
+            CWriterPut(pw, (m < (member_vec.size() - 1)) ? " }," : " }", (m < (member_vec.size() - 1)) ? 3 : 2);
+        }
+        for(k=0;k<pad_size;k++)
+        {
+            CWriterPutStr(pw, (k == 0) ? ", { 0" : ", 0");
+            if(k == (pad_size - 1)) CWriterPut(pw, " }", 2);
+        }
+        CWriterPut(pw, " },\r\n", 5);
+    }
+    CWriterPutStr(pw, "}};\r\n");
+
+    //  索引数据，每行一个三角形
+    //  inline constexpr std::array<unsigned char, 36> index_data =
+    //  {{
+    if(popt->index_mode)
+    {
+        CWriterPutStr(pw, "using index_type = " + std::string(GetIndexTypeString(index_size)) + ";\r\n");
+        CWriterPutStr(pw, "inline constexpr std::array<index_type, " + std::to_string((unsigned long long)index_cnt) + "> index_data =\r\n{{\r\n");
+        for(i=0;i<index_cnt;i+=3)
+        {
+            CWriterPut(pw, "    ", 4);
+            CWriterPutUInt(pw, mesh.index_vec[i]);
+            CWriterPut(pw, ", ", 2);
+            CWriterPutUInt(pw, mesh.index_vec[i + 1]);
+            CWriterPut(pw, ", ", 2);
+            CWriterPutUInt(pw, mesh.index_vec[i + 2]);
+            CWriterPut(pw, ",\r\n", 3);
+        }
+        CWriterPutStr(pw, "}};\r\n");
+    }
+
+    //  }
+    CWriterPutStr(pw, "}\r\n");
+}
+
+//  生成网格数据
+//  索引输出模式下生成去重后的顶点数据和三角形索引数据，否则每个点都作为单独的顶点
+//  属性编码不全是32位浮点时，每种属性生成单独的数组，指定布局时按布局分组生成数组
+//  数组的声明加入pdecl_vec，数量的宏定义加入pdef_vec，成功返回0
+static int GenCCodeMesh(SObjContext* pctx, const SObjOption* popt, SCWriter* pw, std::string name, std::vector<SDrawBatch>* pbatch_vec, std::vector<std::string>* pdecl_vec, std::vector<std::string>* pdef_vec)
+{
+    //  meshlet由三角形列表拆分
+    if((popt->meshlet_tri > 0) && (popt->strip_mode >= 0))
+    {
+        printf("Meshlet Not Support Strip!!\r\n");
+        return -4;
+    }
+
+    //  绘制批次是三角形列表中连续的一段
+    if((pbatch_vec != 0) && ((popt->strip_mode >= 0) || (popt->meshlet_tri > 0)))
+    {
+        printf("Batch Not Support Strip Or Meshlet!!\r\n");
+        return -4;
+    }
+
+    //  多级细节共用索引输出模式的顶点数据，每一级是完整网格的三角形列表
+    if(!popt->lod_vec.empty() && (!popt->index_mode || (popt->strip_mode >= 0) || (pbatch_vec != 0)))
+    {
+        printf("LOD Need Index Mode, Not Support Strip Or Batch!!\r\n");
+        return -4;
+    }
+
+    //  C++输出只有一个顶点结构体数组和三角形列表
+    if((popt->out_mode == OUT_MODE_CPP) && (!popt->layout_vec.empty() || (popt->strip_mode >= 0) || (popt->meshlet_tri > 0) || (pbatch_vec != 0) || (popt->bvh_leaf > 0) || !popt->lod_vec.empty()))
+    {
+        printf("C++ Output Not Support Layout, Strip, Meshlet, Batch, BVH Or LOD!!\r\n");
+        return -4;
+    }
+
+    //  按遮挡关系排列的是三角形列表，转换为三角形带时会重新排列
+    if((popt->overdraw_threshold > 0.0) && (popt->strip_mode >= 0))
+    {
+        printf("Overdraw Not Support Strip!!\r\n");
+        return -4;
+    }
+
+    //  BVH引用的是三角形列表中的三角形
+    if((popt->bvh_leaf > 0) && (popt->strip_mode >= 0))
+    {
+        printf("BVH Not Support Strip!!\r\n");
+        return -4;
+    }
+
+    //  索引化
+    SIndexedMesh mesh;
+    if(popt->index_mode)
+    {
+        if(BuildIndexedMesh(pctx->PlaneList, pctx->VertexVec.size(), pctx->UVVec.size(), pctx->VertexNormalVec.size(), &mesh) != 0) return -2;
+    }
+    else
+    {
+        if(BuildFlatMesh(pctx->PlaneList, pctx->VertexVec.size(), pctx->UVVec.size(), pctx->VertexNormalVec.size(), &mesh) != 0) return -2;
+    }
+
+    size_t vertex_cnt = mesh.vertex_vec.size();
+    size_t index_cnt = mesh.index_vec.size();
+    int index_size = GetIndexSize(vertex_cnt);
+    unsigned int dot_float = GetDotFloatCount(!pctx->UVVec.empty(), !pctx->VertexNormalVec.empty());
+
+    if(popt->index_mode && popt->verbose)
+    {
+        printf("Indexed %d Dot -> %d Vertex, Index Size = %d\r\n", (int)index_cnt, (int)vertex_cnt, index_size);
+    }
+
+    //  确定各属性的编码，自动选择时按允许的最大误差选择，没有指定误差时使用32位浮点
+    //  切线只支持32位浮点
+    int attr_fmt[4] = {popt->pos_fmt, popt->uv_fmt, popt->normal_fmt, ATTR_FMT_F32};
+    int attr_exist[4] = {1, pctx->UVVec.size() > 0, pctx->VertexNormalVec.size() > 0, popt->tangent};
+    const char* attr_name[4] = {"pos", "uv", "normal", "tangent"};
+    unsigned int vertex_size = 0;
+    double pos_error = 0.0;
+    int kind = 0;
+    std::vector<float> data_vec;
+    for(kind=0;kind<3;kind++)
+    {
+        if(!attr_exist[kind])
+        {
+            attr_fmt[kind] = ATTR_FMT_F32;
+            continue;
+        }
+
+        GetMeshAttrData(pctx, mesh, kind, &data_vec);
+        double err = 0.0;
+        if(attr_fmt[kind] == ATTR_FMT_AUTO)
+        {
+            if(popt->max_error >= 0.0) attr_fmt[kind] = ChooseAttrFormat(data_vec.data(), vertex_cnt, kind, popt->max_error, &err);
+            else                 attr_fmt[kind] = ATTR_FMT_F32;
+        }
+        else
+        {
+            err = GetEncodeError(data_vec.data(), vertex_cnt, kind, attr_fmt[kind]);
+        }
+        vertex_size += GetAttrFormatSize(kind, attr_fmt[kind]);
+        if((kind == ATTR_KIND_POS) && (attr_fmt[kind] != ATTR_FMT_F32)) pos_error = err;
+
+        if((attr_fmt[kind] != ATTR_FMT_F32) && popt->verbose)
+        {
+            printf("Attr %s Format = %s, Max Error = %g\r\n", attr_name[kind], GetAttrFormatName(attr_fmt[kind]), err);
+        }
+    }
+    if(attr_exist[ATTR_KIND_TANGENT]) vertex_size += GetAttrFormatSize(ATTR_KIND_TANGENT, ATTR_FMT_F32);
+    int encoded = (attr_fmt[0] != ATTR_FMT_F32) || (attr_fmt[1] != ATTR_FMT_F32) || (attr_fmt[2] != ATTR_FMT_F32);
+
+    //  按照顶点缓存命中率重新排列三角形，并报告优化前后的ACMR和ATVR
+    if(popt->index_mode && popt->vcache_opt)
+    {
+        double acmr_old = 0.0;
+        double atvr_old = 0.0;
+        double acmr_new = 0.0;
+        double atvr_new = 0.0;
+        AnalyzeVertexCache(mesh.index_vec, vertex_cnt, VCACHE_STAT_SIZE, &acmr_old, &atvr_old);
+        if(pbatch_vec == 0) OptimizeVertexCache(&mesh.index_vec, vertex_cnt);
+        else                OptimizeBatchVertexCache(&mesh.index_vec, *pbatch_vec);
+        AnalyzeVertexCache(mesh.index_vec, vertex_cnt, VCACHE_STAT_SIZE, &acmr_new, &atvr_new);
+        if(popt->verbose) printf("Vertex Cache(FIFO %d) ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\r\n",
+                                 VCACHE_STAT_SIZE,
+                                 acmr_old,
+                                 acmr_new,
+                                 atvr_old,
+                                 atvr_new
+                                );
+    }
+
+    //  在顶点缓存的顺序上按簇重新排列，减少过度绘制，并报告软件光栅化估计的过度绘制和ACMR
+    if(popt->index_mode && (popt->overdraw_threshold > 0.0))
+    {
+        std::vector<float> pos_vec;
+        GetMeshAttrData(pctx, mesh, ATTR_KIND_POS, &pos_vec);
+        double over_old = 0.0;
+        double over_new = 0.0;
+        double acmr_old = 0.0;
+        double acmr_new = 0.0;
+        double atvr = 0.0;
+        size_t cluster_cnt = 0;
+        if(popt->verbose)
+        {
+            over_old = AnalyzeOverdraw(mesh.index_vec, pos_vec);
+            AnalyzeVertexCache(mesh.index_vec, vertex_cnt, VCACHE_STAT_SIZE, &acmr_old, &atvr);
+        }
+        if(pbatch_vec == 0) OptimizeOverdraw(&mesh.index_vec, pos_vec, popt->overdraw_threshold, &cluster_cnt);
+        else                OptimizeBatchOverdraw(&mesh.index_vec, *pbatch_vec, pos_vec, popt->overdraw_threshold, &cluster_cnt);
+        if(popt->verbose)
+        {
+            over_new = AnalyzeOverdraw(mesh.index_vec, pos_vec);
+            AnalyzeVertexCache(mesh.index_vec, vertex_cnt, VCACHE_STAT_SIZE, &acmr_new, &atvr);
+            printf("Overdraw(%d View %dx%d) %.3f -> %.3f, %d Cluster, ACMR %.3f -> %.3f\r\n",
+                   6,
+                   OVERDRAW_VIEW_SIZE,
+                   OVERDRAW_VIEW_SIZE,
+                   over_old,
+                   over_new,
+                   (int)cluster_cnt,
+                   acmr_old,
+                   acmr_new
+                  );
+        }
+    }
+
+    //  按照首次使用的顺序重新排列顶点数据，并报告优化前后平均每个顶点读取的字节数
+    if(popt->index_mode && popt->vfetch_opt)
+    {
+        double bytes_old = 0.0;
+        double over_old = 0.0;
+        double bytes_new = 0.0;
+        double over_new = 0.0;
+        AnalyzeVertexFetch(mesh.index_vec, vertex_cnt, vertex_size, &bytes_old, &over_old);
+        OptimizeVertexFetch(&mesh);
+        vertex_cnt = mesh.vertex_vec.size();
+        AnalyzeVertexFetch(mesh.index_vec, vertex_cnt, vertex_size, &bytes_new, &over_new);
+        if(popt->verbose) printf("Vertex Fetch(%d Byte/Vertex) Byte/Shaded %.2f -> %.2f, Overfetch %.3f -> %.3f\r\n",
+                                 (int)vertex_size,
+                                 bytes_old,
+                                 bytes_new,
+                                 over_old,
+                                 over_new
+                                );
+    }
+
+    //  切线空间按最终的顶点顺序计算，需要在转换为三角形带之前
+    std::vector<float> tangent_vec;
+    if(popt->tangent) GetMeshTangentData(pctx, popt, mesh, &tangent_vec);
+
+    //  转换为三角形带，并报告平均长度和与三角形列表相比节省的索引个数
+    //  图元重启索引为索引类型的最大值，不能与顶点序号重复
+    unsigned int restart_index = 0;
+    if(popt->index_mode && (popt->strip_mode >= 0))
+    {
+        if(popt->strip_mode == STRIP_JOIN_RESTART)
+        {
+            index_size = GetIndexSize(vertex_cnt + 1);
+            restart_index = (index_size == 4) ? 0xFFFFFFFFU : ((1U << (index_size * 8)) - 1);
+        }
+
+        std::vector<unsigned int> strip_vec;
+        size_t strip_cnt = 0;
+        StripifyMesh(mesh.index_vec, popt->strip_mode, restart_index, &strip_vec, &strip_cnt);
+        if(popt->verbose) printf("Strip(%s) %d Strip, Avg %.2f Triangle/Strip, Index %d -> %d (%.1f%%)\r\n",
+                                 (popt->strip_mode == STRIP_JOIN_RESTART) ? "restart" : "degen",
+                                 (int)strip_cnt,
+                                 (strip_cnt > 0) ? ((double)(index_cnt / 3) / strip_cnt) : 0.0,
+                                 (int)index_cnt,
+                                 (int)strip_vec.size(),
+                                 (index_cnt > 0) ? (100.0 * ((double)index_cnt - strip_vec.size()) / index_cnt) : 0.0
+                                );
+        mesh.index_vec.swap(strip_vec);
+        index_cnt = mesh.index_vec.size();
+    }
+
+    //  C++输出的数据和常量都在命名空间中，没有声明和宏定义
+    if(popt->out_mode == OUT_MODE_CPP)
+    {
+        GenCppCodeMesh(pctx, popt, pw, name, mesh, attr_fmt, attr_exist, tangent_vec, index_size, (attr_fmt[ATTR_KIND_POS] != ATTR_FMT_F32) ? pos_error : GetTextRoundError(popt));
+        return 0;
+    }
+
+    //  数量的宏定义
+    std::string upper_str = GetUpperString(name);
+    pdef_vec->push_back(GetDefineString(upper_str + "_3D_VERTEX_CNT", vertex_cnt));
+    if(!encoded && popt->layout_vec.empty()) pdef_vec->push_back(GetDefineString(upper_str + "_3D_VERTEX_FLOAT", dot_float));
+    if(popt->index_mode)
+    {
+        pdef_vec->push_back(GetDefineString(upper_str + "_3D_INDEX_CNT", index_cnt));
+        pdef_vec->push_back(GetDefineString(upper_str + "_3D_INDEX_SIZE", index_size));
+    }
+
+    //  三角形带的图元类型GL_TRIANGLE_STRIP，以及图元重启索引
+    if(popt->index_mode && (popt->strip_mode >= 0))
+    {
+        pdef_vec->push_back("#define " + upper_str + "_3D_PRIMITIVE    0x0005");
+        if(popt->strip_mode == STRIP_JOIN_RESTART) pdef_vec->push_back(GetDefineString(upper_str + "_3D_RESTART_INDEX", restart_index));
+    }
+
+    std::string decl_str;
+    size_t i = 0;
+
+    //  按照指定的布局分组生成数组，并给出每组的跨度和每种属性所在的组和偏移
+    //  #define CUBE_3D_TN_STRIDE    20
+    //  #define CUBE_3D_UV_STREAM    1
+    //  #define CUBE_3D_UV_OFFSET    0
+    if(!popt->layout_vec.empty())
+    {
+        size_t g = 0;
+        int stream = 0;
+        for(g=0;g<popt->layout_vec.size();g++)
+        {
+            //  只保留存在的属性
+            std::vector<int> kind_vec;
+            std::string group_str;
+            int stride = 0;
+            for(i=0;i<popt->layout_vec[g].size();i++)
+            {
+                kind = GetLayoutAttrKind(popt->layout_vec[g][i]);
+                if(!attr_exist[kind]) continue;
+                kind_vec.push_back(kind);
+                group_str.push_back(popt->layout_vec[g][i]);
+            }
+            if(kind_vec.empty()) continue;
+
+            //  一个数组只能有一种数据类型，编码后的属性需要单独一组
+            if(kind_vec.size() > 1)
+            {
+                for(i=0;i<kind_vec.size();i++)
+                {
+                    if(attr_fmt[kind_vec[i]] != ATTR_FMT_F32)
+                    {
+                        printf("Layout Group %s Need f32 Attribute!!\r\n", group_str.c_str());
+                        return -4;
+                    }
+                }
+            }
+
+            for(i=0;i<kind_vec.size();i++)
+            {
+                std::string attr_upper_str = GetUpperString(name + "_3d_" + attr_name[kind_vec[i]]);
+                pdef_vec->push_back(GetDefineString(attr_upper_str + "_STREAM", stream));
+                pdef_vec->push_back(GetDefineString(attr_upper_str + "_OFFSET", stride));
+                stride += GetAttrFormatSize(kind_vec[i], attr_fmt[kind_vec[i]]);
+            }
+            pdef_vec->push_back(GetDefineString(GetUpperString(name + "_3d_" + group_str) + "_STRIDE", stride));
+
+            if(kind_vec.size() == 1)
+            {
+                if(kind_vec[0] == ATTR_KIND_TANGENT) data_vec = tangent_vec;
+                else                                 GetMeshAttrData(pctx, mesh, kind_vec[0], &data_vec);
+                GenCCodeAttr(pw, name, attr_name[kind_vec[0]], kind_vec[0], attr_fmt[kind_vec[0]], data_vec, name + "_3d_" + group_str + "_data", pdecl_vec, pdef_vec);
+            }
+            else
+            {
+                GenCCodeStream(pctx, pw, mesh, tangent_vec, kind_vec, name + "_3d_" + group_str + "_data", pdecl_vec);
+            }
+            stream++;
+        }
+        pdef_vec->push_back(GetDefineString(upper_str + "_3D_STREAM_CNT", stream));
+    }
+    //  每种属性单独生成数组
+    else if(encoded)
+    {
+        for(kind=0;kind<3;kind++)
+        {
+            if(!attr_exist[kind]) continue;
+            GetMeshAttrData(pctx, mesh, kind, &data_vec);
+            GenCCodeAttr(pw, name, attr_name[kind], kind, attr_fmt[kind], data_vec, name + "_3d_" + attr_name[kind] + "_data", pdecl_vec, pdef_vec);
+        }
+    }
+    //  全部为32位浮点时，生成交错排列的顶点数据
+    //  const float cube_3d_vtn_data[192] =
+    //  {
+    else
+    {
+        decl_str = "const float ";
+        decl_str += GetVertexArrayName(!pctx->UVVec.empty(), !pctx->VertexNormalVec.empty(), name);
+        decl_str += "[";
+        decl_str += std::to_string((unsigned long long)vertex_cnt * dot_float);
+        decl_str += "]";
+        pdecl_vec->push_back(decl_str);
+        CWriterPutStr(pw, decl_str);
+        CWriterPutStr(pw, " =\r\n{\r\n");
+        CWriterBeginArray(pw, GetVertexArrayName(!pctx->UVVec.empty(), !pctx->VertexNormalVec.empty(), name), sizeof(float), vertex_cnt * dot_float);
+
+        for(i=0;i<vertex_cnt;i++)
+        {
+            GenCCodeVertex(pctx, pw, mesh.vertex_vec[i]);
+        }
+        CWriterEndArray(pw);
+        CWriterPutStr(pw, "};\r\n");
+    }
+
+    //  没有指定布局时切线单独生成数组，指定布局时与其他属性相同，不在布局中的不生成
+    //  const float cube_3d_tangent_data[96] =
+    if(popt->tangent && popt->layout_vec.empty())
+    {
+        GenCCodeAttr(pw, name, attr_name[ATTR_KIND_TANGENT], ATTR_KIND_TANGENT, ATTR_FMT_F32, tangent_vec, name + "_3d_tangent_data", pdecl_vec, pdef_vec);
+    }
+
+    //  量化编码的顶点坐标写入整数，没有文本的舍入误差
+    double bvh_pad = (attr_fmt[ATTR_KIND_POS] != ATTR_FMT_F32) ? pos_error : GetTextRoundError(popt);
+
+    //  非索引输出模式下没有索引数据
+    if(!popt->index_mode)
+    {
+        if(popt->bvh_leaf > 0) GenCCodeBvh(pctx, popt, pw, name, mesh, bvh_pad, pdecl_vec, pdef_vec);
+        return 0;
+    }
+
+    //  索引数据，三角形列表每行一个三角形，三角形带每行STRIP_ROW_LEN个索引
+    //  const unsigned char cube_3d_index[36] =
+    //  {
+    decl_str = "const ";
+    decl_str += GetIndexTypeString(index_size);
+    decl_str += " ";
+    decl_str += name;
+    decl_str += "_3d_index[";
+    decl_str += std::to_string((unsigned long long)index_cnt);
+    decl_str += "]";
+    pdecl_vec->push_back(decl_str);
+    CWriterPutStr(pw, decl_str);
+    CWriterPutStr(pw, " =\r\n{\r\n");
+    CWriterBeginArray(pw, name + "_3d_index", index_size, index_cnt);
+
+    size_t row_len = (popt->strip_mode >= 0) ? STRIP_ROW_LEN : 3;
+    for(i=0;i<index_cnt;i++)
+    {
+        if((i % row_len) == 0) CWriterPut(pw, "    ", 4);
+        CWriterPutUInt(pw, mesh.index_vec[i]);
+        if(((i % row_len) == (row_len - 1)) || (i == (index_cnt - 1))) CWriterPut(pw, ",\r\n", 3);
+        else                                                          CWriterPut(pw, ", ", 2);
+    }
+    CWriterEndArray(pw);
+    CWriterPutStr(pw, "};\r\n");
+
+    //  简化后的多级细节
+    if(!popt->lod_vec.empty()) GenCCodeLod(pctx, popt, pw, name, mesh, index_size, pdecl_vec, pdef_vec);
+
+    //  按块剔除用的meshlet
+    if(popt->meshlet_tri > 0) GenCCodeMeshlet(pctx, popt, pw, name, mesh, pdecl_vec, pdef_vec);
+
+    //  剔除和拾取用的BVH
+    if(popt->bvh_leaf > 0) GenCCodeBvh(pctx, popt, pw, name, mesh, bvh_pad, pdecl_vec, pdef_vec);
+
+    //  每个批次用到的顶点范围
+    if(pbatch_vec != 0) GetBatchVertexRange(mesh.index_vec, pbatch_vec);
+
+    return 0;
+}
+
+//  根据输入文件名得到输出文件的路径，不含扩展名，输出文件与输入文件在同一个目录
+std::string ObjToolGetOutputPath(std::string in_filename)
+{
+    std::string re_str;
+    size_t pos = in_filename.find_last_of("\\/");
+    if(pos != std::string::npos) re_str = in_filename.substr(0, pos + 1);
+    re_str += GetOnlyFileNameNoEx(in_filename);
+    return re_str;
+}
+
+//  得到实际写入的文件名，增量生成时先写入临时文件
+static std::string GetWritePath(const SObjOption* popt, std::string filename)
+{
+    if(popt->keep_unchanged) return filename + HASH_TEMP_EXT;
+    return filename;
+}
+
+//  完成一个文件的写入，增量生成时内容有变化才替换原来的文件，成功返回0
+static int CommitOutput(const SObjOption* popt, std::string filename)
+{
+    if(!popt->keep_unchanged) return 0;
+    return (UpdateFileIfChanged((filename + HASH_TEMP_EXT).c_str(), filename.c_str()) < 0) ? -1 : 0;
+}
+
+//  打开数据的输出，C代码写入filename，二进制输出时收集到pbin中，成功返回0
+static int OpenCCodeOutput(const SObjOption* popt, SCWriter* pw, std::string filename, SBinData* pbin)
+{
+    if(IsTextOutput(popt)) return CWriterOpen(pw, GetWritePath(popt, filename).c_str(), popt->float_fmt, popt->float_precision);
+    return CWriterOpenBin(pw, pbin, popt->float_fmt, popt->float_precision);
+}
+
+//  关闭数据的输出，成功返回0
+static int CloseCCodeOutput(const SObjOption* popt, SCWriter* pw, std::string filename)
+{
+    if(CWriterClose(pw) != 0)  return -1;
+    if(IsTextOutput(popt)) return CommitOutput(popt, filename);
+    return 0;
+}
+
+//  得到输出文件的扩展名
+const char* ObjToolGetOutputExtName(const SObjOption* popt)
+{
+    if(popt->out_mode == OUT_MODE_OBJ) return ".o";
+    if(popt->out_mode == OUT_MODE_BIN) return ".bin";
+    if(popt->out_mode == OUT_MODE_CPP) return ".hpp";
+    return ".c";
+}
+
+//  生成数据，同时记录需要在头文件中声明的数组和宏定义，成功返回0
+static int GenCCodeData(SObjContext* pctx, const SObjOption* popt, SCWriter* pw, std::string name, std::vector<std::string>* pdecl_vec, std::vector<std::string>* pdef_vec)
+{
+    //  按材质和部件排序平面，得到绘制批次
+    std::vector<SDrawBatch> batch_vec;
+    std::vector<std::string> mtl_vec;
+    if(popt->draw_batch) SortDrawBatch(pctx, &batch_vec, &mtl_vec);
+    std::vector<SDrawBatch>* pbatch_vec = popt->draw_batch ? &batch_vec : 0;
+
+    //  没有法线时生成平滑法线
+    GenContextNormals(pctx, popt);
+
+    //  切线按UV的方向计算，并与法线正交
+    if(popt->tangent && (pctx->UVVec.empty() || pctx->VertexNormalVec.empty()))
+    {
+        printf("Tangent Need UV And Normal!!\r\n");
+        return -4;
+    }
+
+    int re = 0;
+    if(popt->index_mode || IsAttrEncoded(popt) || !popt->layout_vec.empty() || (popt->out_mode == OUT_MODE_CPP))
+    {
+        re = GenCCodeMesh(pctx, popt, pw, name, pbatch_vec, pdecl_vec, pdef_vec);
+    }
+    else
+    {
+        //  按三角形展开时顶点序号就是索引的位置
+        re = GenCCodeFlat(pctx, pw, name, pdecl_vec);
+        if((re == 0) && ((popt->bvh_leaf > 0) || popt->tangent))
+        {
+            SIndexedMesh mesh;
+            BuildFlatMesh(pctx->PlaneList, pctx->VertexVec.size(), pctx->UVVec.size(), pctx->VertexNormalVec.size(), &mesh);
+            if(popt->tangent)
+            {
+                std::vector<float> tangent_vec;
+                GetMeshTangentData(pctx, popt, mesh, &tangent_vec);
+                GenCCodeAttr(pw, name, "tangent", ATTR_KIND_TANGENT, ATTR_FMT_F32, tangent_vec, name + "_3d_tangent_data", pdecl_vec, pdef_vec);
+            }
+            if(popt->bvh_leaf > 0) GenCCodeBvh(pctx, popt, pw, name, mesh, GetTextRoundError(popt), pdecl_vec, pdef_vec);
+        }
+        size_t i = 0;
+        for(i=0;i<batch_vec.size();i++)
+        {
+            batch_vec[i].min_vertex = (unsigned int)(batch_vec[i].first_plane * 3);
+            batch_vec[i].max_vertex = (unsigned int)(((batch_vec[i].first_plane + batch_vec[i].plane_cnt) * 3) - 1);
+        }
+    }
+    if((re != 0) || (pbatch_vec == 0)) return re;
+
+    if(popt->verbose) printf("Batch %d Batch, %d Material\r\n", (int)batch_vec.size(), (int)mtl_vec.size());
+    GenCCodeBatch(pw, name, batch_vec, mtl_vec, pdecl_vec, pdef_vec);
+    return 0;
+}
+
+//  统计无效的平面和缺失的UV、法线，没有无效平面时按(v,vt,vn)去重统计重复的顶点
+static void ValidateStats(SObjContext* pctx, SObjStats* pstats)
+{
+    std::chrono::steady_clock::time_point t_start = ObjStatsNow();
+    int total_v = pctx->VertexVec.size();
+    int total_uv = pctx->UVVec.size();
+    int total_vn = pctx->VertexNormalVec.size();
+    size_t plane_cnt = PlaneListSize(pctx->PlaneList);
+    unsigned long long invalid_cnt = 0;
+    size_t i = 0;
+    int k = 0;
+    for(i=0;i<plane_cnt;i++)
+    {
+        int invalid = 0;
+        for(k=0;k<3;k++)
+        {
+            int point_index = 0;
+            int uv_index = 0;
+            int vn_index = 0;
+            PlaneListGetCorner(pctx->PlaneList, (i * 3) + k, &point_index, &uv_index, &vn_index);
+            if((point_index >= total_v) || (point_index < 0)) invalid = 1;
+            if((total_uv > 0) && ((uv_index >= total_uv) || (uv_index < 0))) pstats->missing_uv_cnt++;
+            if((total_vn > 0) && ((vn_index >= total_vn) || (vn_index < 0))) pstats->missing_vn_cnt++;
+        }
+        invalid_cnt += invalid;
+    }
+    pstats->invalid_face_cnt += invalid_cnt;
+
+    //  存在无效平面时生成会失败，不统计顶点
+    if(invalid_cnt == 0)
+    {
+        SIndexedMesh mesh;
+        if(BuildIndexedMesh(pctx->PlaneList, total_v, total_uv, total_vn, &mesh) == 0)
+        {
+            pstats->unique_vertex_cnt += mesh.vertex_vec.size();
+            pstats->dup_vertex_cnt += (plane_cnt * 3) - mesh.vertex_vec.size();
+        }
+    }
+    pstats->validate_ms += ObjStatsElapsedMs(t_start);
+}
+
+//  得到文件的字节数，文件不存在时返回0
+static unsigned long long GetOutputFileSize(std::string filename)
+{
+    struct stat st;
+    if(stat(filename.c_str(), &st) != 0) return 0;
+    return (unsigned long long)st.st_size;
+}
+
+//  写出二进制文件，.bin输出时在pdef_vec中加入每个数组的位置，成功返回0
+//  #define CUBE_3D_BIN_FILE    "cube.bin"
+//  #define CUBE_3D_VTN_DATA_BIN_OFFSET    0
+//  #define CUBE_3D_VTN_DATA_BIN_SIZE    1152
+static int WriteBinOutput(const SObjOption* popt, std::string filename, std::string name, const SBinData* pbin, std::vector<std::string>* pdef_vec)
+{
+    if(popt->out_mode == OUT_MODE_OBJ)
+    {
+        if(WriteElfObject(GetWritePath(popt, filename).c_str(), pbin, popt->elf_arch) != 0) return -1;
+        return CommitOutput(popt, filename);
+    }
+    if(popt->out_mode != OUT_MODE_BIN) return 0;
+    if(WriteBinFile(GetWritePath(popt, filename).c_str(), pbin) != 0) return -1;
+    if(CommitOutput(popt, filename) != 0) return -1;
+
+    pdef_vec->push_back("#define " + GetUpperString(name) + "_3D_BIN_FILE    \"" + GetFileNameExFromPath(filename) + "\"");
+    pdef_vec->push_back(GetDefineString(GetUpperString(name) + "_3D_BIN_SIZE", pbin->data_vec.size()));
+    size_t i = 0;
+    for(i=0;i<pbin->array_vec.size();i++)
+    {
+        const SBinArray& tmp_array = pbin->array_vec[i];
+        pdef_vec->push_back(GetDefineString(GetUpperString(tmp_array.name) + "_BIN_OFFSET", tmp_array.offset));
+        pdef_vec->push_back(GetDefineString(GetUpperString(tmp_array.name) + "_BIN_SIZE", tmp_array.size));
+    }
+    return 0;
+}
+
+//  生成头文件filename，name用于防止重复包含的宏，成功返回0
+static int GenCHeader(const SObjOption* popt, std::string filename, std::string name, const std::vector<std::string>& decl_vec, const std::vector<std::string>& def_vec)
+{
+    //  定义临时字符串变量
+    std::string tmp_str;
+
+    //  创建头文件
+    SCWriter writer_h;
+    if(CWriterOpen(&writer_h, GetWritePath(popt, filename).c_str(), popt->float_fmt, popt->float_precision) != 0)  return -1;
+
+    //  生成包含头文件
+    //  #ifndef __cube_h__
+    //  #define __cube_h__
+    tmp_str = "#ifndef __";
+    tmp_str += name;
+    tmp_str += "_h__\r\n";
+    tmp_str += "#define __";
+    tmp_str += name;
+    tmp_str += "_h__\r\n";
+    CWriterPutStr(&writer_h, tmp_str);          //  写入文件
+
+    //  生成数量的宏定义
+    size_t i = 0;
+    for(i=0;i<def_vec.size();i++)
+    {
+        CWriterPutStr(&writer_h, def_vec.at(i));
+        CWriterPutStr(&writer_h, "\r\n");
+    }
+
+    //  .bin文件没有符号，不生成数组的声明
+    if(popt->out_mode != OUT_MODE_BIN)
+    {
+        //  生成C++/C兼容
+        CWriterPutStr(&writer_h, "#ifdef __cplusplus\r\nextern \"C\"\r\n{\r\n#endif\r\n");
+
+        //  生成数据头部
+        //  extern const float cube_3d_vtn_data[324852354];
+        for(i=0;i<decl_vec.size();i++)
+        {
+            tmp_str = "extern ";
+            tmp_str += decl_vec.at(i);
+            tmp_str += ";\r\n";
+            CWriterPutStr(&writer_h, tmp_str);      //  写入文件
+        }
+
+        //  生成C++/C兼容
+        CWriterPutStr(&writer_h, "#ifdef __cplusplus\r\n}\r\n#endif\r\n");
+    }
+
+    //  结束
+    //  #endif
+    CWriterPutStr(&writer_h, "#endif \r\n");
+    
+    //  关闭文件
+    if(CWriterClose(&writer_h) != 0)  return -1;
+    return CommitOutput(popt, filename);
+}
+
+//  生成包含头文件的语句
+//  #include "cube.h"
+static void GenCCodeInclude(SCWriter* pw, std::string name)
+{
+    std::string tmp_str = "#include \"";
+    tmp_str += name;
+    tmp_str += ".h\"\r\n";
+    CWriterPutStr(pw, tmp_str);
+}
+
+//  生成C++头文件的开始，防止重复包含的宏和用到的标准库头文件
+//  #ifndef __cube_hpp__
+//  #define __cube_hpp__
+//  #include <array>
+//  #include <cstddef>
+static void GenCppCodeBegin(SCWriter* pw, std::string name)
+{
+    std::string tmp_str = "#ifndef __" + name + "_hpp__\r\n";
+    tmp_str += "#define __" + name + "_hpp__\r\n";
+    tmp_str += "#include <array>\r\n";
+    tmp_str += "#include <cstddef>\r\n";
+    CWriterPutStr(pw, tmp_str);
+}
+
+//  根据解码的数据生成文件，输出文件与输入文件在同一个目录，成功返回0
+int ObjToolGenCode(SObjContext* pctx, const SObjOption* popt, std::string in_filename)
+{
+    //  生成目标文件的完全路径
+    std::string name = GetOnlyFileNameNoEx(in_filename);
+    std::string path_str = ObjToolGetOutputPath(in_filename);
+    std::string filename = path_str + ObjToolGetOutputExtName(popt);
+
+    SObjStats* pstats = popt->pstats;
+    if(pstats != 0) ValidateStats(pctx, pstats);
+
+    //  尝试创建新文件，二进制输出时先收集到内存中
+    std::chrono::steady_clock::time_point t_emit = ObjStatsNow();
+    SBinData bin_data;
+    SCWriter writer_c;
+    if(OpenCCodeOutput(popt, &writer_c, filename, &bin_data) != 0)  return -1;
+
+    //  生成包含头文件，C++输出时为防止重复包含的宏和标准库的头文件
+    if(popt->out_mode == OUT_MODE_CPP) GenCppCodeBegin(&writer_c, name);
+    else                               GenCCodeInclude(&writer_c, name);
+
+    //  生成数据，同时记录需要在头文件中声明的数组和宏定义
+    std::vector<std::string> decl_vec;
+    std::vector<std::string> def_vec;
+    int re = GenCCodeData(pctx, popt, &writer_c, name, &decl_vec, &def_vec);
+    if(re != 0)
+    {
+        CWriterClose(&writer_c);    //  关闭文件 释放资源
+        return re;
+    }
+    if(popt->out_mode == OUT_MODE_CPP) CWriterPutStr(&writer_c, "#endif \r\n");
+
+    //  生成过程中缓冲区满时写入文件的时间不计入生成
+    std::chrono::steady_clock::time_point t_write = ObjStatsNow();
+    double emit_write_ms = writer_c.write_ms;
+    unsigned long long emit_bytes = IsTextOutput(popt) ? writer_c.total : bin_data.data_vec.size();
+
+    //  关闭文件
+    if(CloseCCodeOutput(popt, &writer_c, filename) != 0)  return -1;
+
+    //  写出二进制文件
+    if(WriteBinOutput(popt, filename, name, &bin_data, &def_vec) != 0)  return -1;
+
+    //  生成头文件，C++输出只有一个头文件
+    if(popt->out_mode != OUT_MODE_CPP) re = GenCHeader(popt, path_str + ".h", name, decl_vec, def_vec);
+    if((re == 0) && (pstats != 0))
+    {
+        pstats->emit_ms += std::chrono::duration<double, std::milli>(t_write - t_emit).count() - emit_write_ms;
+        pstats->write_ms += emit_write_ms + ObjStatsElapsedMs(t_write);
+        pstats->emit_bytes += emit_bytes;
+        pstats->bytes_written += GetOutputFileSize(filename) + GetOutputFileSize(path_str + ".h");
+    }
+    return re;
+}
+
+//  判断选项是否支持流式生成，支持返回1
+int ObjToolIsStreamSupported(const SObjOption* popt)
+{
+    return (popt->out_mode == OUT_MODE_C) && !popt->index_mode && !IsAttrEncoded(popt) && popt->layout_vec.empty() && !popt->draw_batch && (popt->bvh_leaf <= 0) && (popt->normal_crease < 0.0) && !popt->tangent;
+}
+
+//  流式生成时写出三角形的参数
+typedef struct
+{
+    SCWriter* pw;                   //  C文件的输出
+    int error;                      //  是否出现了无效的顶点索引
+    int has_uv;                     //  是否输出UV，用于统计缺失的UV
+    int has_vn;                     //  是否输出法线，用于统计缺失的法线
+    SObjStats* pstats;              //  统计，为0时不统计
+}SStreamWriter;
+
+//  流式生成时写出一个三角形，与GenCCodeFlat的格式相同
+static void StreamTriangle(const SObjTriangle* ptri, void* puser)
+{
+    SStreamWriter* pstream = (SStreamWriter*)puser;
+    if(!ptri->valid && (pstream->pstats != 0)) pstream->pstats->invalid_face_cnt++;
+    if(pstream->error) return;
+    if(!ptri->valid)
+    {
+        pstream->error = 1;
+        return;
+    }
+
+    int k = 0;
+    for(k=0;k<3;k++)
+    {
+        const SUV* puv = (ptri->valid_mask & (1 << ((k * 3) + 1))) ? &ptri->uv[k] : 0;
+        const SVertexNormal* pvn = (ptri->valid_mask & (1 << ((k * 3) + 2))) ? &ptri->normal[k] : 0;
+        GenCCodeDotData(pstream->pw, &ptri->pos[k], puv, pvn);
+        if(pstream->pstats != 0)
+        {
+            if(pstream->has_uv && (puv == 0)) pstream->pstats->missing_uv_cnt++;
+            if(pstream->has_vn && (pvn == 0)) pstream->pstats->missing_vn_cnt++;
+        }
+    }
+
+    //  完成一个面的写入
+    CWriterPut(pstream->pw, "\r\n", 2);
+}
+
+//  流式生成，先预扫描得到平面个数，再按块读取解码，每解析一个平面立即写出，不保存平面数据
+//  成功返回0，文件打开失败返回-1，读取失败返回-2，生成失败返回-3，输入不是普通文件无法预扫描时返回-4
+int ObjToolStreamCode(SObjContext* pctx, const SObjOption* popt, std::string in_filename, SObjCount* pcount)
+{
+    if(!ObjToolIsStreamSupported(popt)) return -3;
+
+    //  预扫描得到各种记录的个数，数组的大小需要写在数据前面
+    SLineReader reader;
+    if(LineReaderOpen(in_filename.c_str(), &reader) != 0) return -1;
+    if(!reader.is_regular)
+    {
+        LineReaderClose(&reader);
+        return -4;
+    }
+    SObjStats* pstats = popt->pstats;
+    std::chrono::steady_clock::time_point t_prescan = ObjStatsNow();
+    SObjCount count = {0, 0, 0, 0, 0};
+    int re = PrescanReader(&reader, &count);
+    if(pstats != 0) pstats->prescan_ms += ObjStatsElapsedMs(t_prescan);
+    if(re != 0)
+    {
+        LineReaderClose(&reader);
+        return -2;
+    }
+    if(pcount != 0) *pcount = count;
+
+    //  与解码后的数据一致，生成等级不够的属性不保存
+    int has_uv = (pctx->gen_level >= 2) && (count.vt_cnt > 0);
+    int has_vn = (pctx->gen_level >= 3) && (count.vn_cnt > 0);
+    unsigned long long float_cnt = (unsigned long long)GetDotFloatCount(has_uv, has_vn) * count.f_cnt * 3;
+
+    //  生成目标文件的完全路径
+    std::string name = GetOnlyFileNameNoEx(in_filename);
+    std::string path_str = ObjToolGetOutputPath(in_filename);
+    std::string filename = path_str + ObjToolGetOutputExtName(popt);
+    SCWriter writer_c;
+    if(OpenCCodeOutput(popt, &writer_c, filename, 0) != 0)
+    {
+        LineReaderClose(&reader);
+        return -3;
+    }
+    GenCCodeInclude(&writer_c, name);
+
+    //  数组声明
+    //  const float cube_3d_vtn_data[324852354] =
+    //  {
+    std::vector<std::string> decl_vec;
+    std::vector<std::string> def_vec;
+    std::string decl_str = "const float " + GetVertexArrayName(has_uv, has_vn, name) + "[" + std::to_string(float_cnt) + "]";
+    decl_vec.push_back(decl_str);
+    CWriterPutStr(&writer_c, decl_str);
+    CWriterPutStr(&writer_c, " =\r\n{\r\n");
+
+    //  解码的同时写出每个三角形，按f记录的顺序
+    SStreamWriter stream;
+    stream.pw = &writer_c;
+    stream.error = 0;
+    stream.has_uv = has_uv;
+    stream.has_vn = has_vn;
+    stream.pstats = pstats;
+    SObjVisitor visitor;
+    visitor.pfunc = StreamTriangle;
+    visitor.puser = &stream;
+    visitor.store_face = 0;
+    visitor.keep_order = 1;
+    re = ParseReader(pctx, popt, &reader, &visitor, &count);
+    LineReaderClose(&reader);
+    if(re != 0)
+    {
+        CWriterClose(&writer_c);
+        return re;
+    }
+
+    //  结束
+    //  };
+    CWriterPutStr(&writer_c, "};\r\n");
+    std::chrono::steady_clock::time_point t_write = ObjStatsNow();
+    double emit_write_ms = writer_c.write_ms;
+    if(CloseCCodeOutput(popt, &writer_c, filename) != 0)  return -3;
+    if(stream.error) return -3;
+
+    //  生成头文件
+    if(GenCHeader(popt, path_str + ".h", name, decl_vec, def_vec) != 0)  return -3;
+
+    //  生成与解码同时进行，生成时间计入f记录，这里只统计写文件
+    if(pstats != 0)
+    {
+        pstats->write_ms += emit_write_ms + ObjStatsElapsedMs(t_write);
+        pstats->emit_bytes += writer_c.total;
+        pstats->bytes_written += GetOutputFileSize(filename) + GetOutputFileSize(path_str + ".h");
+    }
+    return 0;
+}
+
+//  生成数据到内存中，name为数组名字的前缀，成功返回0
+int ObjToolGenData(SObjContext* pctx, const SObjOption* popt, std::string name, SObjOutput* pout)
+{
+    SCWriter writer_c;
+    int re = 0;
+    if(IsTextOutput(popt)) re = CWriterOpenMem(&writer_c, &pout->c_str, popt->float_fmt, popt->float_precision);
+    else                   re = CWriterOpenBin(&writer_c, &pout->bin_data, popt->float_fmt, popt->float_precision);
+    if(re != 0) return -1;
+
+    SObjStats* pstats = popt->pstats;
+    if(pstats != 0) ValidateStats(pctx, pstats);
+    std::chrono::steady_clock::time_point t_emit = ObjStatsNow();
+    re = GenCCodeData(pctx, popt, &writer_c, name, &pout->decl_vec, &pout->def_vec);
+    if(CWriterClose(&writer_c) != 0) re = -1;
+    if((re == 0) && (pstats != 0))
+    {
+        pstats->emit_ms += ObjStatsElapsedMs(t_emit);
+        pstats->emit_bytes += IsTextOutput(popt) ? pout->c_str.size() : pout->bin_data.data_vec.size();
+    }
+    return re;
+}
+
+//  将内存中的生成结果写到path_str对应的文件，path_str不含扩展名，成功返回0
+int ObjToolWriteOutput(const SObjOption* popt, std::string path_str, const SObjOutput* pout)
+{
+    std::string name = GetOnlyFileNameNoEx(path_str);
+    std::string filename = path_str + ObjToolGetOutputExtName(popt);
+    std::vector<std::string> def_vec = pout->def_vec;
+    std::chrono::steady_clock::time_point t_write = ObjStatsNow();
+
+    //  C代码写入文件，二进制数据已经在内存中
+    if(popt->out_mode == OUT_MODE_C)
+    {
+        SCWriter writer_c;
+        if(CWriterOpen(&writer_c, GetWritePath(popt, filename).c_str(), popt->float_fmt, popt->float_precision) != 0)  return -1;
+        GenCCodeInclude(&writer_c, name);
+        CWriterPutStr(&writer_c, pout->c_str);
+        if(CloseCCodeOutput(popt, &writer_c, filename) != 0)  return -1;
+    }
+
+    //  C++头文件，合并输出时多个网格的命名空间依次放在同一个头文件中
+    if(popt->out_mode == OUT_MODE_CPP)
+    {
+        SCWriter writer_c;
+        if(CWriterOpen(&writer_c, GetWritePath(popt, filename).c_str(), popt->float_fmt, popt->float_precision) != 0)  return -1;
+        GenCppCodeBegin(&writer_c, name);
+        CWriterPutStr(&writer_c, pout->c_str);
+        CWriterPutStr(&writer_c, "#endif \r\n");
+        if(CloseCCodeOutput(popt, &writer_c, filename) != 0)  return -1;
+    }
+
+    //  写出二进制文件
+    if(WriteBinOutput(popt, filename, name, &pout->bin_data, &def_vec) != 0)  return -1;
+
+    //  生成头文件
+    int re = 0;
+    if(popt->out_mode != OUT_MODE_CPP) re = GenCHeader(popt, path_str + ".h", name, pout->decl_vec, def_vec);
+    if((re == 0) && (popt->pstats != 0))
+    {
+        popt->pstats->write_ms += ObjStatsElapsedMs(t_write);
+        popt->pstats->bytes_written += GetOutputFileSize(filename) + GetOutputFileSize(path_str + ".h");
+    }
+    return re;
+}
+
+//  从完整路径或文件名中提取纯文件名部分，不含扩展名，即数组名字的前缀
+std::string ObjToolGetName(std::string in_filename)
+{
+    return GetOnlyFileNameNoEx(in_filename);
+}
+
+//---------------------------------------------------------------------------
+//  文件结束
@@ -0,0 +1,216 @@
+/****************************************************************************
+
+    程序名称：OBJ文件解码和生成的库接口(libobjtool)
+    程序设计：rainhenry
+    程序版本：REV 1.0
+    创建日期：20261017
+
+    说明：
+        从main.cpp中独立出来的解码和生成功能，编译为静态库libobjtool.a，
+        可以直接链接到常驻的服务程序中使用，不需要调用3dobjtool再读回生成的文件
+        选项全部放在SObjOption中，不使用全局变量，不同的任务可以使用不同的选项同时运行
+        SObjContext为解码得到的网格数据
+        解码时可以通过SObjVisitor的回调逐个得到已经解析出顶点数据的三角形
+        ObjToolStreamCode按块读取输入文件，每解析一个平面立即写出，内存占用只与v/vt/vn的个数有关
+
+        用法：
+            SObjOption opt;
+            ObjToolDefaultOption(&opt);
+            SObjContext ctx;
+            ctx.gen_level = 3;
+            ObjToolParseMemory(&ctx, &opt, pdata, size, 0);
+            SObjOutput out;
+            ObjToolGenData(&ctx, &opt, "cube", &out);     //  out.c_str为C代码
+
+    版本修订：
+        REV 0.1      rainhenry     20261017    创建文档
+        REV 0.2      rainhenry     20261017    增加预扫描、按块读取的解码和流式生成
+        REV 0.3      rainhenry     20261017    增加各阶段的时间和计数的统计
+        REV 0.4      rainhenry     20261017    增加meshlet的输出
+        REV 0.5      rainhenry     20261017    增加按材质和部件排序的绘制批次
+        REV 0.6      rainhenry     20261017    增加SAH包围盒层次(BVH)的输出
+        REV 0.7      rainhenry     20261017    增加QEM简化的多级细节(LOD)输出
+        REV 0.8      rainhenry     20261017    增加多线程生成平滑法线和切线空间
+        REV 0.9      rainhenry     20261017    增加减少过度绘制的三角形排序
+        REV 1.0      rainhenry     20261017    增加C++17头文件的输出
+
+****************************************************************************/
+//---------------------------------------------------------------------------
+//  防止重复包含
+#ifndef __objtool_h__
+#define __objtool_h__
+
+//---------------------------------------------------------------------------
+//  包含头文件
+#include "objdata.h"
+#include "cwriter.h"
+#include "meshopt.h"
+#include "normalgen.h"
+#include "quantize.h"
+#include "binout.h"
+#include "objstats.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+//  输出文件的类型
+#define OUT_MODE_C          0       //  C代码
+#define OUT_MODE_OBJ        1       //  ELF可重定位目标文件
+#define OUT_MODE_BIN        2       //  .bin文件，头文件中给出每个数组的位置
+#define OUT_MODE_CPP        3       //  C++17头文件，顶点结构体的constexpr std::array
+
+//  输出三角形带时每行的索引个数
+#define STRIP_ROW_LEN       16
+
+//  定义解码和生成的选项，用ObjToolDefaultOption设置默认值
+typedef struct
+{
+    int use_mmap;                   //  是否允许使用mmap读取输入文件，0=强制使用read()
+    int thread_num;                 //  解码使用的线程数，1=单线程
+    int verbose;                    //  是否打印解码和优化的统计信息
+
+    //  生成C文件时浮点数的格式和小数位数，小数位数小于0为默认
+    int float_fmt;
+    int float_precision;
+
+    int index_mode;                 //  输出模式，0=按三角形展开的顶点数组  1=去重后的顶点数组+索引数组
+    int vcache_opt;                 //  索引输出模式下是否按照顶点缓存命中率重新排列三角形
+    int vfetch_opt;                 //  索引输出模式下是否按照首次使用的顺序重新排列顶点数据
+    double overdraw_threshold;      //  索引输出模式下按遮挡关系重新排列三角形，簇的ACMR允许增加的比例，小于等于0时不排列
+
+    //  顶点坐标、UV、法线的编码格式，ATTR_FMT_XXX
+    //  ATTR_FMT_AUTO表示按max_error自动选择，没有指定误差时使用32位浮点
+    int pos_fmt;
+    int uv_fmt;
+    int normal_fmt;
+    double max_error;               //  自动选择编码时允许的最大误差，小于0表示没有指定
+
+    std::vector<std::string> layout_vec;    //  属性的分组布局，每组生成一个数组，为空时使用交错排列的vtn数组
+    int strip_mode;                 //  输出三角形带时的连接方式STRIP_JOIN_XXX，小于0表示输出三角形列表
+
+    //  索引输出模式下同时输出meshlet，每块的顶点数和三角形数的上限，为0时不输出
+    int meshlet_vertex;
+    int meshlet_tri;
+
+    int draw_batch;                 //  按o/g/usemtl把平面排序为绘制批次，同一材质的批次连续，并输出批次表
+    int bvh_leaf;                   //  同时输出三角形的BVH，叶节点的三角形数的上限，为0时不输出
+
+    //  索引输出模式下同时输出简化后的多级细节，每一级的目标按从精细到粗糙排列，为空时不输出
+    //  lod_target为LOD_TARGET_XXX，目标为三角形个数的比例或者允许的最大误差
+    std::vector<double> lod_vec;
+    int lod_target;
+
+    //  生成等级为3且OBJ文件中没有vn记录时，按角度加权生成平滑法线
+    //  相邻平面的法线夹角大于normal_crease(度)时作为硬边，小于0时不生成
+    double normal_crease;
+    int tangent;                    //  同时输出每个顶点的切线空间，xyz为切线 w为副切线的方向，需要UV和法线
+
+    int out_mode;                   //  输出文件的类型OUT_MODE_XXX
+    int elf_arch;                   //  ELF目标文件的体系结构
+
+    int keep_unchanged;             //  输出内容没有变化时不改写文件，保留原来的修改时间
+
+    SObjStats* pstats;              //  统计各阶段的时间和计数，为0时不统计，多个任务同时运行时每个任务一份
+}SObjOption;
+
+//  定义生成到内存中的结果
+typedef struct
+{
+    std::string c_str;                          //  C代码，不含包含头文件的语句，C++输出时为网格的命名空间
+    SBinData bin_data;                          //  二进制输出时的数据
+    std::vector<std::string> decl_vec;          //  需要在头文件中声明的数组
+    std::vector<std::string> def_vec;           //  需要在头文件中生成的宏定义
+}SObjOutput;
+
+//  定义解码回调得到的一个三角形，不存在的UV和法线为0
+typedef struct
+{
+    SVertex pos[3];
+    SUV uv[3];
+    SVertexNormal normal[3];
+    int valid;                      //  3个顶点坐标的索引都有效时为1
+    int has_uv;                     //  3个点的UV都有效时为1
+    int has_normal;                 //  3个点的法线都有效时为1
+    int valid_mask;                 //  第(点序号*3+属性序号)位为1表示该点的该属性有效，属性序号0=顶点 1=UV 2=法线
+    SPlaneInfo info;                //  0基序的全局索引
+}SObjTriangle;
+
+//  解码得到一个三角形时的回调
+typedef void (*PObjTriangleFunc)(const SObjTriangle* ptri, void* puser);
+
+//  定义解码的回调
+//  引用到的v/vt/vn都已经解析过的三角形，在解析到f记录时立即回调
+//  引用了后面记录的三角形，在全部解析完成后按出现顺序回调
+//  keep_order为1时严格按f记录的顺序回调，从第一个引用了后面记录的三角形开始，
+//  后面的三角形都先写入临时文件，全部解析完成后再依次回调，内存占用不随三角形个数增长
+//  有回调时单线程解码
+typedef struct
+{
+    PObjTriangleFunc pfunc;         //  回调函数
+    void* puser;                    //  回调函数的参数
+    int store_face;                 //  是否同时保存到PlaneList，0=只回调，不占用平面数据的内存
+    int keep_order;                 //  是否严格按f记录的顺序回调
+}SObjVisitor;
+
+//  定义OBJ文件中各种记录的个数
+typedef struct
+{
+    size_t v_cnt;                   //  v记录的个数
+    size_t vt_cnt;                  //  vt记录的个数
+    size_t vn_cnt;                  //  vn记录的个数
+    size_t f_cnt;                   //  格式支持的f记录的个数，即解码后的平面个数
+    size_t line_cnt;                //  全部f记录的个数
+}SObjCount;
+
+//  设置选项的默认值，默认的输出与3dobjtool不带选项时相同
+void ObjToolDefaultOption(SObjOption* popt);
+
+//  解析属性的分组布局，如"p | tn"，每组生成一个数组，每个字母最多出现一次
+//  成功返回0，格式错误返回-1
+int ObjToolParseLayout(const char* pstr, std::vector<std::string>* playout_vec);
+
+//  从内存中的OBJ文件数据解码，pctx->gen_level需要预先设置，pvisitor可以为0
+//  thread_num大于1时，按行边界拆分为多个分块在多个线程中解码，结果与单线程完全一致
+void ObjToolParseMemory(SObjContext* pctx, const SObjOption* popt, const char* pdata, size_t size, const SObjVisitor* pvisitor);
+
+//  读取并解码OBJ文件，成功返回0，文件打开失败返回-1
+int ObjToolParseFile(SObjContext* pctx, const SObjOption* popt, const char* filename, const SObjVisitor* pvisitor);
+
+//  统计一段OBJ文件数据中各种记录的个数，结果累加到pcount中，[pbegin, pend)必须从行首开始
+void ObjToolPrescan(const char* pbegin, const char* pend, SObjCount* pcount);
+
+//  按块读取并解码OBJ文件，不映射整个文件，单线程解码
+//  成功返回0，文件打开失败返回-1，读取失败返回-2
+int ObjToolParseStream(SObjContext* pctx, const SObjOption* popt, const char* filename, const SObjVisitor* pvisitor);
+
+//  流式生成，先预扫描得到平面个数，再按块读取解码，每解析一个平面立即写出，不保存平面数据
+//  只支持按三角形展开的C代码输出，生成的文件与ObjToolParseFile+ObjToolGenCode完全相同
+//  pcount返回各种记录的个数，可以为0
+//  成功返回0，文件打开失败返回-1，读取失败返回-2，生成失败返回-3，输入不是普通文件无法预扫描时返回-4
+int ObjToolStreamCode(SObjContext* pctx, const SObjOption* popt, std::string in_filename, SObjCount* pcount);
+
+//  判断选项是否支持流式生成，支持返回1
+int ObjToolIsStreamSupported(const SObjOption* popt);
+
+//  生成数据到内存中，name为数组名字的前缀，成功返回0
+int ObjToolGenData(SObjContext* pctx, const SObjOption* popt, std::string name, SObjOutput* pout);
+
+//  将内存中的生成结果写到path_str对应的文件，path_str不含扩展名，成功返回0
+int ObjToolWriteOutput(const SObjOption* popt, std::string path_str, const SObjOutput* pout);
+
+//  根据解码的数据生成文件，输出文件与输入文件在同一个目录，成功返回0
+int ObjToolGenCode(SObjContext* pctx, const SObjOption* popt, std::string in_filename);
+
+//  从完整路径或文件名中提取纯文件名部分，不含扩展名，即数组名字的前缀
+std::string ObjToolGetName(std::string in_filename);
+
+//  根据输入文件名得到输出文件的路径，不含扩展名
+std::string ObjToolGetOutputPath(std::string in_filename);
+
+//  得到输出文件的扩展名
+const char* ObjToolGetOutputExtName(const SObjOption* popt);
+
+#endif
+
+//---------------------------------------------------------------------------
+//  文件结束
@@ -0,0 +1,442 @@
+/****************************************************************************
+
+    程序名称：顶点属性的量化编码
+    程序设计：rainhenry
+    程序版本：REV 0.2
+    创建日期：20261016
+
+    版本修订：
+        REV 0.1      rainhenry     20261016    创建文档
+        REV 0.2      rainhenry     20261017    增加切线属性，只支持32位浮点
+
+****************************************************************************/
+//---------------------------------------------------------------------------
+//  包含头文件
+#include "quantize.h"
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+
+//  float转换为半精度浮点数，舍入到最近的偶数
+unsigned short FloatToHalf(float val)
+{
+    uint32_t x = 0;
+    memcpy(&x, &val, sizeof(x));
+    uint32_t sign = (x >> 16) & 0x8000;
+    uint32_t absx = x & 0x7FFFFFFF;
+
+    //  无穷大和非数值
+    if(absx >= 0x7F800000)
+    {
+        if(absx > 0x7F800000) return (unsigned short)(sign | 0x7E00 | ((absx >> 13) & 0x3FF));
+        return (unsigned short)(sign | 0x7C00);
+    }
+
+    //  不小于65520的数舍入后超出半精度范围
+    if(absx >= 0x477FF000) return (unsigned short)(sign | 0x7C00);
+
+    //  半精度的非规格化数，以2^-24为单位舍入
+    if(absx < 0x38800000)
+    {
+        float tmp_f = 0.0f;
+        memcpy(&tmp_f, &absx, sizeof(tmp_f));
+        return (unsigned short)(sign | (uint32_t)std::nearbyint(tmp_f * 16777216.0f));
+    }
+
+    //  规格化数，调整指数偏移后舍去低13位
+    uint32_t mant_odd = (absx >> 13) & 1;
+    absx += 0xC8000FFFU + mant_odd;
+    return (unsigned short)(sign | (absx >> 13));
+}
+
+//  半精度浮点数转换为float
+float HalfToFloat(unsigned short val)
+{
+    uint32_t sign = ((uint32_t)val & 0x8000) << 16;
+    uint32_t exp = ((uint32_t)val >> 10) & 0x1F;
+    uint32_t mant = (uint32_t)val & 0x3FF;
+    uint32_t x = 0;
+
+    //  零和非规格化数
+    if(exp == 0)
+    {
+        float tmp_f = (float)mant / 16777216.0f;
+        return (sign != 0) ? -tmp_f : tmp_f;
+    }
+
+    //  无穷大和非数值
+    if(exp == 0x1F)
+    {
+        x = sign | 0x7F800000 | (mant << 13);
+    }
+    //  规格化数
+    else
+    {
+        x = sign | ((exp + 112) << 23) | (mant << 13);
+    }
+
+    float re = 0.0f;
+    memcpy(&re, &x, sizeof(re));
+    return re;
+}
+
+//  八面体映射解码，bits为每个分量的位数
+void OctDecode(const int* pin, int bits, float* pn)
+{
+    float maxq = (float)((1 << (bits - 1)) - 1);
+    float u = (float)pin[0] / maxq;
+    float v = (float)pin[1] / maxq;
+    if(u < -1.0f) u = -1.0f;
+    if(v < -1.0f) v = -1.0f;
+
+    float z = 1.0f - fabsf(u) - fabsf(v);
+
+    //  下半球折叠回来
+    if(z < 0.0f)
+    {
+        float tmp_u = (1.0f - fabsf(v)) * ((u >= 0.0f) ? 1.0f : -1.0f);
+        float tmp_v = (1.0f - fabsf(u)) * ((v >= 0.0f) ? 1.0f : -1.0f);
+        u = tmp_u;
+        v = tmp_v;
+    }
+
+    float len = sqrtf((u * u) + (v * v) + (z * z));
+    pn[0] = u / len;
+    pn[1] = v / len;
+    pn[2] = z / len;
+}
+
+//  八面体映射编码，bits为每个分量的位数
+void OctEncode(const float* pn, int bits, int* pout)
+{
+    float maxq = (float)((1 << (bits - 1)) - 1);
+    float l1 = fabsf(pn[0]) + fabsf(pn[1]) + fabsf(pn[2]);
+
+    //  零向量
+    if(l1 <= 0.0f)
+    {
+        pout[0] = 0;
+        pout[1] = 0;
+        return;
+    }
+
+    //  投影到八面体上，下半球折叠到正方形的四个角
+    float u = pn[0] / l1;
+    float v = pn[1] / l1;
+    if(pn[2] < 0.0f)
+    {
+        float tmp_u = (1.0f - fabsf(v)) * ((u >= 0.0f) ? 1.0f : -1.0f);
+        float tmp_v = (1.0f - fabsf(u)) * ((v >= 0.0f) ? 1.0f : -1.0f);
+        u = tmp_u;
+        v = tmp_v;
+    }
+
+    //  单位化的原始向量，用于比较误差
+    float len = sqrtf((pn[0] * pn[0]) + (pn[1] * pn[1]) + (pn[2] * pn[2]));
+    float n0 = pn[0] / len;
+    float n1 = pn[1] / len;
+    float n2 = pn[2] / len;
+
+    //  在相邻的4个整数点中选择解码后最接近原始向量的
+    int base_u = (int)floorf(u * maxq);
+    int base_v = (int)floorf(v * maxq);
+    float best_dot = -2.0f;
+    int k = 0;
+    for(k=0;k<4;k++)
+    {
+        int q[2];
+        q[0] = base_u + (k & 1);
+        q[1] = base_v + (k >> 1);
+        if(q[0] > (int)maxq) q[0] = (int)maxq;
+        if(q[0] < -(int)maxq) q[0] = -(int)maxq;
+        if(q[1] > (int)maxq) q[1] = (int)maxq;
+        if(q[1] < -(int)maxq) q[1] = -(int)maxq;
+
+        float dec[3];
+        OctDecode(q, bits, dec);
+        float dot = (dec[0] * n0) + (dec[1] * n1) + (dec[2] * n2);
+        if(dot > best_dot)
+        {
+            best_dot = dot;
+            pout[0] = q[0];
+            pout[1] = q[1];
+        }
+    }
+}
+
+//  计算cnt个comp分量的数据按照fmt编码所需的反量化参数
+void GetQuantRange(const float* pdata, size_t cnt, int comp, int fmt, SQuantRange* prange)
+{
+    int k = 0;
+    for(k=0;k<3;k++)
+    {
+        prange->offset[k] = 0.0f;
+        prange->scale[k] = 1.0f;
+    }
+
+    //  只有归一化整数需要反量化参数
+    if((fmt != ATTR_FMT_SNORM16) && (fmt != ATTR_FMT_UNORM16)) return;
+    if(cnt == 0) return;
+
+    for(k=0;k<comp;k++)
+    {
+        float min_val = pdata[k];
+        float max_val = pdata[k];
+        size_t i = 0;
+        for(i=1;i<cnt;i++)
+        {
+            float val = pdata[(i * comp) + k];
+            if(val < min_val) min_val = val;
+            if(val > max_val) max_val = val;
+        }
+
+        //  有符号时以中心为偏移，缩放为半宽；无符号时以最小值为偏移，缩放为全宽
+        if(fmt == ATTR_FMT_SNORM16)
+        {
+            prange->offset[k] = (min_val * 0.5f) + (max_val * 0.5f);
+            prange->scale[k] = (max_val * 0.5f) - (min_val * 0.5f);
+        }
+        else
+        {
+            prange->offset[k] = min_val;
+            prange->scale[k] = max_val - min_val;
+        }
+    }
+}
+
+//  按照fmt编码一个comp分量的数据，返回编码后的分量个数
+int EncodeAttr(const float* pin, int comp, int fmt, const SQuantRange* prange, int* pout)
+{
+    int k = 0;
+
+    //  法线的八面体映射
+    if((fmt == ATTR_FMT_OCT8) || (fmt == ATTR_FMT_OCT16))
+    {
+        OctEncode(pin, (fmt == ATTR_FMT_OCT8) ? 8 : 16, pout);
+        return 2;
+    }
+
+    for(k=0;k<comp;k++)
+    {
+        float val = pin[k];
+        switch(fmt)
+        {
+            case ATTR_FMT_F16:
+                pout[k] = FloatToHalf(val);
+                break;
+            case ATTR_FMT_SNORM16:
+            {
+                float t = (prange->scale[k] > 0.0f) ? ((val - prange->offset[k]) / prange->scale[k]) : 0.0f;
+                long q = lroundf(t * 32767.0f);
+                if(q > 32767) q = 32767;
+                if(q < -32767) q = -32767;
+                pout[k] = (int)q;
+                break;
+            }
+            case ATTR_FMT_UNORM16:
+            {
+                float t = (prange->scale[k] > 0.0f) ? ((val - prange->offset[k]) / prange->scale[k]) : 0.0f;
+                long q = lroundf(t * 65535.0f);
+                if(q > 65535) q = 65535;
+                if(q < 0) q = 0;
+                pout[k] = (int)q;
+                break;
+            }
+            default:
+                memcpy(&pout[k], &val, sizeof(int));
+                break;
+        }
+    }
+    return comp;
+}
+
+//  将编码结果解码为comp分量的数据
+void DecodeAttr(const int* pin, int comp, int fmt, const SQuantRange* prange, float* pout)
+{
+    int k = 0;
+
+    //  法线的八面体映射
+    if((fmt == ATTR_FMT_OCT8) || (fmt == ATTR_FMT_OCT16))
+    {
+        OctDecode(pin, (fmt == ATTR_FMT_OCT8) ? 8 : 16, pout);
+        return;
+    }
+
+    for(k=0;k<comp;k++)
+    {
+        switch(fmt)
+        {
+            case ATTR_FMT_F16:
+                pout[k] = HalfToFloat((unsigned short)pin[k]);
+                break;
+            case ATTR_FMT_SNORM16:
+                pout[k] = prange->offset[k] + (prange->scale[k] * ((float)pin[k] / 32767.0f));
+                break;
+            case ATTR_FMT_UNORM16:
+                pout[k] = prange->offset[k] + (prange->scale[k] * ((float)pin[k] / 65535.0f));
+                break;
+            default:
+                memcpy(&pout[k], &pin[k], sizeof(float));
+                break;
+        }
+    }
+}
+
+//  得到属性的分量个数
+int GetAttrKindComp(int kind)
+{
+    if(kind == ATTR_KIND_UV)      return 2;
+    if(kind == ATTR_KIND_TANGENT) return 4;
+    return 3;
+}
+
+//  计算cnt个数据按照fmt编码再解码后的最大绝对误差
+double GetEncodeError(const float* pdata, size_t cnt, int kind, int fmt)
+{
+    if(fmt == ATTR_FMT_F32) return 0.0;
+
+    int comp = GetAttrKindComp(kind);
+    SQuantRange range;
+    GetQuantRange(pdata, cnt, comp, fmt, &range);
+
+    double max_err = 0.0;
+    size_t i = 0;
+    for(i=0;i<cnt;i++)
+    {
+        float src[3];
+        memcpy(src, &pdata[i * comp], comp * sizeof(float));
+
+        //  法线与单位化后的向量比较，零向量没有方向
+        if(kind == ATTR_KIND_NORMAL)
+        {
+            float len = sqrtf((src[0] * src[0]) + (src[1] * src[1]) + (src[2] * src[2]));
+            if(len <= 0.0f) continue;
+            src[0] /= len;
+            src[1] /= len;
+            src[2] /= len;
+        }
+
+        int code[3];
+        float dec[3];
+        EncodeAttr(src, comp, fmt, &range, code);
+        DecodeAttr(code, comp, fmt, &range, dec);
+
+        int k = 0;
+        for(k=0;k<comp;k++)
+        {
+            double err = fabs((double)dec[k] - (double)src[k]);
+            if(!(err <= max_err)) max_err = err;     //  包含非数值的情况
+        }
+    }
+    return max_err;
+}
+
+//  得到编码后一个属性占用的字节数
+int GetAttrFormatSize(int kind, int fmt)
+{
+    int comp = GetAttrKindComp(kind);
+    switch(fmt)
+    {
+        case ATTR_FMT_F16:
+        case ATTR_FMT_SNORM16:
+        case ATTR_FMT_UNORM16:
+            return comp * 2;
+        case ATTR_FMT_OCT8:
+            return 2;
+        case ATTR_FMT_OCT16:
+            return 4;
+        default:
+            return comp * 4;
+    }
+}
+
+//  按照允许的最大误差为属性选择字节数最少的编码
+int ChooseAttrFormat(const float* pdata, size_t cnt, int kind, double max_error, double* perror)
+{
+    //  各种属性可用的编码，按字节数从少到多排列，最后一个总能满足要求
+    static const int pos_fmt[3] = {ATTR_FMT_SNORM16, ATTR_FMT_F16, ATTR_FMT_F32};
+    static const int uv_fmt[3] = {ATTR_FMT_UNORM16, ATTR_FMT_F16, ATTR_FMT_F32};
+    static const int normal_fmt[3] = {ATTR_FMT_OCT8, ATTR_FMT_OCT16, ATTR_FMT_F32};
+    const int* pfmt = (kind == ATTR_KIND_POS) ? pos_fmt : ((kind == ATTR_KIND_UV) ? uv_fmt : normal_fmt);
+
+    int best_fmt = ATTR_FMT_F32;
+    double best_err = 0.0;
+    int best_size = GetAttrFormatSize(kind, ATTR_FMT_F32);
+    int i = 0;
+    for(i=0;i<3;i++)
+    {
+        int size = GetAttrFormatSize(kind, pfmt[i]);
+        if(size > best_size) break;
+        double err = GetEncodeError(pdata, cnt, kind, pfmt[i]);
+        if(!(err <= max_error)) continue;
+
+        //  字节数更少，或者字节数相同但误差更小
+        if((size < best_size) || (err < best_err))
+        {
+            best_fmt = pfmt[i];
+            best_err = err;
+            best_size = size;
+        }
+    }
+
+    if(perror != 0) *perror = best_err;
+    return best_fmt;
+}
+
+//  得到编码格式的名字
+const char* GetAttrFormatName(int fmt)
+{
+    switch(fmt)
+    {
+        case ATTR_FMT_F16:      return "f16";
+        case ATTR_FMT_SNORM16:  return "s16";
+        case ATTR_FMT_UNORM16:  return "u16";
+        case ATTR_FMT_OCT8:     return "oct8";
+        case ATTR_FMT_OCT16:    return "oct16";
+        default:                return "f32";
+    }
+}
+
+//  得到编码格式在C文件中的数据类型
+const char* GetAttrFormatCType(int fmt)
+{
+    switch(fmt)
+    {
+        case ATTR_FMT_F16:      return "unsigned short";
+        case ATTR_FMT_SNORM16:  return "short";
+        case ATTR_FMT_UNORM16:  return "unsigned short";
+        case ATTR_FMT_OCT8:     return "signed char";
+        case ATTR_FMT_OCT16:    return "short";
+        default:                return "float";
+    }
+}
+
+//  得到编码格式在OpenGL ES中的数据类型
+int GetAttrFormatGLType(int fmt)
+{
+    switch(fmt)
+    {
+        case ATTR_FMT_F16:      return QUANT_GL_HALF_FLOAT;
+        case ATTR_FMT_SNORM16:  return QUANT_GL_SHORT;
+        case ATTR_FMT_UNORM16:  return QUANT_GL_UNSIGNED_SHORT;
+        case ATTR_FMT_OCT8:     return QUANT_GL_BYTE;
+        case ATTR_FMT_OCT16:    return QUANT_GL_SHORT;
+        default:                return QUANT_GL_FLOAT;
+    }
+}
+
+//  由名字得到编码格式，不支持时返回-2
+int GetAttrFormatByName(const char* pname)
+{
+    if(strcmp(pname, "auto") == 0)  return ATTR_FMT_AUTO;
+    if(strcmp(pname, "f32") == 0)   return ATTR_FMT_F32;
+    if(strcmp(pname, "f16") == 0)   return ATTR_FMT_F16;
+    if(strcmp(pname, "s16") == 0)   return ATTR_FMT_SNORM16;
+    if(strcmp(pname, "u16") == 0)   return ATTR_FMT_UNORM16;
+    if(strcmp(pname, "oct8") == 0)  return ATTR_FMT_OCT8;
+    if(strcmp(pname, "oct16") == 0) return ATTR_FMT_OCT16;
+    return -2;
+}
+
+//---------------------------------------------------------------------------
+//  文件结束
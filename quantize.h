@@ -0,0 +1,101 @@
+/****************************************************************************
+
+    程序名称：顶点属性的量化编码
+    程序设计：rainhenry
+    程序版本：REV 0.2
+    创建日期：20261016
+
+    说明：
+        顶点坐标  32位浮点、16位半精度浮点、16位有符号归一化整数(附带反量化的中心和缩放)
+        UV坐标    32位浮点、16位半精度浮点、16位无符号归一化整数(附带反量化的起点和缩放)
+        法线      32位浮点、八面体映射后的8位或16位有符号归一化整数(2个分量)
+        切线      32位浮点，xyz为切线，w为副切线的方向
+        可以按照允许的最大误差，自动选择字节数最少的编码
+
+    版本修订：
+        REV 0.1      rainhenry     20261016    创建文档
+        REV 0.2      rainhenry     20261017    增加切线属性，只支持32位浮点
+
+****************************************************************************/
+//---------------------------------------------------------------------------
+//  防止重复包含
+#ifndef __quantize_h__
+#define __quantize_h__
+
+//---------------------------------------------------------------------------
+//  包含头文件
+#include <cstddef>
+
+//  属性的编码格式
+#define ATTR_FMT_AUTO           -1      //  按允许的最大误差自动选择
+#define ATTR_FMT_F32            0       //  32位浮点
+#define ATTR_FMT_F16            1       //  16位半精度浮点
+#define ATTR_FMT_SNORM16        2       //  16位有符号归一化整数，用于顶点坐标
+#define ATTR_FMT_UNORM16        3       //  16位无符号归一化整数，用于UV坐标
+#define ATTR_FMT_OCT8           4       //  八面体映射，2个8位有符号归一化整数，用于法线
+#define ATTR_FMT_OCT16          5       //  八面体映射，2个16位有符号归一化整数，用于法线
+
+//  属性的种类
+#define ATTR_KIND_POS           0       //  顶点坐标，3个分量
+#define ATTR_KIND_UV            1       //  UV坐标，2个分量
+#define ATTR_KIND_NORMAL        2       //  法线，3个分量
+#define ATTR_KIND_TANGENT       3       //  切线，4个分量，只支持32位浮点
+
+//  OpenGL ES中对应的数据类型，用于glVertexAttribPointer
+#define QUANT_GL_BYTE           0x1400
+#define QUANT_GL_UNSIGNED_SHORT 0x1403
+#define QUANT_GL_SHORT          0x1402
+#define QUANT_GL_FLOAT          0x1406
+#define QUANT_GL_HALF_FLOAT     0x140B
+
+//  定义反量化参数，解码值 = offset + scale * 归一化整数
+//  SNORM16的归一化整数范围为[-1,1]，UNORM16为[0,1]
+typedef struct
+{
+    float offset[3];
+    float scale[3];
+}SQuantRange;
+
+//  float和半精度浮点数的相互转换，舍入到最近的偶数
+unsigned short FloatToHalf(float val);
+float HalfToFloat(unsigned short val);
+
+//  八面体映射编码和解码，bits为每个分量的位数(8或16)
+//  编码时会在相邻的4个整数点中选择解码误差最小的
+void OctEncode(const float* pn, int bits, int* pout);
+void OctDecode(const int* pin, int bits, float* pn);
+
+//  计算cnt个comp分量的数据按照fmt编码所需的反量化参数
+void GetQuantRange(const float* pdata, size_t cnt, int comp, int fmt, SQuantRange* prange);
+
+//  按照fmt编码一个comp分量的数据，编码结果放入pout，返回编码后的分量个数
+int EncodeAttr(const float* pin, int comp, int fmt, const SQuantRange* prange, int* pout);
+
+//  将编码结果解码为comp分量的数据
+void DecodeAttr(const int* pin, int comp, int fmt, const SQuantRange* prange, float* pout);
+
+//  得到属性的分量个数
+int GetAttrKindComp(int kind);
+
+//  计算cnt个数据按照fmt编码再解码后的最大绝对误差，法线按单位化后的向量计算
+double GetEncodeError(const float* pdata, size_t cnt, int kind, int fmt);
+
+//  得到编码后一个属性占用的字节数
+int GetAttrFormatSize(int kind, int fmt);
+
+//  按照允许的最大误差为属性选择字节数最少的编码，字节数相同时选择误差小的
+//  *perror返回所选编码的最大误差
+int ChooseAttrFormat(const float* pdata, size_t cnt, int kind, double max_error, double* perror);
+
+//  得到编码格式的名字，以及在C文件中的数据类型和OpenGL ES中的数据类型
+const char* GetAttrFormatName(int fmt);
+const char* GetAttrFormatCType(int fmt);
+int GetAttrFormatGLType(int fmt);
+
+//  由名字得到编码格式，不支持时返回-2
+int GetAttrFormatByName(const char* pname);
+
+#endif
+
+//---------------------------------------------------------------------------
+//  文件结束
@@ -0,0 +1,94 @@
+/****************************************************************************
+
+    程序名称：任务窃取的线程池
+    程序设计：rainhenry
+    程序版本：REV 0.1
+    创建日期：20261016
+
+    版本修订：
+        REV 0.1      rainhenry     20261016    创建文档
+
+****************************************************************************/
+//---------------------------------------------------------------------------
+//  包含头文件
+#include "workpool.h"
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//  定义一个工作线程的任务队列
+typedef struct
+{
+    std::mutex lock;
+    std::deque<size_t> job_deque;
+}SWorkQueue;
+
+//  从自己的队列头部取任务，取不到时从其他队列尾部窃取
+//  成功返回1，全部队列都为空时返回0
+static int GetWorkJob(std::vector<SWorkQueue>* pqueue_vec, size_t self, size_t* pjob)
+{
+    size_t num = pqueue_vec->size();
+    size_t i = 0;
+    for(i=0;i<num;i++)
+    {
+        size_t idx = (self + i) % num;
+        SWorkQueue& tmp_queue = pqueue_vec->at(idx);
+        std::lock_guard<std::mutex> guard(tmp_queue.lock);
+        if(tmp_queue.job_deque.empty()) continue;
+        if(i == 0)
+        {
+            *pjob = tmp_queue.job_deque.front();
+            tmp_queue.job_deque.pop_front();
+        }
+        else
+        {
+            *pjob = tmp_queue.job_deque.back();
+            tmp_queue.job_deque.pop_back();
+        }
+        return 1;
+    }
+    return 0;
+}
+
+//  工作线程，任务执行过程中不会产生新的任务，所有队列为空即可结束
+static void WorkThread(std::vector<SWorkQueue>* pqueue_vec, size_t self, PWorkFunc pfunc, void* puser)
+{
+    size_t job = 0;
+    while(GetWorkJob(pqueue_vec, self, &job))
+    {
+        pfunc(job, puser);
+    }
+}
+
+//  用worker_num个线程执行序号为0~job_cnt-1的任务，全部完成后返回
+void RunWorkPool(size_t job_cnt, int worker_num, PWorkFunc pfunc, void* puser)
+{
+    if(worker_num <= 0) worker_num = (int)std::thread::hardware_concurrency();
+    if(worker_num <= 0) worker_num = 1;
+    if((size_t)worker_num > job_cnt) worker_num = (int)job_cnt;
+    if(worker_num <= 0) return;
+
+    //  轮流分配任务
+    std::vector<SWorkQueue> queue_vec(worker_num);
+    size_t i = 0;
+    for(i=0;i<job_cnt;i++)
+    {
+        queue_vec.at(i % worker_num).job_deque.push_back(i);
+    }
+
+    //  第一个工作线程为当前线程
+    std::vector<std::thread> thread_vec;
+    for(i=1;i<(size_t)worker_num;i++)
+    {
+        thread_vec.push_back(std::thread(WorkThread, &queue_vec, i, pfunc, puser));
+    }
+    WorkThread(&queue_vec, 0, pfunc, puser);
+    for(i=0;i<thread_vec.size();i++)
+    {
+        thread_vec.at(i).join();
+    }
+}
+
+//---------------------------------------------------------------------------
+//  文件结束
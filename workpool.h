@@ -0,0 +1,36 @@
+/****************************************************************************
+
+    程序名称：任务窃取的线程池
+    程序设计：rainhenry
+    程序版本：REV 0.1
+    创建日期：20261016
+
+    说明：
+        开始时把全部任务轮流分配到每个工作线程自己的队列中，
+        工作线程从自己队列的头部取任务，自己的队列空了以后从其他线程队列的尾部窃取，
+        任务的耗时差别很大时(如网格大小相差很多)也能保持所有线程忙碌
+
+    版本修订：
+        REV 0.1      rainhenry     20261016    创建文档
+
+****************************************************************************/
+//---------------------------------------------------------------------------
+//  防止重复包含
+#ifndef __workpool_h__
+#define __workpool_h__
+
+//---------------------------------------------------------------------------
+//  包含头文件
+#include <cstddef>
+
+//  任务处理函数，job为任务序号，puser为用户数据
+typedef void (*PWorkFunc)(size_t job, void* puser);
+
+//  用worker_num个线程执行序号为0~job_cnt-1的任务，全部完成后返回
+//  worker_num小于等于0时使用全部CPU核心
+void RunWorkPool(size_t job_cnt, int worker_num, PWorkFunc pfunc, void* puser);
+
+#endif
+
+//---------------------------------------------------------------------------
+//  文件结束